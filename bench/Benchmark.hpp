@@ -0,0 +1,63 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_BENCH_BENCHMARK_HPP_
+#define _HAL_BENCH_BENCHMARK_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace Benchmark {
+
+  /*!
+   @function
+
+   @abstract Call body once to warm up, then repetitions more times,
+   and return the fastest of the timed calls in microseconds.
+   */
+  template<typename Body>
+  long long Measure(Body body, int repetitions = 5) {
+    body();
+    auto best = std::chrono::steady_clock::duration::max();
+    for (int i = 0; i < repetitions; ++i) {
+      const auto start = std::chrono::steady_clock::now();
+      body();
+      best = std::min(best, std::chrono::steady_clock::now() - start);
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(best).count();
+  }
+
+  /*!
+   @function
+
+   @abstract Exit with a non-zero status unless condition holds. A
+   benchmark whose result is wrong measured the wrong thing.
+   */
+  inline void Check(bool condition, const std::string& message) {
+    if (!condition) {
+      std::cerr << "FAILED: " << message << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+  }
+
+  /*!
+   @function
+
+   @abstract Print the time taken by iterations of an operation.
+   */
+  inline void Report(const std::string& name, long long iterations, long long microseconds) {
+    std::cout << name << ": " << iterations << " iterations in " << microseconds << "us ("
+              << (microseconds * 1000.0 / iterations) << "ns each)" << std::endl;
+  }
+
+} // namespace Benchmark {
+
+#endif // _HAL_BENCH_BENCHMARK_HPP_
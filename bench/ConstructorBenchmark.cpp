@@ -0,0 +1,35 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/HAL.hpp"
+#include "Widget.hpp"
+#include "Benchmark.hpp"
+
+// 'new Widget()' from JavaScript, which goes through
+// JSExportClass::CallAsConstructor.
+int main() {
+  using namespace HAL;
+  JSContextGroup js_context_group;
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject global_object = js_context.get_global_object();
+
+  JSObject widget = js_context.CreateObject(JSExport<Widget>::Class());
+  global_object.SetProperty("Widget", widget);
+
+  const long long iterations = 10000;
+  const auto script = "var count = 0; for (var i = 0; i < " + std::to_string(iterations) + "; i++) { if (new Widget().constructor === Widget) { ++count; } } count;";
+  const auto microseconds = Benchmark::Measure([&js_context, &script, iterations]() {
+    const auto result = js_context.JSEvaluateScript(script);
+    Benchmark::Check(static_cast<double>(result) == iterations, "new Widget() has the wrong constructor");
+
+    // Collect between runs so that each one starts with the same heap.
+    js_context.GarbageCollect();
+  });
+
+  Benchmark::Report("new Widget()", iterations, microseconds);
+}
@@ -0,0 +1,36 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/HAL.hpp"
+#include "Widget.hpp"
+#include "Benchmark.hpp"
+
+// Reads of a JSExport value property served by a getter that returns
+// a JSValue (Widget::js_get_number) against one served by a typed
+// getter (Widget::get_number).
+int main() {
+  using namespace HAL;
+  JSContextGroup js_context_group;
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject global_object = js_context.get_global_object();
+
+  JSObject widget = js_context.CreateObject(JSExport<Widget>::Class());
+  global_object.SetProperty("widget", widget);
+
+  const long long iterations = 100000;
+  const auto measure = [&js_context, iterations](const std::string& property_name) {
+    const auto script = "var sum = 0; for (var i = 0; i < " + std::to_string(iterations) + "; i++) { sum += widget." + property_name + "; } sum;";
+    return Benchmark::Measure([&js_context, &script, &property_name, iterations]() {
+      const auto result = js_context.JSEvaluateScript(script);
+      Benchmark::Check(static_cast<double>(result) == 42.0 * iterations, "widget." + property_name + " read the wrong number");
+    });
+  };
+
+  Benchmark::Report("widget.number (Widget::js_get_number)", iterations, measure("number"));
+  Benchmark::Report("widget.typedNumber (Widget::get_number)", iterations, measure("typedNumber"));
+}
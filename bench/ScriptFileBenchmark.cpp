@@ -0,0 +1,86 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/HAL.hpp"
+#include "Benchmark.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+  // The peak resident set size of this process in kilobytes, or 0
+  // where it isn't available.
+  long GetPeakResidentSetSize() {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+  }
+
+} // namespace {
+
+// The load time and peak RSS of evaluating a 20 MB bundle with
+// JSContext::EvaluateScriptFile ("mapped", the default) or by reading
+// it into a std::string for JSContext::JSEvaluateScript ("string").
+// The peak RSS of a process never shrinks, so each way runs in a
+// process of its own.
+int main(int argc, char* argv[]) {
+  using namespace HAL;
+  const std::string mode = argc > 1 ? argv[1] : "mapped";
+  Benchmark::Check(mode == "mapped" || mode == "string", "the mode must be 'mapped' or 'string'");
+
+  const std::string path = "ScriptFileBenchmark-" + mode + ".js";
+  std::size_t bundle_size = 0;
+  {
+    std::string bundle;
+    for (int i = 0; bundle.size() < 20 * 1024 * 1024; ++i) {
+      bundle += "var f" + std::to_string(i) + " = function(a) { return a + " + std::to_string(i) + "; };\n";
+    }
+    bundle += "f1(1);\n";
+    std::ofstream file(path, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+    file << bundle;
+    bundle_size = bundle.size();
+  }
+
+  JSContextGroup js_context_group;
+  JSContext js_context = js_context_group.CreateContext();
+  const auto peak_rss_before_kb = GetPeakResidentSetSize();
+  const auto start = std::chrono::steady_clock::now();
+  JSValue result = js_context.CreateUndefined();
+  if (mode == "mapped") {
+    result = js_context.EvaluateScriptFile(path);
+  } else {
+    std::ifstream file(path, std::ios_base::binary | std::ios_base::in);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    result = js_context.JSEvaluateScript(contents.str(), path);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const auto peak_rss_kb = GetPeakResidentSetSize() - peak_rss_before_kb;
+  std::remove(path.c_str());
+  Benchmark::Check(static_cast<double>(result) == 2, "the bundle evaluated to the wrong result");
+
+  std::cout << "Evaluating a " << bundle_size / 1024 << "KB bundle (" << mode << ") took "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms and grew the peak RSS by "
+            << peak_rss_kb << "KB" << std::endl;
+}
@@ -0,0 +1,49 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/HAL.hpp"
+#include "Benchmark.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Calls with many arguments to a native function that type checks
+// each of them, like a binding that accepts either an array or an
+// options object. Exercises JSValue::IsObject, JSObject::IsArray and
+// JSObject::IsError.
+int main() {
+  using namespace HAL;
+  JSContextGroup js_context_group;
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject global_object = js_context.get_global_object();
+
+  JSFunctionCallback callback = [js_context](const std::vector<JSValue> arguments, JSObject& this_object) {
+    std::int32_t arrays = 0;
+    for (const auto& argument : arguments) {
+      if (argument.IsObject()) {
+        const auto js_object = static_cast<JSObject>(argument);
+        if (js_object.IsArray()) {
+          ++arrays;
+        } else if (js_object.IsError()) {
+          --arrays;
+        }
+      }
+    }
+    return js_context.CreateNumber(arrays);
+  };
+  global_object.SetProperty("typeCheck", js_context.CreateFunction(callback));
+
+  const long long iterations = 10000;
+  const auto script = "var a = [1], o = {}, e = new Error('e'), sum = 0; for (var i = 0; i < " + std::to_string(iterations) + "; i++) { sum += typeCheck(a, o, e, a, o, a, o, a); } sum;";
+  const auto microseconds = Benchmark::Measure([&js_context, &script, iterations]() {
+    const auto result = js_context.JSEvaluateScript(script);
+    Benchmark::Check(static_cast<double>(result) == 3.0 * iterations, "typeCheck counted the wrong number of arrays");
+  });
+
+  Benchmark::Report("typeCheck with 8 arguments", iterations, microseconds);
+}
@@ -10,6 +10,7 @@
 
 #include <functional>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 
 double Widget::pi__ = 3.141592653589793;
@@ -178,6 +179,7 @@ std::string Widget::get_name() const HAL_NOEXCEPT {
 
 void Widget::set_name(const std::string& name) HAL_NOEXCEPT {
     name__ = name;
+    InvalidateProperty("greeting");
 }
 
 std::int32_t Widget::get_number() const HAL_NOEXCEPT {
@@ -186,6 +188,7 @@ std::int32_t Widget::get_number() const HAL_NOEXCEPT {
 
 void Widget::set_number(const std::int32_t number) HAL_NOEXCEPT {
   number__ = number;
+  InvalidateProperty("greeting");
 }
 
 double Widget::get_pi() HAL_NOEXCEPT {
@@ -211,7 +214,9 @@ void Widget::JSExportInitialize() {
   JSExport<Widget>::AddValueProperty("number"     , std::mem_fn(&Widget::js_get_number), std::mem_fn(&Widget::js_set_number));
   JSExport<Widget>::AddValueProperty("value"     , std::mem_fn(&Widget::js_get_value), std::mem_fn(&Widget::js_set_value));
   JSExport<Widget>::AddValueProperty("noenumerable_value", std::mem_fn(&Widget::js_get_noenumerable_value), nullptr, false);
+  JSExport<Widget>::AddValueProperty("typedNumber", &Widget::get_number, &Widget::set_number);
   JSExport<Widget>::AddConstantProperty("pi"     , std::mem_fn(&Widget::js_get_pi));
+  JSExport<Widget>::AddMemoizedProperty("greeting", std::mem_fn(&Widget::js_get_greeting));
   JSExport<Widget>::AddFunctionProperty("helloCallback", std::mem_fn(&Widget::js_helloLambda));
   JSExport<Widget>::AddFunctionProperty("sayHello", std::mem_fn(&Widget::js_sayHello));
   JSExport<Widget>::AddFunctionProperty("sayHelloWithCallback", std::mem_fn(&Widget::js_sayHelloWithCallback));
@@ -228,6 +233,13 @@ void Widget::JSExportInitialize() {
   JSExport<Widget>::AddFunctionProperty("testCallAsFunction", std::mem_fn(&Widget::js_testCallAsFunction));
   JSExport<Widget>::AddFunctionProperty("testException", std::mem_fn(&Widget::js_testException));
   JSExport<Widget>::AddFunctionProperty("testNestedException", std::mem_fn(&Widget::js_testNestedException));
+  JSExport<Widget>::AddFunctionProperty("testNativeException", std::mem_fn(&Widget::js_testNativeException));
+  JSExport<Widget>::AddFunctionProperty("scaleNumber", &Widget::js_scaleNumber);
+}
+
+double Widget::js_scaleNumber(std::int32_t factor, const std::string& unit) const {
+  const double result = static_cast<double>(number__) * factor;
+  return unit == "percent" ? result / 100 : result;
 }
 
 JSValue Widget::js_get_name() const HAL_NOEXCEPT {
@@ -250,7 +262,7 @@ JSValue Widget::js_get_number() const HAL_NOEXCEPT {
 bool Widget::js_set_number(const JSValue& value) HAL_NOEXCEPT {
   bool result = false;
   if (value.IsNumber()) {
-    number__ = static_cast<int32_t>(value);
+    set_number(static_cast<int32_t>(value));
     result = true;
   }
   return result;
@@ -274,6 +286,11 @@ JSValue Widget::js_get_pi() HAL_NOEXCEPT {
   return get_context().CreateNumber(get_pi());
 }
 
+JSValue Widget::js_get_greeting() HAL_NOEXCEPT {
+  count_for_greeting__++;
+  return get_context().CreateString(sayHello());
+}
+
 JSValue Widget::js_sayHelloWithCallback(const std::vector<JSValue>& arguments, JSObject& this_object) {
   if (arguments.size() > 0) {
     if (arguments.at(0).IsObject()) {
@@ -361,4 +378,8 @@ JSValue Widget::js_testException(const std::vector<JSValue>& arguments, JSObject
 JSValue Widget::js_testNestedException(const std::vector<JSValue>& arguments, JSObject& this_object) {
   const auto js_context = this_object.get_context();
   return js_context.JSEvaluateScript("this.testException()", this_object, "app.js", 123);
+}
+
+JSValue Widget::js_testNativeException(const std::vector<JSValue>& arguments, JSObject& this_object) {
+  throw std::runtime_error("Native error");
 }
\ No newline at end of file
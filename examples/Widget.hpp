@@ -59,6 +59,10 @@ public:
     return count_for_pi__;
   }
   
+  std::uint32_t get_count_for_greeting() {
+    return count_for_greeting__;
+  }
+  
   virtual ~Widget()                HAL_NOEXCEPT;
   Widget(const Widget&)            HAL_NOEXCEPT;
   Widget(Widget&&)                 HAL_NOEXCEPT;
@@ -89,6 +93,9 @@ public:
   // Remove "const" to test lazy loading
   JSValue js_get_pi() HAL_NOEXCEPT;
   
+  // Memoized, see set_name.
+  JSValue js_get_greeting() HAL_NOEXCEPT;
+  
   JSValue js_get_noenumerable_value() const HAL_NOEXCEPT;
 
   JSValue js_get_value() const                HAL_NOEXCEPT;
@@ -110,8 +117,12 @@ public:
   JSValue js_testMemberErrorProperty(const std::vector<JSValue>& arguments, JSObject& this_object);
   JSValue js_testMemberRegExpProperty(const std::vector<JSValue>& arguments, JSObject& this_object);
   
+  // Typed function property, see JSExport<T>::AddFunctionProperty.
+  double js_scaleNumber(std::int32_t factor, const std::string& unit) const;
+  
   JSValue js_testException(const std::vector<JSValue>& arguments, JSObject& this_object);
   JSValue js_testNestedException(const std::vector<JSValue>& arguments, JSObject& this_object);
+  JSValue js_testNativeException(const std::vector<JSValue>& arguments, JSObject& this_object);
 
   static uint32_t constructor_count__;
 private:
@@ -136,6 +147,7 @@ private:
   JSObject   hello_callback__;
 
   std::uint32_t count_for_pi__ { 0 };
+  std::uint32_t count_for_greeting__ { 0 };
 };
 
 inline
@@ -11,8 +11,13 @@
 
 #include "HAL/JSContextGroup.hpp"
 #include "HAL/JSContext.hpp"
+#include "HAL/JSContextSlot.hpp"
+#include "HAL/JSContextPool.hpp"
+#include "HAL/JSExecutor.hpp"
+#include "HAL/JSEventLoop.hpp"
 
 #include "HAL/JSExport.hpp"
+#include "HAL/JSExportTraits.hpp"
 #include "HAL/JSExportObject.hpp"
 #include "HAL/JSClass.hpp"
 
@@ -23,12 +28,14 @@
 #include "HAL/JSNull.hpp"
 #include "HAL/JSBoolean.hpp"
 #include "HAL/JSNumber.hpp"
+#include "HAL/JSResult.hpp"
 
 #include "HAL/JSObject.hpp"
 #include "HAL/JSArray.hpp"
 #include "HAL/JSDate.hpp"
 #include "HAL/JSError.hpp"
 #include "HAL/JSFunction.hpp"
+#include "HAL/JSInvoker.hpp"
 #include "HAL/JSRegExp.hpp"
 
 #include "HAL/JSPropertyNameArray.hpp"
@@ -24,6 +24,9 @@ namespace HAL { namespace detail {
   
   template<typename T>
   class JSExportClassDefinitionBuilder;
+  
+  template<typename T>
+  class JSExportClass;
 }}
 
 namespace HAL {
@@ -97,6 +100,10 @@ namespace HAL {
     template<typename T>
     friend class detail::JSExportClassDefinitionBuilder;
     
+    // For registering its JSExportTypeTag
+    template<typename T>
+    friend class detail::JSExportClass;
+    
     explicit operator JSClassRef() const HAL_NOEXCEPT {
       return js_class_ref__;
     }
@@ -32,6 +32,10 @@ namespace HAL {
    namespace). It defines the properties and callbacks that define a
    type of JavaScript object.
    
+   A JSClassDefinition is immutable and reference counted: its state
+   is built once, and copies share it, so copying or assigning one is
+   a pointer copy.
+   
    This class is thread safe and immutable by design.
    */
   class HAL_EXPORT JSClassDefinition HAL_PERFORMANCE_COUNTER1(JSClassDefinition) {
@@ -69,20 +73,33 @@ namespace HAL {
     virtual void Print() HAL_NOEXCEPT final;
     static  void Print(const ::JSClassDefinition& js_class_definition) HAL_NOEXCEPT;
     
-  private:
+  protected:
     
-    virtual void Initialize(const ::JSClassDefinition& other) HAL_NOEXCEPT final;
-    virtual void InitializePropertyCallbacks() HAL_NOEXCEPT final;
-
-    // Silence 4251 on Windows since private member variables do not
-    // need to be exported from a DLL.
-#pragma warning(push)
-#pragma warning(disable: 4251)
-    std::vector<detail::JSStaticValue>    js_value_properties__;
-    std::vector<detail::JSStaticFunction> js_function_properties__;
-#pragma warning(pop)
+    // The state shared by all copies of a JSClassDefinition. The
+    // static_values__ and static_functions__ arrays, and the names
+    // they point to, live as long as the state does.
+    struct State {
+      // Virtual so that derived classes can check which State they
+      // were given.
+      virtual ~State() HAL_NOEXCEPT {
+      }
+      
+      std::string                     name__;
+      std::vector<::JSStaticValue>    static_values__;
+      std::vector<::JSStaticFunction> static_functions__;
+      ::JSClassDefinition             js_class_definition__;
+    };
     
-  protected:
+    // Derived classes that extend State use this constructor.
+    explicit JSClassDefinition(std::shared_ptr<const State> state) HAL_NOEXCEPT;
+    
+    const State& get_state() const HAL_NOEXCEPT {
+      return *state__;
+    }
+    
+    const ::JSClassDefinition& get_js_class_definition() const HAL_NOEXCEPT {
+      return state__ -> js_class_definition__;
+    }
     
     // JSClass and JSExportClass need access to js_class_definition__.
     friend class JSClass;
@@ -90,16 +107,20 @@ namespace HAL {
     template<typename T>
     friend class detail::JSExportClass;
     
+  private:
+    
+    static std::shared_ptr<const State> CreateState(const ::JSClassDefinition& js_class_definition);
+    static std::shared_ptr<const State> GetEmptyState() HAL_NOEXCEPT;
+    
     // Silence 4251 on Windows since private member variables do not
     // need to be exported from a DLL.
 #pragma warning(push)
 #pragma warning(disable: 4251)
-    std::string                           name__;
-    std::vector<::JSStaticValue>          static_values__;
-    std::vector<::JSStaticFunction>       static_functions__;
-    ::JSClassDefinition                   js_class_definition__;
+    std::shared_ptr<const State> state__;
 #pragma warning(pop)
     
+  protected:
+    
 #undef  HAL_JSCLASSDEFINITION_LOCK_GUARD
 #ifdef  HAL_THREAD_SAFE
     std::recursive_mutex mutex__;
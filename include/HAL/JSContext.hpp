@@ -12,9 +12,13 @@
 #include "HAL/detail/JSBase.hpp"
 #include "HAL/JSContextGroup.hpp"
 
+#include <cstddef>
+#include <string>
+#include <cstdint>
 #include <vector>
 #include <unordered_map>
 #include <functional>
+#include <type_traits>
 
 namespace HAL {
   
@@ -32,11 +36,14 @@ namespace HAL {
   class JSRegExp;
   class JSFunction;
   class JSExportObject;
+  class JSResult;
   
   namespace detail {
     template<typename T>
     class JSExportClass;
     
+    struct JSContextHandleBlock;
+    
     HAL_EXPORT std::vector<JSValue> to_vector(const JSContext&, size_t, const JSValueRef[]);
   }}
 
@@ -44,6 +51,26 @@ namespace HAL {
 
   typedef std::function<JSValue(const std::vector<JSValue>, JSObject&)> JSFunctionCallback;
   
+  /*!
+   @struct
+   
+   @discussion The state of the compiled function cache of a global
+   context. See JSContext::SetFunctionCacheCapacity.
+   */
+  struct JSFunctionCacheStatistics final {
+    std::uint64_t hit_count      { 0 };
+    std::uint64_t miss_count     { 0 };
+    std::uint64_t eviction_count { 0 };
+    std::size_t   size           { 0 };
+    std::size_t   capacity       { 0 };
+  };
+  
+  namespace detail {
+    // A JSFunction callback that receives the JavaScriptCore C API
+    // arguments array directly. See JSContext::CreateFunction.
+    typedef std::function<JSValueRef(JSContextRef, std::size_t, const JSValueRef[])> JSNativeFunctionCallback;
+  }
+  
   /*!
    @class
    
@@ -328,11 +355,50 @@ namespace HAL {
      function's name. This will be used when converting the function
      to a string. An empty string creates an anonymous function.
 
+     @discussion A C++ exception thrown by callback is thrown to the
+     caller as a JavaScript exception: a TypeError for
+     std::invalid_argument, and an Error otherwise.
+
      @result A JSObject that is a function. The object's prototype
      will be the default function prototype.
      */
     JSFunction CreateFunction(JSFunctionCallback& callback) const;
     JSFunction CreateFunction(const JSString& function_name, JSFunctionCallback& callback) const;
+    
+    /*!
+     @method
+     
+     @abstract Create a JavaScript function implemented by a C++
+     std::function with a typed signature, e.g.
+     
+     std::function<double(std::int32_t, const std::string&)> scale = ...;
+     auto js_scale = js_context.CreateFunction("scale", scale);
+     
+     @discussion Arguments are converted directly from the
+     JavaScriptCore C API arguments array and the result is converted
+     back directly, without building a std::vector<JSValue>. The
+     argument and result types must be one of double, std::int32_t,
+     std::uint32_t, bool, std::string, JSValue or JSObject (the result
+     may also be void), which is checked at compile-time. Calling the
+     function with fewer arguments than the signature requires throws
+     a JavaScript exception.
+     
+     @param function_name An optional JSString containing the
+     function's name. An empty string creates an anonymous function.
+     
+     @param callback The C++ function to invoke when the function is
+     called.
+     
+     @result A JSObject that is a function. The object's prototype
+     will be the default function prototype.
+     */
+    template<typename R, typename... Args>
+    typename std::enable_if<!std::is_same<std::function<R(Args...)>, JSFunctionCallback>::value, JSFunction>::type
+    CreateFunction(std::function<R(Args...)> callback) const;
+    
+    template<typename R, typename... Args>
+    typename std::enable_if<!std::is_same<std::function<R(Args...)>, JSFunctionCallback>::value, JSFunction>::type
+    CreateFunction(const JSString& function_name, std::function<R(Args...)> callback) const;
 
     /*!
      @method
@@ -345,6 +411,43 @@ namespace HAL {
      */
     JSFunction CreateFunction() const;
     
+    /*!
+     @method
+     
+     @abstract Cache up to capacity of the functions created by
+     CreateFunction(body, ...) in this global context.
+     
+     @discussion While the cache is enabled, creating a function with
+     the same body, parameter names, function name, source URL and
+     starting line number as a cached one returns the cached function
+     object instead of compiling the body again. Callers therefore
+     share the function object, including any properties they set on
+     it.
+     
+     The cache evicts the least recently used function when it is
+     full. A capacity of zero, the default, disables the cache.
+     Reducing the capacity below the number of cached functions empties
+     the cache.
+     */
+    void SetFunctionCacheCapacity(std::size_t capacity) const HAL_NOEXCEPT;
+    
+    /*!
+     @method
+     
+     @abstract Return the hit, miss and eviction counts and the size
+     and capacity of this global context's function cache.
+     */
+    JSFunctionCacheStatistics GetFunctionCacheStatistics() const HAL_NOEXCEPT;
+    
+    /*!
+     @method
+     
+     @abstract Remove every function from this global context's
+     function cache, e.g. after the templates they were compiled from
+     change. The capacity and counts are kept.
+     */
+    void InvalidateFunctionCache() const HAL_NOEXCEPT;
+    
     /* Script Evaluation */
     
     /*!
@@ -378,6 +481,49 @@ namespace HAL {
     JSValue JSEvaluateScript(const JSString& script,                       const JSString& source_url, int starting_line_number = 1) const;
     JSValue JSEvaluateScript(const JSString& script, JSObject this_object, const JSString& source_url, int starting_line_number = 1) const;
     
+    /*!
+     @method
+     
+     @abstract Evaluate a string of JavaScript code without throwing
+     if it throws a JavaScript exception.
+     
+     @discussion The parameters are the same as for JSEvaluateScript.
+     
+     @result The JSValue that results from evaluating script, or the
+     JavaScript exception it threw. The exception is only decoded into
+     a C++ exception if you ask the JSResult for its value.
+     */
+    JSResult TryEvaluate(const JSString& script                                                                                ) const HAL_NOEXCEPT;
+    JSResult TryEvaluate(const JSString& script, JSObject this_object                                                          ) const HAL_NOEXCEPT;
+    JSResult TryEvaluate(const JSString& script,                       const JSString& source_url, int starting_line_number = 1) const HAL_NOEXCEPT;
+    JSResult TryEvaluate(const JSString& script, JSObject this_object, const JSString& source_url, int starting_line_number = 1) const HAL_NOEXCEPT;
+    
+    /*!
+     @method
+     
+     @abstract Evaluate the JavaScript code in a UTF-8 file, such as a
+     large bundle, using path as its source URL.
+     
+     @discussion The file is memory mapped and transcoded once into the
+     string JavaScriptCore evaluates, so unlike reading it into a
+     std::string and evaluating a JSString, no UTF-8 copy of the file
+     stays in memory. The script cache (see
+     JSContextGroup::SetScriptCacheCapacity) is not used, since its key
+     would be such a copy.
+     
+     @param path The path of the file to evaluate.
+     
+     @param this_object An optional JavaScript object to use as
+     "this". The default is the global object.
+     
+     @result The JSValue that results from evaluating the file.
+     
+     @throws std::runtime_error exception if the file can't be read or
+     the evaluated script threw an exception.
+     */
+    JSValue EvaluateScriptFile(const std::string& path                      ) const;
+    JSValue EvaluateScriptFile(const std::string& path, JSObject this_object) const;
+    
     /*!
      @method
      
@@ -475,8 +621,9 @@ namespace HAL {
     // need to be exported from a DLL.
 #pragma warning(push)
 #pragma warning(disable: 4251)
-    JSContextGroup     js_context_group__;
-    JSGlobalContextRef js_global_context_ref__ { nullptr };
+    JSContextGroup                js_context_group__;
+    JSGlobalContextRef            js_global_context_ref__ { nullptr };
+    detail::JSContextHandleBlock* js_context_handles__    { nullptr };
 #pragma warning(pop)
     
 #undef  HAL_JSCONTEXT_LOCK_GUARD
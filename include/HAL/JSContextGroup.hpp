@@ -12,12 +12,32 @@
 #include "HAL/detail/JSBase.hpp"
 
 #include <utility>
+#include <cstddef>
+#include <cstdint>
 
 namespace HAL {
   
   class JSContext;
   class JSClass;
   
+  /*!
+   @struct
+   
+   @discussion The state of the compiled script cache of a context
+   group. See JSContextGroup::SetScriptCacheCapacity.
+   
+   memory_used approximates the memory the cached scripts hold by the
+   size of their source text and source URLs.
+   */
+  struct JSScriptCacheStatistics final {
+    std::uint64_t hit_count      { 0 };
+    std::uint64_t miss_count     { 0 };
+    std::uint64_t eviction_count { 0 };
+    std::size_t   size           { 0 };
+    std::size_t   capacity       { 0 };
+    std::size_t   memory_used    { 0 };
+  };
+  
   /*!
    @class
    
@@ -77,6 +97,73 @@ namespace HAL {
     JSContext CreateContext() const HAL_NOEXCEPT;
     JSContext CreateContext(const JSClass& global_object_class) const HAL_NOEXCEPT;
     
+    /*!
+     @method
+     
+     @abstract Destroy the native objects of every JSExport class
+     whose finalization was deferred (see
+     JSExportTraits<T>::defer_finalization).
+     
+     @discussion The JavaScriptCore garbage collector's finalizer
+     only queues such native objects, so call this at a convenient
+     time (e.g. when your app is idle) on a thread where their
+     destructors may run. Native objects finalized by any context
+     group are drained.
+     
+     @result The number of native objects destroyed.
+     */
+    static std::size_t DrainFinalizers();
+    
+    /*!
+     @method
+     
+     @abstract Return whether this JavaScriptCore can compile a script
+     once and evaluate it many times, which the script cache needs.
+     */
+    static bool IsScriptCacheSupported() HAL_NOEXCEPT;
+    
+    /*!
+     @method
+     
+     @abstract Cache up to capacity of the scripts evaluated by the
+     JSContexts of this context group.
+     
+     @discussion While the cache is enabled, JSContext::JSEvaluateScript
+     and JSContext::TryEvaluate compile each distinct script, source URL
+     and starting line number once per context group, and later
+     evaluations of the same script, in any JSContext of this context
+     group, only execute the compiled script. Scripts with syntax errors
+     are not cached.
+     
+     The cache evicts the least recently used script when it is full.
+     A capacity of zero, the default, disables the cache, releases the
+     cached scripts and resets the counts. An enabled cache keeps this
+     context group alive, so set the capacity back to zero when you
+     are done with it.
+     
+     If IsScriptCacheSupported returns false then the capacity is
+     recorded but scripts are evaluated as usual.
+     */
+    void SetScriptCacheCapacity(std::size_t capacity) const HAL_NOEXCEPT;
+    
+    /*!
+     @method
+     
+     @abstract Return the hit, miss and eviction counts, the size and
+     capacity and the approximate memory used of this context group's
+     script cache.
+     */
+    JSScriptCacheStatistics GetScriptCacheStatistics() const HAL_NOEXCEPT;
+    
+    /*!
+     @method
+     
+     @abstract Release every script in this context group's script
+     cache, e.g. after the files they were loaded from change. The
+     capacity and counts are kept.
+     */
+    void ClearScriptCache() const HAL_NOEXCEPT;
+    
     ~JSContextGroup()                         HAL_NOEXCEPT;
     JSContextGroup(const JSContextGroup&)     HAL_NOEXCEPT;
     JSContextGroup(JSContextGroup&&)          HAL_NOEXCEPT;
@@ -0,0 +1,249 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_JSCONTEXTPOOL_HPP_
+#define _HAL_JSCONTEXTPOOL_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+#include "HAL/JSContextGroup.hpp"
+#include "HAL/JSContext.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace HAL {
+
+  typedef std::function<void(JSContext&)> JSContextPoolCallback;
+
+  /*!
+   @struct
+
+   @discussion The state of a JSContextPool. See
+   JSContextPool::GetStatistics.
+
+   wait_count counts the acquires that found no idle context, and the
+   wait times are those of all acquires. utilization is the fraction of
+   the pool's context time, since it was created, that leases held.
+   */
+  struct JSContextPoolStatistics final {
+    std::uint64_t             acquire_count   { 0 };
+    std::uint64_t             wait_count      { 0 };
+    std::uint64_t             timeout_count   { 0 };
+    std::uint64_t             retire_count    { 0 };
+    std::chrono::microseconds total_wait_time { 0 };
+    std::chrono::microseconds max_wait_time   { 0 };
+    std::size_t               size            { 0 };
+    std::size_t               in_use          { 0 };
+    std::size_t               peak_in_use     { 0 };
+    double                    utilization     { 0 };
+  };
+
+  /*!
+   @class
+
+   @discussion A JSContextPool keeps a fixed number of initialized
+   JSContexts of one JSContextGroup, so that serving a request in its
+   own context doesn't pay for creating the context and installing its
+   globals and JSExport constructors.
+
+   The initializer runs once for each context, when the pool creates
+   it. A request then leases a context, and the lease returns it to the
+   pool when destroyed:
+
+   JSContextPool js_context_pool(js_context_group, 8, [](JSContext& js_context) {
+     auto global_object = js_context.get_global_object();
+     global_object.SetProperty("Widget", js_context.CreateObject(JSExport<Widget>::Class()));
+   });
+
+   auto lease = js_context_pool.Acquire();
+   lease.get_context().JSEvaluateScript(request_script);
+
+   On return the optional reset callback runs, e.g. to delete the
+   request's globals. A context is recycled, i.e. replaced by a newly
+   created and initialized one, once it has been leased max_use_count
+   times, when its lease is retired, or when the reset callback
+   throws.
+
+   The contexts share a context group, so JavaScriptCore serializes
+   their use by several threads. Each lease must only be used by one
+   thread at a time.
+   */
+  class HAL_EXPORT JSContextPool final HAL_PERFORMANCE_COUNTER1(JSContextPool) {
+
+  public:
+
+    /*!
+     @class
+
+     @discussion A Lease is the exclusive use of one of a
+     JSContextPool's contexts until it is destroyed. An empty Lease,
+     from a TryAcquire that timed out or one that was moved from,
+     converts to false.
+     */
+    class HAL_EXPORT Lease final {
+
+    public:
+
+      Lease() HAL_NOEXCEPT {
+      }
+
+      ~Lease() HAL_NOEXCEPT {
+        Release();
+      }
+
+      Lease(Lease&& rhs) HAL_NOEXCEPT
+      : js_context_pool__(rhs.js_context_pool__)
+      , index__(rhs.index__)
+      , retire__(rhs.retire__) {
+        rhs.js_context_pool__ = nullptr;
+      }
+
+      Lease& operator=(Lease&& rhs) HAL_NOEXCEPT {
+        if (this != &rhs) {
+          Release();
+          js_context_pool__     = rhs.js_context_pool__;
+          index__               = rhs.index__;
+          retire__              = rhs.retire__;
+          rhs.js_context_pool__ = nullptr;
+        }
+        return *this;
+      }
+
+      explicit operator bool() const HAL_NOEXCEPT {
+        return js_context_pool__ != nullptr;
+      }
+
+      /*!
+       @method
+
+       @abstract Return the leased context. The Lease must not be
+       empty.
+       */
+      JSContext& get_context() const HAL_NOEXCEPT;
+
+      /*!
+       @method
+
+       @abstract Recycle the leased context instead of resetting it
+       when the Lease is returned, e.g. after a script left it in an
+       unknown state.
+       */
+      void Retire() HAL_NOEXCEPT {
+        retire__ = true;
+      }
+
+      /*!
+       @method
+
+       @abstract Return the context to the pool now, leaving this Lease
+       empty.
+       */
+      void Release() HAL_NOEXCEPT;
+
+    private:
+
+      friend class JSContextPool;
+
+      Lease(JSContextPool* js_context_pool, std::size_t index) HAL_NOEXCEPT
+      : js_context_pool__(js_context_pool)
+      , index__(index) {
+      }
+
+      Lease(const Lease&)            = delete;
+      Lease& operator=(const Lease&) = delete;
+
+      JSContextPool* js_context_pool__ { nullptr };
+      std::size_t    index__           { 0 };
+      bool           retire__          { false };
+    };
+
+    /*!
+     @method
+
+     @abstract Create size contexts in js_context_group and run
+     initializer on each of them.
+
+     @param reset An optional callback run on a context each time it
+     is returned to the pool.
+
+     @param max_use_count The number of leases after which a context
+     is recycled. Zero, the default, means never.
+
+     @throws Whatever initializer throws.
+     */
+    JSContextPool(const JSContextGroup& js_context_group, std::size_t size, JSContextPoolCallback initializer, JSContextPoolCallback reset = nullptr, std::size_t max_use_count = 0);
+
+    /*!
+     @method
+
+     @abstract Destroy the pool. Every Lease must have been returned.
+     */
+    ~JSContextPool() HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Lease an idle context, waiting for one to be returned
+     if there is none.
+     */
+    Lease Acquire();
+
+    /*!
+     @method
+
+     @abstract Lease an idle context, waiting at most timeout for one
+     to be returned if there is none.
+
+     @result The Lease, which is empty if the wait timed out.
+     */
+    Lease TryAcquire(std::chrono::milliseconds timeout);
+
+    JSContextPoolStatistics GetStatistics() const;
+
+  private:
+
+    Lease Acquire(const std::chrono::milliseconds* timeout);
+    void  Return(std::size_t index, bool retire) HAL_NOEXCEPT;
+    JSContext CreateContext() const;
+
+    JSContextPool(const JSContextPool&)            = delete;
+    JSContextPool& operator=(const JSContextPool&) = delete;
+
+    struct Entry {
+      JSContext                             js_context;
+      std::size_t                           use_count;
+      std::chrono::steady_clock::time_point lease_time;
+    };
+
+    // Silence 4251 on Windows since private member variables do not
+    // need to be exported from a DLL.
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    JSContextGroup                        js_context_group__;
+    JSContextPoolCallback                 initializer__;
+    JSContextPoolCallback                 reset__;
+    std::size_t                           max_use_count__;
+    std::vector<Entry>                    entries__;
+    // The indices of the idle entries, most recently returned last.
+    std::vector<std::size_t>              idle_indices__;
+    mutable std::mutex                    mutex__;
+    std::condition_variable               idle_condition__;
+    JSContextPoolStatistics               statistics__;
+    std::chrono::steady_clock::time_point creation_time__;
+    std::chrono::steady_clock::duration   busy_time__ { 0 };
+#pragma warning(pop)
+  };
+
+} // namespace HAL {
+
+#endif // _HAL_JSCONTEXTPOOL_HPP_
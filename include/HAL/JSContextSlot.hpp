@@ -0,0 +1,236 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_JSCONTEXTSLOT_HPP_
+#define _HAL_JSCONTEXTSLOT_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+#include "HAL/detail/JSContextSlots.hpp"
+#include "HAL/JSContext.hpp"
+#include "HAL/JSValue.hpp"
+#include "HAL/JSUndefined.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace HAL {
+
+  /*!
+   @class
+
+   @discussion A JSContextSlot<T> is a key for storing one T per
+   global context, for example a parsed configuration or a cache that
+   belongs to a context:
+
+   static JSContextSlot<Config> config_slot;
+
+   auto config_ptr = config_slot.Get(js_context);
+   if (!config_ptr) {
+     config_ptr = config_slot.Set(js_context, LoadConfig());
+   }
+
+   Each JSContextSlot takes an index when it is constructed. Get
+   finds the context's slot table through a hidden property of the
+   global object, checks the class of what it found and then indexes
+   the table under a mutex, so it costs about as much as reading a
+   global variable from C++. Keep the T* rather than calling Get in a
+   loop, and define slots as statics (or otherwise long-lived
+   objects) rather than creating one per use.
+
+   A context's T is destroyed when the context is garbage collected.
+   That happens during garbage collection, so T's destructor must not
+   call JavaScriptCore. For JavaScript values use
+   JSContextSlot<JSValue> instead, which lets the garbage collector
+   trace the value.
+   */
+  template<typename T>
+  class JSContextSlot final HAL_PERFORMANCE_COUNTER1(JSContextSlot<T>) {
+
+  public:
+
+    JSContextSlot() HAL_NOEXCEPT
+    : index__(detail::JSContextSlots::AllocateNativeIndex()) {
+    }
+
+    /*!
+     @method
+
+     @abstract Return the T stored for js_context, or nullptr if there
+     isn't one.
+     */
+    T* Get(const JSContext& js_context) const HAL_NOEXCEPT {
+      return static_cast<T*>(detail::JSContextSlots::GetNative(static_cast<JSContextRef>(js_context), index__));
+    }
+
+    /*!
+     @method
+
+     @abstract Store value for js_context, replacing (and destroying)
+     any previous value.
+
+     @result The stored value.
+     */
+    T* Set(const JSContext& js_context, T value) {
+      const auto value_ptr = std::make_shared<T>(std::move(value));
+      detail::JSContextSlots::SetNative(static_cast<JSContextRef>(js_context), index__, value_ptr);
+      return value_ptr.get();
+    }
+
+    /*!
+     @method
+
+     @abstract Destroy the value stored for js_context, if any.
+     */
+    void Reset(const JSContext& js_context) HAL_NOEXCEPT {
+      detail::JSContextSlots::SetNative(static_cast<JSContextRef>(js_context), index__, nullptr);
+    }
+
+  private:
+
+    JSContextSlot(const JSContextSlot&)            = delete;
+    JSContextSlot& operator=(const JSContextSlot&) = delete;
+
+    const std::size_t index__;
+  };
+
+  /*!
+   @class
+
+   @discussion A JSContextSlot<JSValue> is a key for storing one
+   JavaScript value per global context, such as a builtin function,
+   a constructor or a class prototype.
+
+   The value is reachable from the context's global object, so the
+   garbage collector traces it, and it doesn't keep the context alive.
+   */
+  template<>
+  class JSContextSlot<JSValue> final HAL_PERFORMANCE_COUNTER1(JSContextSlot<JSValue>) {
+
+  public:
+
+    JSContextSlot() HAL_NOEXCEPT
+    : index__(detail::JSContextSlots::AllocateIndex()) {
+    }
+
+    /*!
+     @method
+
+     @abstract Return whether a value is stored for js_context.
+     */
+    bool Has(const JSContext& js_context) const HAL_NOEXCEPT {
+      return detail::JSContextSlots::GetValue(static_cast<JSContextRef>(js_context), index__) != nullptr;
+    }
+
+    /*!
+     @method
+
+     @abstract Return the value stored for js_context, or JSUndefined
+     if there isn't one.
+     */
+    JSValue Get(const JSContext& js_context) const HAL_NOEXCEPT {
+      const auto value_ref = detail::JSContextSlots::GetValue(static_cast<JSContextRef>(js_context), index__);
+      if (value_ref) {
+        return JSValue(js_context, value_ref);
+      }
+      return js_context.CreateUndefined();
+    }
+
+    /*!
+     @method
+
+     @abstract Store js_value for js_context, replacing any previous
+     value.
+     */
+    void Set(const JSContext& js_context, const JSValue& js_value) HAL_NOEXCEPT {
+      detail::JSContextSlots::SetValue(static_cast<JSContextRef>(js_context), index__, static_cast<JSValueRef>(js_value));
+    }
+
+    /*!
+     @method
+
+     @abstract Empty the slot for js_context.
+     */
+    void Reset(const JSContext& js_context) HAL_NOEXCEPT {
+      detail::JSContextSlots::SetValue(static_cast<JSContextRef>(js_context), index__, nullptr);
+    }
+
+  private:
+
+    JSContextSlot(const JSContextSlot&)            = delete;
+    JSContextSlot& operator=(const JSContextSlot&) = delete;
+
+    const std::size_t index__;
+  };
+
+  /*!
+   @class
+
+   @discussion A JSContextGroupSlot<T> is a key for storing one T per
+   context group, shared by all of the group's contexts. It is
+   addressed through any context of the group.
+
+   A group's T is destroyed when the last context of the group that
+   has used a JSContextSlot or JSContextGroupSlot is garbage
+   collected. As with JSContextSlot, T's destructor must not call
+   JavaScriptCore.
+   */
+  template<typename T>
+  class JSContextGroupSlot final HAL_PERFORMANCE_COUNTER1(JSContextGroupSlot<T>) {
+
+  public:
+
+    JSContextGroupSlot() HAL_NOEXCEPT
+    : index__(detail::JSContextSlots::AllocateGroupIndex()) {
+    }
+
+    /*!
+     @method
+
+     @abstract Return the T stored for the group of js_context, or
+     nullptr if there isn't one.
+     */
+    T* Get(const JSContext& js_context) const HAL_NOEXCEPT {
+      return static_cast<T*>(detail::JSContextSlots::GetGroupNative(static_cast<JSContextRef>(js_context), index__));
+    }
+
+    /*!
+     @method
+
+     @abstract Store value for the group of js_context, replacing (and
+     destroying) any previous value.
+
+     @result The stored value.
+     */
+    T* Set(const JSContext& js_context, T value) {
+      const auto value_ptr = std::make_shared<T>(std::move(value));
+      detail::JSContextSlots::SetGroupNative(static_cast<JSContextRef>(js_context), index__, value_ptr);
+      return value_ptr.get();
+    }
+
+    /*!
+     @method
+
+     @abstract Destroy the value stored for the group of js_context,
+     if any.
+     */
+    void Reset(const JSContext& js_context) HAL_NOEXCEPT {
+      detail::JSContextSlots::SetGroupNative(static_cast<JSContextRef>(js_context), index__, nullptr);
+    }
+
+  private:
+
+    JSContextGroupSlot(const JSContextGroupSlot&)            = delete;
+    JSContextGroupSlot& operator=(const JSContextGroupSlot&) = delete;
+
+    const std::size_t index__;
+  };
+
+} // namespace HAL {
+
+#endif // _HAL_JSCONTEXTSLOT_HPP_
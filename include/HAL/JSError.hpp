@@ -30,6 +30,7 @@ class HAL_EXPORT JSError final : public JSObject HAL_PERFORMANCE_COUNTER2(JSErro
 #pragma warning(disable : 4251)
  	static std::deque<std::string> NativeStack__;
  	static std::string GetNativeStack();
+ 	static std::string GetNativeStack(const std::deque<std::string>& native_stack);
  	static void ClearNativeStack();
 #pragma warning(pop)
 
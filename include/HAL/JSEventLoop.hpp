@@ -0,0 +1,235 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_JSEVENTLOOP_HPP_
+#define _HAL_JSEVENTLOOP_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+#include "HAL/JSContext.hpp"
+#include "HAL/JSValue.hpp"
+#include "HAL/JSObject.hpp"
+#include "HAL/JSFunction.hpp"
+#include "HAL/detail/JSThreadPool.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace HAL {
+
+  typedef std::function<void(JSContext&)> JSEventLoopTask;
+
+  // The three stages of an async function. See
+  // JSEventLoop::CreateAsyncFunction.
+  typedef std::function<JSValue(JSContext&)>                                 JSAsyncResult;
+  typedef std::function<JSAsyncResult()>                                     JSAsyncWork;
+  typedef std::function<JSAsyncWork(const std::vector<JSValue>&, JSObject&)> JSAsyncFunctionCallback;
+
+  /*!
+   @struct
+
+   @discussion The state of a JSEventLoop. See
+   JSEventLoop::GetStatistics.
+
+   The lag of a callback is how long after it became due it ran, i.e.
+   after its timer expired or after its task was posted. A loop whose
+   lag grows is blocked by long running callbacks.
+   */
+  struct JSEventLoopStatistics final {
+    std::uint64_t             task_count          { 0 };
+    std::uint64_t             timer_count         { 0 };
+    std::uint64_t             batch_count         { 0 };
+    std::chrono::microseconds total_lag           { 0 };
+    std::chrono::microseconds max_lag             { 0 };
+    std::size_t               pending_task_count  { 0 };
+    std::size_t               pending_timer_count { 0 };
+    std::size_t               pending_async_count { 0 };
+  };
+
+  /*!
+   @class
+
+   @discussion A JSEventLoop runs the timers and native tasks of a
+   JSContext. Creating one installs setTimeout, clearTimeout,
+   setInterval and clearInterval in the context's global object:
+
+   JSEventLoop js_event_loop(js_context);
+   js_context.JSEvaluateScript("setTimeout(function() { print('later'); }, 100);");
+   js_event_loop.RunUntilIdle();
+
+   Each turn of the loop dispatches one batch: every native task posted
+   so far, in order, then every expired timer, earliest first. Timers
+   and tasks added by the batch run in a later one. JavaScriptCore
+   drains the promise jobs (microtasks) a callback queues as the
+   callback returns, so promise continuations run within the batch.
+
+   The loop runs either on the caller's thread, with Run, RunOnce or
+   RunUntilIdle, or on a thread of its own, with Start and Stop. Post
+   and Stop may be called from any thread. While the loop runs on its
+   own thread, other threads should reach the context through Post
+   rather than directly.
+
+   Async functions (see CreateAsyncFunction) return a Promise and run
+   their native work on a pool of async threads, so blocking I/O
+   doesn't stall the loop. The Promise is settled on the loop's thread
+   in a later batch, and RunUntilIdle waits for it.
+
+   The installed functions only refer to the JSEventLoop weakly, so
+   they throw a JavaScript Error if called after it is destroyed.
+   */
+  class HAL_EXPORT JSEventLoop final HAL_PERFORMANCE_COUNTER1(JSEventLoop) {
+
+  public:
+
+    /*!
+     @method
+
+     @abstract Create an event loop for js_context and install its
+     timer functions in js_context's global object.
+
+     @param async_thread_count The most threads that run the work of
+     async functions. Zero, the default, means one per hardware
+     thread. The threads are only started when needed.
+     */
+    explicit JSEventLoop(const JSContext& js_context, std::size_t async_thread_count = 0);
+
+    /*!
+     @method
+
+     @abstract Stop the loop's own thread, if started, wait for the
+     async work already started, and cancel the pending timers and
+     tasks. Pending Promises are rejected with an Error, and async
+     work that has not started yet is dropped.
+     */
+    ~JSEventLoop() HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Queue task to run on the loop's thread in the next
+     batch. It may be called from any thread.
+     */
+    void Post(JSEventLoopTask task);
+
+    /*!
+     @method
+
+     @abstract Wait at most timeout for a timer to expire or a task to
+     be posted, and dispatch one batch.
+
+     @result The number of callbacks run.
+     */
+    std::size_t RunOnce(std::chrono::milliseconds timeout);
+
+    /*!
+     @method
+
+     @abstract Dispatch batches until there are no tasks or timers
+     left. A pending setInterval therefore keeps it running until the
+     interval is cleared or Stop is called.
+     */
+    void RunUntilIdle();
+
+    /*!
+     @method
+
+     @abstract Dispatch batches, waiting for timers and tasks, until
+     Stop is called.
+     */
+    void Run();
+
+    /*!
+     @method
+
+     @abstract Run the loop on a thread of its own.
+     */
+    void Start();
+
+    /*!
+     @method
+
+     @abstract Make Run and RunUntilIdle return after the current
+     batch, and join the loop's own thread if it was started. It may be
+     called from any thread, including from a callback.
+     */
+    void Stop() HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Create a JavaScript function that returns a Promise
+     settled by native work on the async threads.
+
+     @discussion Each call of the function runs in three stages:
+
+     1. callback runs on the loop's thread with the call's arguments,
+     which it converts to native values, and returns the work.
+
+     2. The work runs on an async thread, where it must not touch
+     JavaScriptCore, and returns a JSAsyncResult.
+
+     3. The JSAsyncResult runs on the loop's thread and returns the
+     value that resolves the Promise.
+
+     An exception thrown by the work or the JSAsyncResult rejects the
+     Promise with an Error carrying its message. For example:
+
+     auto read_file = js_event_loop.CreateAsyncFunction("readFile", [](const std::vector<JSValue>& arguments, JSObject&) -> JSAsyncWork {
+       const auto path = static_cast<std::string>(arguments.at(0));
+       return [path]() -> JSAsyncResult {
+         const auto contents = ReadFile(path);
+         return [contents](JSContext& js_context) -> JSValue {
+           return js_context.CreateString(contents);
+         };
+       };
+     });
+     global_object.SetProperty("readFile", read_file);
+
+     @param function_name The name of the function.
+
+     @param callback The first stage, which may throw to make the
+     function throw a JavaScript exception instead of returning a
+     Promise, as described in JSContext::CreateFunction.
+     */
+    JSFunction CreateAsyncFunction(const JSString& function_name, JSAsyncFunctionCallback callback);
+
+    /*!
+     @method
+
+     @abstract Run work on the async threads. It must not touch
+     JavaScriptCore; use Post to continue on the loop's thread.
+     */
+    void PostWork(std::function<void()> work);
+
+    JSEventLoopStatistics GetStatistics() const;
+
+  private:
+
+    struct State;
+
+    JSEventLoop(const JSEventLoop&)            = delete;
+    JSEventLoop& operator=(const JSEventLoop&) = delete;
+
+    // Silence 4251 on Windows since private member variables do not
+    // need to be exported from a DLL.
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    std::shared_ptr<State> state_ptr__;
+    std::thread            thread__;
+    // Destroyed first, so its work can still post to the State.
+    detail::JSThreadPool   thread_pool__;
+#pragma warning(pop)
+  };
+
+} // namespace HAL {
+
+#endif // _HAL_JSEVENTLOOP_HPP_
@@ -0,0 +1,160 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_JSEXECUTOR_HPP_
+#define _HAL_JSEXECUTOR_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+#include "HAL/JSContext.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace HAL {
+
+  typedef std::function<void(JSContext&)> JSExecutorJob;
+
+  /*!
+   @class
+
+   @discussion A JSExecutor runs JavaScript on a fixed set of worker
+   threads so that scripts can use every core. Each worker creates its
+   own JSContextGroup and JSContext on its own thread and is the only
+   thread that ever touches them, so no JavaScriptCore object is
+   shared between threads.
+
+   Jobs are either scripts or C++ callables taking a JSContext&, and
+   their results come back through std::futures:
+
+   JSExecutor js_executor(4, [](JSContext& js_context) {
+     js_context.EvaluateScriptFile("bundle.js");
+   });
+   auto total = js_executor.Submit([](JSContext& js_context) {
+     return static_cast<double>(js_context.JSEvaluateScript("render()"));
+   });
+   auto text = js_executor.Evaluate("JSON.stringify(state)");
+   std::clog << total.get() << " " << text.get() << std::endl;
+
+   A job must not return a JSValue or JSObject, since those belong to
+   the worker's context; convert them to native values first.
+
+   Each worker has its own queue. Jobs submitted from outside the
+   executor are spread over the queues round robin, jobs submitted by
+   a job go to its own worker's queue, and a worker whose queue is
+   empty steals from the others. Jobs therefore run in no particular
+   order, and which worker's context a job gets is unspecified.
+   */
+  class HAL_EXPORT JSExecutor final HAL_PERFORMANCE_COUNTER1(JSExecutor) {
+
+  public:
+
+    /*!
+     @method
+
+     @abstract Start worker_count workers, and run initializer on each
+     worker's context before it runs any job.
+
+     @param worker_count The number of workers. Zero, the default,
+     means one per hardware thread.
+
+     @param initializer An optional callback to install globals and
+     JSExport constructors in each worker's context.
+     */
+    explicit JSExecutor(std::size_t worker_count = 0, JSExecutorJob initializer = nullptr);
+
+    /*!
+     @method
+
+     @abstract Run every job already submitted, then stop and join the
+     workers.
+     */
+    ~JSExecutor() HAL_NOEXCEPT;
+
+    std::size_t get_worker_count() const HAL_NOEXCEPT {
+      return workers__.size();
+    }
+
+    /*!
+     @method
+
+     @abstract Run function(js_context) on a worker.
+
+     @result A std::future for function's return value, or for the
+     exception it threw.
+     */
+    template<typename F>
+    std::future<decltype(std::declval<F&>()(std::declval<JSContext&>()))> Submit(F function) {
+      typedef decltype(std::declval<F&>()(std::declval<JSContext&>())) Result;
+      // std::function needs a copyable callable, and a packaged_task
+      // can only be moved.
+      const auto task_ptr = std::make_shared<std::packaged_task<Result(JSContext&)>>(std::move(function));
+      auto future = task_ptr -> get_future();
+      Post([task_ptr](JSContext& js_context) {
+        (*task_ptr)(js_context);
+      });
+      return future;
+    }
+
+    /*!
+     @method
+
+     @abstract Evaluate script on a worker.
+
+     @result A std::future for the result converted to a string, or for
+     the std::runtime_error the script threw.
+     */
+    std::future<std::string> Evaluate(const std::string& script, const std::string& source_url = "");
+
+    /*!
+     @method
+
+     @abstract Run job on a worker without a way to wait for it. An
+     exception it throws is logged and otherwise ignored.
+     */
+    void Post(JSExecutorJob job);
+
+  private:
+
+    struct Worker;
+
+    void Run(std::size_t index) HAL_NOEXCEPT;
+    bool Pop(std::size_t index, JSExecutorJob& job) HAL_NOEXCEPT;
+
+    // Return the index of the worker running on this thread, or the
+    // number of workers if this thread isn't one of them.
+    std::size_t GetCurrentWorkerIndex() const HAL_NOEXCEPT;
+
+    JSExecutor(const JSExecutor&)            = delete;
+    JSExecutor& operator=(const JSExecutor&) = delete;
+
+    // Silence 4251 on Windows since private member variables do not
+    // need to be exported from a DLL.
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    JSExecutorJob                        initializer__;
+    std::vector<std::unique_ptr<Worker>> workers__;
+    std::atomic<std::size_t>             next_worker__ { 0 };
+    std::mutex                           mutex__;
+    std::condition_variable              job_condition__;
+    std::size_t                          pending_count__ { 0 };
+    bool                                 stopping__ { false };
+#pragma warning(pop)
+  };
+
+} // namespace HAL {
+
+#endif // _HAL_JSEXECUTOR_HPP_
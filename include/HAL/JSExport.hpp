@@ -11,13 +11,44 @@
 
 #include "HAL/detail/JSBase.hpp"
 #include "HAL/detail/JSExportClassDefinitionBuilder.hpp"
+#include "HAL/detail/JSExportClassRegistry.hpp"
+#include "HAL/detail/JSNativeFunction.hpp"
 
+#include <cstddef>
 #include <string>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
 
 namespace HAL {
   
+  /*!
+   @function
+   
+   @abstract Create the JSClass of every JSExport<T> class in the
+   program now instead of on first use, spread across thread_count
+   threads.
+   
+   @discussion Every JSExport<T> whose Class() is used anywhere in the
+   program registers itself during static initialization. Call this
+   once at startup (after main is entered) to move the cost of
+   JSExportInitialize and JSClassCreate out of the first script that
+   touches each class. Each class' duration is logged at the INFO
+   level.
+   
+   @param thread_count The number of threads to use, or 0 to use one
+   per hardware thread.
+   
+   @result How long each class took, in registration order.
+   
+   @throws The first exception thrown by a JSExportInitialize, after
+   all classes have been visited.
+   */
+  HAL_EXPORT std::vector<detail::JSExportClassWarmUp> WarmUpClasses(std::size_t thread_count = 0);
+  
   /*!
    @class
    
@@ -117,11 +148,63 @@ namespace HAL {
      */
     static detail::JSExportClass<T> Class();
     
+    /*!
+     @method
+     
+     @abstract Return the C++ object behind a JavaScript object if it
+     is a T, otherwise nullptr.
+     
+     @discussion A JavaScript object is a T if it was created from
+     JSExport<T>::Class() or from the Class() of a JSExport whose
+     SetParent chain leads to it. This is the same rule JavaScript
+     'instanceof' uses, and is a constant-time type tag test rather
+     than a dynamic_cast.
+     */
+    static T* Downcast(const JSObject& js_object) HAL_NOEXCEPT;
+    
+    /*!
+     @method
+     
+     @abstract Return the JavaScript object that owns a C++ object,
+     i.e. the inverse of Downcast.
+     
+     @discussion Use this when native code hands the same C++ object
+     back to JavaScript more than once, so that JavaScript always sees
+     the same object. The JavaScript object is read from an entry
+     that the C++ object itself holds, so the lookup takes no lock,
+     searches no table and does not allocate a new JavaScript
+     object.
+     
+     @throws std::runtime_error if native_object was not created by
+     JavaScriptCore (e.g. from JSContext::CreateObject or a JavaScript
+     'new' expression) or its JavaScript object has already been
+     garbage collected.
+     */
+    static JSObject Wrap(T& native_object);
+    
     /*
      @method
      @abstract Erase all constant cache
      */
     static void EvictAllCache();
+    
+    /*!
+     @method
+     
+     @abstract Return the occupancy of the pool your native objects
+     are allocated from. All values are zero unless
+     JSExportTraits<T>::use_object_pool is set.
+     */
+    static detail::JSExportObjectPoolStatistics GetObjectPoolStatistics() HAL_NOEXCEPT;
+    
+    /*!
+     @method
+     
+     @abstract Return the cache hit and miss counts of each of your
+     memoized properties, keyed by property name. The sum of the two
+     is the number of times JavaScript read the property.
+     */
+    static std::unordered_map<std::string, detail::JSExportPropertyStatistics> GetPropertyStatistics();
  
     virtual ~JSExport() HAL_NOEXCEPT {
     }
@@ -220,6 +303,61 @@ namespace HAL {
                                  detail::SetNamedValuePropertyCallback<T> set_callback = nullptr,
                                  bool enumerable = true);
 
+    /*!
+     @method
+     
+     @abstract Add a value property with a typed C++ getter and an
+     optional typed setter to your JavaScript object. The property
+     always has the 'DontDelete' attribute, and the 'ReadOnly'
+     attribute if no setter is given.
+     
+     @discussion The getter's result is turned straight into a
+     JSValueRef (e.g. with JSValueMakeNumber) and the setter's
+     argument is read straight from the incoming JSValueRef, so
+     neither a JSObject for 'this' nor a JSValue for the value is
+     constructed. For example, given this class definition:
+     
+     class Foo {
+     std::int32_t get_number() const;
+     void set_number(std::int32_t number);
+     };
+     
+     You would call AddValueProperty like this:
+     
+     AddValueProperty("number", &Foo::get_number, &Foo::set_number);
+     
+     The getter must be a const member function. The value type must
+     be one of double, std::int32_t, std::uint32_t, bool, std::string,
+     JSValue or JSObject, and the setter must return void or bool,
+     which is checked at compile-time.
+     
+     @param property_name A JSString containing your property's name.
+     
+     @param get_callback A pointer to the member function to invoke
+     when getting your property's value.
+     
+     @param set_callback A pointer to the member function to invoke
+     when setting your property's value.
+     
+     @param enumerable An optional property attribute that specifies
+     whether your property is enumerable. The default value is true,
+     which means the property is enumerable.
+     
+     @throws std::invalid_argument exception under these
+     preconditions:
+     
+     1. If property_name is empty.
+     
+     2. You have already added a property with the same property_name.
+     */
+    template<typename R>
+    static typename std::enable_if<detail::IsJSExportTypedGetter<T, R (T::*)() const>::value>::type
+    AddValueProperty(const JSString& property_name, R (T::*get_callback)() const, bool enumerable = true);
+    
+    template<typename R, typename S, typename A>
+    static typename std::enable_if<detail::IsJSExportTypedGetter<T, R (T::*)() const>::value>::type
+    AddValueProperty(const JSString& property_name, R (T::*get_callback)() const, S (T::*set_callback)(A), bool enumerable = true);
+
     /*!
      @method
      
@@ -255,6 +393,53 @@ namespace HAL {
     static void AddConstantProperty(const JSString& property_name,
                                  detail::GetNamedValuePropertyCallback<T> get_callback,
                                  bool enumerable = true);
+    
+    /*!
+     @method
+     
+     @abstract Add a value property whose getter result is cached in
+     each of your JavaScript objects until you call
+     JSExportObject::InvalidateProperty. A successful set from
+     JavaScript also invalidates the cached value.
+     
+     @discussion For example, given this class definition:
+     
+     class Foo : public JSExportObject {
+     JSValue GetSummary() const;
+     void SetName(const std::string& name) {
+     name__ = name;
+     InvalidateProperty("summary");
+     }
+     };
+     
+     You would call AddMemoizedProperty like this:
+     
+     AddMemoizedProperty("summary", &Foo::GetSummary);
+     
+     @param property_name A JSString containing the property's name.
+     
+     @param get_callback The callback to invoke when the property has
+     no cached value.
+     
+     @param set_callback An optional callback to invoke when setting
+     the property's value.
+     
+     @param enumerable An optional property attribute that specifies
+     whether the property is enumerable. The default value is true,
+     which means the property is enumerable.
+     
+     @throws std::invalid_argument exception under these preconditions:
+     
+     1. If property_name is empty.
+     
+     2. If get_callback is not provided.
+     
+     3. You have already added a property with the same property_name.
+     */
+    static void AddMemoizedProperty(const JSString& property_name,
+                                    detail::GetNamedValuePropertyCallback<T> get_callback,
+                                    detail::SetNamedValuePropertyCallback<T> set_callback = nullptr,
+                                    bool enumerable = true);
      
     /*!
      @method
@@ -293,6 +478,59 @@ namespace HAL {
      */
     static void AddFunctionProperty(const JSString& function_name, detail::CallNamedFunctionCallback<T> function_callback, bool enumerable = true);
     
+    /*!
+     @method
+     
+     @abstract Add a function property with a typed C++ signature to
+     your JavaScript object with the 'DontDelete' and 'ReadOnly'
+     attributes. By default the property is enumerable unless you
+     specify otherwise.
+     
+     @discussion Arguments are converted directly from the
+     JavaScriptCore C API arguments array, and the result is
+     converted back directly, so this is considerably cheaper than a
+     function taking a std::vector<JSValue>. For example, given this
+     class definition:
+     
+     class Foo {
+     double Scale(std::int32_t factor, const std::string& unit);
+     };
+     
+     You would call AddFunctionProperty like this:
+     
+     AddFunctionProperty("scale", &Foo::Scale);
+     
+     The argument and result types must be one of double,
+     std::int32_t, std::uint32_t, bool, std::string, JSValue or
+     JSObject (the result may also be void), which is checked at
+     compile-time. Calling the function from JavaScript with fewer
+     arguments than the signature requires throws a JavaScript
+     exception.
+     
+     @param function_name A JSString containing your function's name.
+     
+     @param function_callback A pointer to the member function to
+     invoke when calling your JavaScript object as a function.
+     
+     @param enumerable An optional property attribute that specifies
+     whether your property is enumerable. The default value is true,
+     which means the property is enumerable.
+     
+     @throws std::invalid_argument exception under these
+     preconditions:
+     
+     1. If function_name is empty.
+     
+     2. You have already added a property with the same property_name.
+     */
+    template<typename R, typename... Args>
+    static typename std::enable_if<detail::IsJSExportTypedFunction<T, R (T::*)(Args...)>::value>::type
+    AddFunctionProperty(const JSString& function_name, R (T::*function_callback)(Args...), bool enumerable = true);
+    
+    template<typename R, typename... Args>
+    static typename std::enable_if<detail::IsJSExportTypedFunction<T, R (T::*)(Args...) const>::value>::type
+    AddFunctionProperty(const JSString& function_name, R (T::*function_callback)(Args...) const, bool enumerable = true);
+    
     /*!
      @method
      
@@ -544,7 +782,14 @@ namespace HAL {
     
   private:
     
+    static void WarmUpClass();
+    
     static detail::JSExportClassDefinitionBuilder<T> builder__;
+    
+    // Registers WarmUpClass with JSExportClassRegistry during static
+    // initialization. Class() odr-uses it so that it is instantiated
+    // for every T.
+    static const bool registered__;
   };
   
   template<typename T>
@@ -567,16 +812,49 @@ namespace HAL {
     builder__.AddValueProperty(property_name, get_callback, set_callback, enumerable);
   }
 
+  template<typename T>
+  template<typename R>
+  typename std::enable_if<detail::IsJSExportTypedGetter<T, R (T::*)() const>::value>::type
+  JSExport<T>::AddValueProperty(const JSString& property_name, R (T::*get_callback)() const, bool enumerable) {
+    builder__.AddValueProperty(property_name, detail::MakeGetNamedNativeValuePropertyCallback(get_callback), detail::SetNamedNativeValuePropertyCallback<T>(), enumerable);
+  }
+  
+  template<typename T>
+  template<typename R, typename S, typename A>
+  typename std::enable_if<detail::IsJSExportTypedGetter<T, R (T::*)() const>::value>::type
+  JSExport<T>::AddValueProperty(const JSString& property_name, R (T::*get_callback)() const, S (T::*set_callback)(A), bool enumerable) {
+    builder__.AddValueProperty(property_name, detail::MakeGetNamedNativeValuePropertyCallback(get_callback), detail::MakeSetNamedNativeValuePropertyCallback(set_callback), enumerable);
+  }
+
   template<typename T>
   void JSExport<T>::AddConstantProperty(const JSString& property_name, detail::GetNamedValuePropertyCallback<T> get_callback, bool enumerable) {
     builder__.AddConstantProperty(property_name, get_callback, enumerable);
   }
   
+  template<typename T>
+  void JSExport<T>::AddMemoizedProperty(const JSString& property_name, detail::GetNamedValuePropertyCallback<T> get_callback, detail::SetNamedValuePropertyCallback<T> set_callback, bool enumerable) {
+    builder__.AddMemoizedProperty(property_name, get_callback, set_callback, enumerable);
+  }
+  
   template<typename T>
   void JSExport<T>::AddFunctionProperty(const JSString& function_name, detail::CallNamedFunctionCallback<T> function_callback, bool enumerable) {
     builder__.AddFunctionProperty(function_name, function_callback, enumerable);
   }
   
+  template<typename T>
+  template<typename R, typename... Args>
+  typename std::enable_if<detail::IsJSExportTypedFunction<T, R (T::*)(Args...)>::value>::type
+  JSExport<T>::AddFunctionProperty(const JSString& function_name, R (T::*function_callback)(Args...), bool enumerable) {
+    builder__.AddFunctionProperty(function_name, detail::MakeCallNamedNativeFunctionCallback(function_callback), enumerable);
+  }
+  
+  template<typename T>
+  template<typename R, typename... Args>
+  typename std::enable_if<detail::IsJSExportTypedFunction<T, R (T::*)(Args...) const>::value>::type
+  JSExport<T>::AddFunctionProperty(const JSString& function_name, R (T::*function_callback)(Args...) const, bool enumerable) {
+    builder__.AddFunctionProperty(function_name, detail::MakeCallNamedNativeFunctionCallback(function_callback), enumerable);
+  }
+  
   template<typename T>
   void JSExport<T>::AddHasPropertyCallback(const detail::HasPropertyCallback<T>& has_property_callback) {
     builder__.HasProperty(has_property_callback);
@@ -615,8 +893,17 @@ namespace HAL {
   template<typename T>
   detail::JSExportClassDefinitionBuilder<T> JSExport<T>::builder__ = detail::JSExportClassDefinitionBuilder<T>(typeid(T).name());
   
+  template<typename T>
+  const bool JSExport<T>::registered__ = detail::JSExportClassRegistry::Register(typeid(T).name(), &JSExport<T>::WarmUpClass);
+  
+  template<typename T>
+  void JSExport<T>::WarmUpClass() {
+    Class();
+  }
+  
   template<typename T>
   detail::JSExportClass<T> JSExport<T>::Class() {
+    static_cast<void>(registered__);
     static detail::JSExportClassDefinition<T> js_export_class_definition;
     static detail::JSExportClass<T>           js_export_class;
     static std::once_flag                     of;
@@ -629,10 +916,30 @@ namespace HAL {
     return js_export_class;
   }
   
+  template<typename T>
+  T* JSExport<T>::Downcast(const JSObject& js_object) HAL_NOEXCEPT {
+    return detail::JSExportClass<T>::Downcast(static_cast<JSContextRef>(js_object.get_context()), static_cast<JSObjectRef>(js_object));
+  }
+  
+  template<typename T>
+  JSObject JSExport<T>::Wrap(T& native_object) {
+    return detail::JSExportClass<T>::Wrap(native_object);
+  }
+  
+  template<typename T>
+  std::unordered_map<std::string, detail::JSExportPropertyStatistics> JSExport<T>::GetPropertyStatistics() {
+    return detail::JSExportClass<T>::GetPropertyStatistics();
+  }
+  
   template<typename T>
   void JSExport<T>::EvictAllCache() {
     detail::JSExportClass<T>::EvictAllCache();
   }
+  
+  template<typename T>
+  detail::JSExportObjectPoolStatistics JSExport<T>::GetObjectPoolStatistics() HAL_NOEXCEPT {
+    return detail::JSExportObjectPool<T>::GetStatistics();
+  }
 } // namespace HAL {
 
 #endif // _HAL_JSEXPORT_HPP_
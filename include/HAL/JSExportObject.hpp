@@ -13,9 +13,15 @@
 #include "HAL/JSContext.hpp"
 #include "HAL/JSString.hpp"
 #include "HAL/JSValue.hpp"
+#include "HAL/detail/JSExportTypeTag.hpp"
+#include "HAL/detail/JSExportFinalizerQueue.hpp"
+#include "HAL/detail/JSExportIdentityMap.hpp"
 
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <unordered_set>
+#include <unordered_map>
 
 namespace HAL { namespace detail {
   template<typename T>
@@ -92,11 +98,66 @@ namespace HAL {
      JavaScript 'new' expression.
     */
     virtual void postCallAsConstructor(const JSContext& js_context, const std::vector<JSValue>& arguments);
+    
+    /*!
+     @method
+     
+     @abstract Discard the cached value of a memoized property so that
+     the next JavaScript read calls its getter again.
+     
+     @discussion Call this whenever the state a memoized property's
+     getter depends on changes. See
+     JSExport<T>::AddMemoizedProperty.
+     
+     @param property_name The name of the memoized property.
+     */
+    void InvalidateProperty(const std::string& property_name) HAL_NOEXCEPT;
+    
+    /*!
+     @method
+     
+     @abstract Discard the cached values of all memoized properties.
+     */
+    void InvalidateProperties() HAL_NOEXCEPT;
 		
   private:
     
+    // JSExportClass sets js_export_type_tag__ and
+    // js_export_signature__ when it creates this object.
+    template<typename T>
+    friend class detail::JSExportClass;
+    
+    friend const detail::JSExportTypeTag* detail::GetJSExportTypeTag(const JSExportObject* native_object_ptr) HAL_NOEXCEPT;
+    friend class detail::JSExportIdentityMap;
+    
+    // Return the cached value of a memoized property, or nullptr.
+    JSValueRef GetMemoizedProperty(const std::string& property_name) HAL_NOEXCEPT;
+    void       SetMemoizedProperty(const std::string& property_name, const JSValue& js_value);
+    
+    // These come first so that reading them through the private data
+    // of an object of any other class stays inside that private data.
+    // The signature is this object's address mixed with
+    // detail::JSExportSignatureKey, which the private data of other
+    // classes does not hold at this offset, so GetJSExportTypeTag
+    // only trusts the tag when the signature matches.
+    std::uintptr_t                 js_export_signature__ { 0 };
+    const detail::JSExportTypeTag* js_export_type_tag__  { nullptr };
+    
     JSContext js_context__;
     
+    // Links this object into a JSExportFinalizerQueue.
+    detail::JSExportFinalizerQueue::Node finalizer_node__;
+    
+    // The JavaScript object that owns this object.
+    detail::JSExportIdentityMap::Entry identity_map_entry__;
+    
+    // Silence 4251 on Windows since private member variables do not
+    // need to be exported from a DLL.
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    std::unordered_map<std::string, JSValue> memoized_properties__;
+#pragma warning(pop)
+    
 #undef  HAL_JSEXPORTOBJECT_LOCK_GUARD
 #ifdef  HAL_THREAD_SAFE
     std::recursive_mutex mutex__;
@@ -113,4 +174,19 @@ namespace HAL {
   
 } // namespace HAL {
 
+namespace HAL { namespace detail {
+  
+  inline std::uintptr_t GetJSExportSignature(const JSExportObject* native_object_ptr) HAL_NOEXCEPT {
+    return reinterpret_cast<std::uintptr_t>(native_object_ptr) ^ JSExportSignatureKey;
+  }
+  
+  inline const JSExportTypeTag* GetJSExportTypeTag(const JSExportObject* native_object_ptr) HAL_NOEXCEPT {
+    if (native_object_ptr -> js_export_signature__ != GetJSExportSignature(native_object_ptr)) {
+      return nullptr;
+    }
+    return native_object_ptr -> js_export_type_tag__;
+  }
+  
+}} // namespace HAL { namespace detail {
+
 #endif // _HAL_JSEXPORTOBJECT_HPP_
@@ -0,0 +1,74 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_JSEXPORTTRAITS_HPP_
+#define _HAL_JSEXPORTTRAITS_HPP_
+
+#include <cstddef>
+
+namespace HAL {
+  
+  /*!
+   @class
+   
+   @discussion The default allocation policy for the native objects
+   behind JSExport<T> JavaScript objects: each one is created with
+   new and destroyed with delete.
+   */
+  struct JSExportDefaultTraits {
+    
+    // Set to true to allocate native objects from a per-type slab
+    // pool instead of the global allocator.
+    static const bool use_object_pool = false;
+    
+    // The number of native objects carved out of each slab.
+    static const std::size_t object_pool_slab_size = 64;
+    
+    // The maximum number of free native objects each thread keeps
+    // for itself before returning them to the shared pool. This only
+    // applies when HAL_THREAD_SAFE is defined.
+    static const std::size_t object_pool_thread_cache_size = 32;
+    
+    // Set to true to run native destructors outside of the garbage
+    // collector's finalizer. The native object is queued instead and
+    // destroyed by JSContextGroup::DrainFinalizers.
+    static const bool defer_finalization = false;
+    
+    // Set to true, together with defer_finalization, if the native
+    // destructor may run on any thread. The native object is then
+    // destroyed on a background finalizer thread without waiting for
+    // JSContextGroup::DrainFinalizers. This requires HAL_THREAD_SAFE,
+    // since the JSExportObject destructor then runs concurrently with
+    // the JavaScript thread.
+    static const bool thread_safe_finalization = false;
+  };
+  
+  /*!
+   @class
+   
+   @discussion JSExportTraits let a C++ class exposed through
+   JSExport<T> change how its native objects are allocated. Apps that
+   churn through many short-lived JavaScript objects can opt in to a
+   per-type pool so that the JavaScriptCore garbage collector's
+   finalizers no longer hit the global allocator. For example:
+   
+   template<>
+   struct JSExportTraits<Widget> : JSExportDefaultTraits {
+   static const bool use_object_pool = true;
+   };
+   
+   The specialization must be visible wherever JSExport<Widget>::Class
+   is used, so declare it in the same header as Widget.
+   */
+  template<typename T>
+  struct JSExportTraits : JSExportDefaultTraits {
+  };
+  
+} // namespace HAL {
+
+#endif // _HAL_JSEXPORTTRAITS_HPP_
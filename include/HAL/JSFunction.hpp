@@ -10,8 +10,9 @@
 #define _HAL_JSFUNCTION_HPP_
 
 #include "HAL/JSObject.hpp"
+#include "HAL/JSString.hpp"
+#include "HAL/detail/JSNativeFunction.hpp"
 #include <functional>
-#include <unordered_map>
 
 namespace HAL {
 
@@ -30,17 +31,16 @@ namespace HAL {
 class HAL_EXPORT JSFunction final : public JSObject HAL_PERFORMANCE_COUNTER2(JSFunction) {
 
 public:
-    
-    static void RegisterJSFunctionCallback(JSObjectRef js_object_ref, JSFunctionCallback);
-    static void UnRegisterJSFunctionCallback(JSObjectRef js_object_ref);
-    static JSFunctionCallback FindJSFunctionCallback(JSObjectRef js_object_ref);
 
-    JSFunction(const JSFunction& rhs);
-    JSFunction(JSFunction&& rhs);
-    JSFunction& operator=(const JSFunction& rhs);
-    JSFunction& operator=(JSFunction&& rhs);
+    // The callback belongs to the JavaScript function object, so a
+    // copy is just another reference to the same function.
+    JSFunction(const JSFunction&)            = default;
+    JSFunction(JSFunction&&)                 = default;
+    JSFunction& operator=(const JSFunction&) = default;
+    JSFunction& operator=(JSFunction&&)      = default;
 
-    virtual ~JSFunction() HAL_NOEXCEPT;
+    virtual ~JSFunction() HAL_NOEXCEPT {
+    }
 
 private:
     
@@ -49,23 +49,25 @@ private:
     
     JSFunction(const JSContext& js_context, const JSString& body, const std::vector<JSString>& parameter_names, const JSString& function_name, const JSString& source_url, int starting_line_number);
     JSFunction(const JSContext& js_context, const JSString& function_name, const JSFunctionCallback& callback);
+    JSFunction(const JSContext& js_context, const JSString& function_name, const detail::JSNativeFunctionCallback& callback);
+    JSFunction(const JSContext& js_context, const JSString& function_name);
 
     static JSObjectRef MakeFunction(const JSContext& js_context, const JSString& body, const std::vector<JSString>& parameter_names, const JSString& function_name, const JSString& source_url, int starting_line_number);
-
-    static JSValueRef  JSObjectCallAsFunctionCallback(JSContextRef context_ref, JSObjectRef function_ref, JSObjectRef this_object_ref, size_t argument_count, const JSValueRef arguments_array[], JSValueRef* exception);
-    static JSObjectRef MakeFunction(const JSContext& js_context, const JSString& function_name, const JSFunctionCallback& callback);
-
-    void RetainCallbackAfterCopy();
-
-    // Silence 4251 on Windows since private member variables do not
-    // need to be exported from a DLL.
-#pragma warning(push)
-#pragma warning(disable: 4251)
-    static std::unordered_map<std::intptr_t, JSFunctionCallback> js_object_ref_to_js_function__;
-#pragma warning(pop)
-
 };
 
+template<typename R, typename... Args>
+typename std::enable_if<!std::is_same<std::function<R(Args...)>, JSFunctionCallback>::value, JSFunction>::type
+JSContext::CreateFunction(std::function<R(Args...)> callback) const {
+    return CreateFunction(JSString(), callback);
+}
+
+template<typename R, typename... Args>
+typename std::enable_if<!std::is_same<std::function<R(Args...)>, JSFunctionCallback>::value, JSFunction>::type
+JSContext::CreateFunction(const JSString& function_name, std::function<R(Args...)> callback) const {
+    HAL_JSCONTEXT_LOCK_GUARD;
+    return JSFunction(JSContext(js_global_context_ref__), function_name, detail::MakeJSNativeFunctionCallback(callback));
+}
+
 } // namespace HAL {
 
 #endif // _HAL_JSFUNCTION_HPP_
@@ -0,0 +1,197 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_JSINVOKER_HPP_
+#define _HAL_JSINVOKER_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+#include "HAL/JSContext.hpp"
+#include "HAL/JSValue.hpp"
+#include "HAL/JSObject.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace HAL {
+
+  /*!
+   @class
+
+   @discussion A JSInvoker calls the same JavaScript function many
+   times, e.g. a filter or a mapper over a large number of native
+   records, with as little overhead per call as possible.
+
+   The function is checked once, when the JSInvoker is created. Each
+   call then goes straight to JSObjectCallAsFunction with an argument
+   array the JSInvoker reuses, and only a call that throws pays for
+   decoding the JavaScript exception:
+
+   JSInvoker is_match(filter, global_object, 2);
+   for (const auto& record : records) {
+     const auto name  = js_context.CreateString(record.name);
+     const auto score = js_context.CreateNumber(record.score);
+     is_match.SetArgument(0, name);
+     is_match.SetArgument(1, score);
+     if (is_match.InvokeAsBoolean()) {
+       ...
+     }
+   }
+
+   The argument array holds JSValueRefs without protecting them, so
+   the JSValues passed to SetArgument must stay alive until the call.
+   A JSInvoker must not be used by more than one thread at a time.
+   */
+  class HAL_EXPORT JSInvoker final HAL_PERFORMANCE_COUNTER1(JSInvoker) {
+
+  public:
+
+    /*!
+     @method
+
+     @abstract Create a JSInvoker that calls function with this_object
+     as 'this'.
+
+     @param arity The number of arguments that SetArgument fills in
+     before each Invoke.
+
+     @throws std::runtime_error if function can't be called as a
+     function.
+     */
+    JSInvoker(const JSObject& function, const JSObject& this_object, std::size_t arity = 0);
+
+    std::size_t get_arity() const HAL_NOEXCEPT {
+      return arguments__.size();
+    }
+
+    /*!
+     @method
+
+     @abstract Set argument index of the following calls to Invoke.
+     */
+    void SetArgument(std::size_t index, const JSValue& argument) HAL_NOEXCEPT {
+      arguments__[index] = static_cast<JSValueRef>(argument);
+    }
+
+    void SetArgument(std::size_t index, const JSObject& argument) HAL_NOEXCEPT {
+      arguments__[index] = static_cast<JSObjectRef>(argument);
+    }
+
+    /*!
+     @method
+
+     @abstract Call the function with the arguments set by
+     SetArgument.
+
+     @result The function's return value.
+
+     @throws std::runtime_error if the function threw a JavaScript
+     exception.
+     */
+    JSValue Invoke() {
+      return JSValue(js_context__, InvokeWithArguments());
+    }
+
+    /*!
+     @method
+
+     @abstract Call the function with the arguments set by SetArgument
+     and convert its return value to a boolean, without creating a
+     JSValue for it.
+
+     @throws std::runtime_error if the function threw a JavaScript
+     exception.
+     */
+    bool InvokeAsBoolean() {
+      return JSValueToBoolean(context_ref__, InvokeWithArguments());
+    }
+
+    /*!
+     @method
+
+     @abstract Call the function with the arguments set by SetArgument
+     and convert its return value to a number, without creating a
+     JSValue for it.
+
+     @throws std::runtime_error if either the function threw a
+     JavaScript exception, or its return value can't be converted to
+     a number.
+     */
+    double InvokeAsNumber();
+
+    /*!
+     @method
+
+     @abstract Call the function with the given arguments, which must
+     be JSValues or JSObjects, bypassing the SetArgument array.
+
+     @throws std::runtime_error if the function threw a JavaScript
+     exception.
+     */
+    template<typename... Args>
+    typename std::enable_if<detail::IsJSValueArguments<Args...>::value, JSValue>::type
+    operator()(const Args&... arguments) {
+      const JSValueRef arguments_array[sizeof...(Args) + 1] = { static_cast<JSValueRef>(arguments)..., nullptr };
+      return JSValue(js_context__, Call(arguments_array, sizeof...(Args)));
+    }
+
+    /*!
+     @method
+
+     @abstract Call the function once for each of arguments, passing
+     it as the only argument, and store the return values in results.
+
+     @discussion results is cleared first, so a caller can reuse one
+     vector (and its capacity) for many batches.
+
+     @throws std::runtime_error if the function threw a JavaScript
+     exception. results then holds the return values of the calls
+     before it.
+     */
+    void Map(const std::vector<JSValue>& arguments, std::vector<JSValue>& results);
+
+  private:
+
+    JSValueRef InvokeWithArguments() {
+      return Call(arguments__.empty() ? nullptr : &arguments__[0], arguments__.size());
+    }
+
+    JSValueRef Call(const JSValueRef arguments_array[], std::size_t argument_count) {
+      JSValueRef exception { nullptr };
+      const auto js_value_ref = JSObjectCallAsFunction(context_ref__, function_ref__, this_object_ref__, argument_count, arguments_array, &exception);
+      if (exception) {
+        ThrowException(exception);
+      }
+      return js_value_ref;
+    }
+
+    void ThrowException(JSValueRef exception) const;
+
+    JSInvoker(const JSInvoker&)            = delete;
+    JSInvoker& operator=(const JSInvoker&) = delete;
+
+    // The JSObjects keep the function and 'this' protected, and the
+    // raw refs save converting them on every call.
+    JSContext    js_context__;
+    JSObject     function__;
+    JSObject     this_object__;
+    JSContextRef context_ref__;
+    JSObjectRef  function_ref__;
+    JSObjectRef  this_object_ref__;
+
+    // Silence 4251 on Windows since private member variables do not
+    // need to be exported from a DLL.
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    std::vector<JSValueRef> arguments__;
+#pragma warning(pop)
+  };
+
+} // namespace HAL {
+
+#endif // _HAL_JSINVOKER_HPP_
@@ -11,10 +11,13 @@
 
 #include "HAL/detail/JSBase.hpp"
 #include "HAL/JSContext.hpp"
+#include "HAL/JSValue.hpp"
 #include "HAL/JSPropertyAttribute.hpp"
 #include "HAL/JSPropertyNameArray.hpp"
 
+#include <cstddef>
 #include <memory>
+#include <type_traits>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
@@ -33,6 +36,16 @@ namespace HAL {
   namespace detail {
     template<typename T>
     class JSExportClass;
+    
+    // True if every type is a JSValue or a JSObject, or derived from
+    // either, i.e. the types JSObject::Call accepts as arguments.
+    template<typename... Args>
+    struct IsJSValueArguments : std::true_type {
+    };
+    
+    template<typename T, typename... Args>
+    struct IsJSValueArguments<T, Args...> : std::integral_constant<bool, (std::is_base_of<JSValue, T>::value || std::is_base_of<JSObject, T>::value) && IsJSValueArguments<Args...>::value> {
+    };
   }
 }
 
@@ -104,6 +117,36 @@ namespace HAL {
      */
     virtual JSValue GetProperty(unsigned property_index) const final;
     
+    /*!
+     @method
+     
+     @abstract Return a property of this JavaScript object without
+     throwing if getting it throws a JavaScript exception.
+     
+     @param property_name The name of the property to get.
+     
+     @result The property's value (JSUndefined if this JavaScript
+     object doesn't have the property), or the JavaScript exception
+     getting it threw.
+     */
+    virtual JSResult TryGetProperty(const JSString& property_name) const HAL_NOEXCEPT final;
+    
+    /*!
+     @method
+     
+     @abstract Return a property of this JavaScript object by numeric
+     index without throwing if getting it throws a JavaScript
+     exception.
+     
+     @param property_index An integer value that is the property's
+     name.
+     
+     @result The property's value (JSUndefined if this JavaScript
+     object doesn't have the property), or the JavaScript exception
+     getting it threw.
+     */
+    virtual JSResult TryGetProperty(unsigned property_index) const HAL_NOEXCEPT final;
+    
     /*!
      @method
      
@@ -203,6 +246,10 @@ namespace HAL {
      @abstract Determine whether this JavaScript object is an
      Error.
      
+     @discussion This is an instanceof test against the Error
+     constructor of this object's context, so Errors created in
+     another context are not recognized.
+     
      @result true if this JavaScript object is an Error.
      */
     virtual bool IsError() const HAL_NOEXCEPT final;
@@ -237,6 +284,64 @@ namespace HAL {
     virtual JSValue operator()(const std::vector<JSValue>&  arguments, JSObject this_object) final;
     virtual JSValue operator()(const std::vector<JSString>& arguments, JSObject this_object) final;
     
+    /*!
+     @method
+     
+     @abstract Call this JavaScript object as a function without
+     throwing if the call throws a JavaScript exception.
+     
+     @param arguments The arguments to pass to the function.
+     
+     @param this_object The JavaScript object to use as 'this'.
+     
+     @result The function's return value, or the JavaScript exception
+     the call threw (a TypeError if this JavaScript object can't be
+     called as a function).
+     */
+    virtual JSResult TryCall(const std::vector<JSValue>& arguments, JSObject this_object) HAL_NOEXCEPT final;
+    
+    /*!
+     @method
+     
+     @abstract Call this JavaScript object as a function without
+     building a std::vector of arguments.
+     
+     @discussion Each argument must be a JSValue or a JSObject (or a
+     class derived from either). Their JSValueRefs are gathered into
+     an array on the stack and passed straight to JavaScriptCore, so
+     the call itself makes no heap allocation:
+     
+     auto result = js_function.Call(global_object, js_context.CreateNumber(42), js_object);
+     
+     @param this_object The JavaScript object to use as 'this'.
+     
+     @param arguments The arguments to pass to the function.
+     
+     @result Return the function's return value.
+     
+     @throws std::runtime_error if either this JavaScript object can't
+     be called as a function, or calling the function itself threw a
+     JavaScript exception.
+     */
+    template<typename... Args>
+    typename std::enable_if<detail::IsJSValueArguments<Args...>::value, JSValue>::type
+    Call(const JSObject& this_object, const Args&... arguments);
+    
+    /*!
+     @method
+     
+     @abstract Call this JavaScript object as a function with
+     argument_count arguments starting at arguments.
+     
+     @discussion Up to eight arguments are passed without a heap
+     allocation.
+     
+     @throws std::runtime_error if either this JavaScript object can't
+     be called as a function, or calling the function itself threw a
+     JavaScript exception.
+     */
+    JSValue Call(const JSValue arguments[], std::size_t argument_count, const JSObject& this_object);
+    
     /*!
      @method
      
@@ -268,6 +373,22 @@ namespace HAL {
     virtual JSObject CallAsConstructor(const std::vector<JSString>& arguments) final;
     virtual JSObject CallAsConstructor(const std::vector<JSValue>&  arguments) final;
     
+    /*!
+     @method
+     
+     @abstract Call this JavaScript object as a constructor without
+     building a std::vector of arguments. See Call.
+     
+     @throws std::runtime_error if either this JavaScript object can't
+     be called as a constructor, or calling the constructor itself
+     threw a JavaScript exception.
+     */
+    template<typename... Args>
+    typename std::enable_if<detail::IsJSValueArguments<Args...>::value, JSObject>::type
+    Construct(const Args&... arguments);
+    
+    JSObject Construct(const JSValue arguments[], std::size_t argument_count);
+    
     /*!
      @method
      
@@ -384,6 +505,11 @@ namespace HAL {
      */
     virtual JSValue CallAsFunction(const std::vector<JSValue>&  arguments, JSObject this_object);
 
+    // The implementation of all of the ways of calling this JavaScript
+    // object.
+    JSValue  CallAsFunction(const JSValueRef arguments_array[], std::size_t argument_count, JSObjectRef this_object_ref);
+    JSObject CallAsConstructor(const JSValueRef arguments_array[], std::size_t argument_count);
+
     /*!
      @method
      
@@ -468,6 +594,21 @@ namespace HAL {
     first.swap(second);
   }
   
+  // The arrays have a trailing nullptr so that they are never empty.
+  template<typename... Args>
+  typename std::enable_if<detail::IsJSValueArguments<Args...>::value, JSValue>::type
+  JSObject::Call(const JSObject& this_object, const Args&... arguments) {
+    const JSValueRef arguments_array[sizeof...(Args) + 1] = { static_cast<JSValueRef>(arguments)..., nullptr };
+    return CallAsFunction(arguments_array, sizeof...(Args), static_cast<JSObjectRef>(this_object));
+  }
+  
+  template<typename... Args>
+  typename std::enable_if<detail::IsJSValueArguments<Args...>::value, JSObject>::type
+  JSObject::Construct(const Args&... arguments) {
+    const JSValueRef arguments_array[sizeof...(Args) + 1] = { static_cast<JSValueRef>(arguments)..., nullptr };
+    return CallAsConstructor(arguments_array, sizeof...(Args));
+  }
+  
   template<typename T>
   std::shared_ptr<T> JSObject::GetPrivate() const HAL_NOEXCEPT {
     return std::shared_ptr<T>(std::make_shared<JSObject>(*this), dynamic_cast<T*>(static_cast<JSExportObject*>(GetPrivate())));
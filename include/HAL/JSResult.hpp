@@ -0,0 +1,134 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_JSRESULT_HPP_
+#define _HAL_JSRESULT_HPP_
+
+#include "HAL/JSValue.hpp"
+
+#include <string>
+
+namespace HAL {
+
+  /*!
+   @class
+
+   @discussion A JSResult is the outcome of one of the non-throwing
+   Try* member functions of JSObject, JSValue and JSContext: either
+   the JSValue the operation produced, or the JavaScript exception it
+   threw.
+
+   The throwing API decodes every JavaScript exception into a C++
+   exception, which looks up the global Error constructor and reads
+   half a dozen properties of the exception. A JSResult holds the
+   exception exactly as JavaScriptCore reported it and decodes it only
+   if you ask, so probing for something that usually fails is cheap:
+
+   auto result = js_object.TryGetProperty("name");
+   if (result) {
+     Use(result.get_value());
+   }
+
+   The only way to create a JSResult is by using the Try* member
+   functions.
+   */
+  class HAL_EXPORT JSResult final HAL_PERFORMANCE_COUNTER1(JSResult) {
+
+  public:
+
+    /*!
+     @method
+
+     @abstract Return whether the operation threw a JavaScript
+     exception.
+     */
+    bool HasException() const HAL_NOEXCEPT {
+      return has_exception__;
+    }
+
+    /*!
+     @method
+
+     @abstract Return true if the operation did not throw a JavaScript
+     exception.
+     */
+    explicit operator bool() const HAL_NOEXCEPT {
+      return !has_exception__;
+    }
+
+    /*!
+     @method
+
+     @abstract Return the value the operation produced.
+
+     @throws std::runtime_error (or detail::js_runtime_error for Error
+     objects) decoded from the exception, exactly as the throwing
+     member function would have thrown it, if the operation threw a
+     JavaScript exception.
+     */
+    JSValue get_value() const;
+
+    /*!
+     @method
+
+     @abstract Return the JavaScript exception the operation threw, or
+     JSUndefined if it did not throw.
+     */
+    JSValue get_exception() const HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Return the message of the JavaScript exception the
+     operation threw (i.e. the exception converted to a string, such
+     as "TypeError: undefined is not a function"), or an empty string
+     if it did not throw.
+     */
+    std::string get_exception_message() const;
+
+    /*!
+     @method
+
+     @abstract Throw the JavaScript exception the operation threw, if
+     any, the same way as the throwing member function would have.
+     */
+    void ThrowIfException() const;
+
+    // For interoperability with the JavaScriptCore C API. This is the
+    // exception the operation threw, or nullptr if it did not throw.
+    JSValueRef get_exception_ref() const HAL_NOEXCEPT {
+      return has_exception__ ? static_cast<JSValueRef>(js_value__) : nullptr;
+    }
+
+  private:
+
+    // Only these classes can create a JSResult.
+    friend class JSContext;
+    friend class JSValue;
+    friend class JSObject;
+
+    static JSResult Value(const JSContext& js_context, JSValueRef js_value_ref) HAL_NOEXCEPT;
+    static JSResult Exception(const JSContext& js_context, JSValueRef exception_ref, const char* internal_component_name, const std::string& source_url = "", int line_number = 0) HAL_NOEXCEPT;
+
+    JSResult(const JSValue& js_value, bool has_exception, const char* internal_component_name, const std::string& source_url, int line_number) HAL_NOEXCEPT;
+
+    // Silence 4251 on Windows since private member variables do not
+    // need to be exported from a DLL.
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    JSValue     js_value__;
+    bool        has_exception__;
+    const char* internal_component_name__;
+    std::string source_url__;
+    int         line_number__;
+#pragma warning(pop)
+  };
+
+} // namespace HAL {
+
+#endif // _HAL_JSRESULT_HPP_
@@ -26,6 +26,7 @@ namespace HAL {
   class JSDate;
   class JSError;
   class JSRegExp;
+  class JSResult;
   
   namespace detail {
     template<typename T>
@@ -168,6 +169,18 @@ namespace HAL {
      */
     explicit operator JSObject() const;
     
+    /*!
+     @method
+     
+     @abstract Convert this JSValue to a JSObject without throwing if
+     the conversion throws a JavaScript exception (e.g. for undefined
+     and null).
+     
+     @result The converted object, or the JavaScript exception the
+     conversion threw.
+     */
+    virtual JSResult TryToObject() const HAL_NOEXCEPT final;
+    
     /*!
      @method
      
@@ -0,0 +1,76 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSARGUMENTBUFFER_HPP_
+#define _HAL_DETAIL_JSARGUMENTBUFFER_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+#include "HAL/JSValue.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion JSArgumentBuffer converts JSValue arguments to the
+   JSValueRef array the JavaScriptCore C API expects. Up to
+   inline_capacity arguments are stored in the buffer itself, so for
+   common arities a call makes no heap allocation. Longer argument
+   lists fall back to a std::vector.
+
+   A JSArgumentBuffer does not protect the values, so it must not
+   outlive the JSValues it was built from.
+   */
+  class JSArgumentBuffer final {
+
+  public:
+
+    static const std::size_t inline_capacity = 8;
+
+    JSArgumentBuffer(const JSValue arguments[], std::size_t argument_count)
+    : size__(argument_count) {
+      JSValueRef* data = inline_data__;
+      if (argument_count > inline_capacity) {
+        heap_data__.resize(argument_count);
+        data = &heap_data__[0];
+      }
+      for (std::size_t i = 0; i < argument_count; ++i) {
+        data[i] = static_cast<JSValueRef>(arguments[i]);
+      }
+      data__ = argument_count > 0 ? data : nullptr;
+    }
+
+    explicit JSArgumentBuffer(const std::vector<JSValue>& arguments)
+    : JSArgumentBuffer(arguments.empty() ? nullptr : &arguments[0], arguments.size()) {
+    }
+
+    const JSValueRef* data() const HAL_NOEXCEPT {
+      return data__;
+    }
+
+    std::size_t size() const HAL_NOEXCEPT {
+      return size__;
+    }
+
+  private:
+
+    JSArgumentBuffer(const JSArgumentBuffer&)            = delete;
+    JSArgumentBuffer& operator=(const JSArgumentBuffer&) = delete;
+
+    std::size_t             size__;
+    const JSValueRef*       data__ { nullptr };
+    JSValueRef              inline_data__[inline_capacity];
+    std::vector<JSValueRef> heap_data__;
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSARGUMENTBUFFER_HPP_
@@ -18,6 +18,7 @@
 
 #define HAL_NOEXCEPT_ENABLE
 #define HAL_MOVE_CTOR_AND_ASSIGN_DEFAULT_ENABLE
+#define HAL_THREAD_LOCAL_ENABLE
 
 // See http://msdn.microsoft.com/en-us/library/b0084kay.aspx for the
 // list of Visual C++ "Predefined Macros". Visual Studio 2013 Update 3
@@ -42,6 +43,10 @@
 #undef HAL_NOEXCEPT_ENABLE
 #undef HAL_MOVE_CTOR_AND_ASSIGN_DEFAULT_ENABLE
 
+// VS 2013 does not support the thread_local storage class
+// specifier.
+#undef HAL_THREAD_LOCAL_ENABLE
+
 #endif  // #defined(_MSC_VER) && _MSC_VER <= 1800
 
 #ifdef HAL_NOEXCEPT_ENABLE
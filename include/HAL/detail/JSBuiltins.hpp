@@ -0,0 +1,73 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSBUILTINS_HPP_
+#define _HAL_DETAIL_JSBUILTINS_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion JSBuiltins returns the JavaScript builtins that HAL
+   itself calls. Each one is looked up on the global object the first
+   time it is needed in a context and then kept in a JSContextSlots
+   slot, so replacing a builtin on the global object after its first
+   use doesn't affect HAL. Reading a slot costs about as much as the
+   property lookups it replaces (see JSContextSlot), so this is not a
+   way to make the lookups cheaper.
+   */
+  class HAL_EXPORT JSBuiltins final HAL_PERFORMANCE_COUNTER1(JSBuiltins) {
+
+  public:
+
+    /*!
+     @method
+
+     @abstract Return Array.isArray, or nullptr if it isn't an object.
+     */
+    static JSObjectRef GetArrayIsArray(JSContextRef context_ref) HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Return the Error constructor, or nullptr if it isn't an
+     object.
+     */
+    static JSObjectRef GetErrorConstructor(JSContextRef context_ref) HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Return Error.prototype, or nullptr if it isn't an
+     object.
+     */
+    static JSObjectRef GetErrorPrototype(JSContextRef context_ref) HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Return Function.prototype, or nullptr if it isn't an
+     object.
+     */
+    static JSObjectRef GetFunctionPrototype(JSContextRef context_ref) HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Return the TypeError constructor, or nullptr if it
+     isn't an object.
+     */
+    static JSObjectRef GetTypeErrorConstructor(JSContextRef context_ref) HAL_NOEXCEPT;
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSBUILTINS_HPP_
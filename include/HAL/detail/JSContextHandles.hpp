@@ -0,0 +1,165 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSCONTEXTHANDLES_HPP_
+#define _HAL_DETAIL_JSCONTEXTHANDLES_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#ifndef HAL_THREAD_LOCAL_ENABLE
+#include <mutex>
+#include <thread>
+#endif
+
+namespace HAL { namespace detail {
+
+  struct JSContextHandleBlock;
+
+  /*!
+   @class
+
+   @discussion JSContextHandles counts the JSContext objects (including
+   the ones inside every JSValue and JSObject) that refer to each
+   global context.
+
+   A function object owns its C++ callback until it is finalized. A
+   callback that captures a handle to the function's own context
+   keeps that context alive, so the context and the function could
+   never be collected. To break the cycle the handles a callback
+   captures are counted as captured (see CaptureScope), and once every
+   remaining handle to a context is captured the owners of those
+   handles are told to drop them. No native code can reach the
+   context at that point, so nothing can call the dropped callbacks
+   except scripts that keep running on a context that is only reached
+   through raw JavaScriptCore references; those calls return
+   undefined.
+   */
+  class HAL_EXPORT JSContextHandles final HAL_PERFORMANCE_COUNTER1(JSContextHandles) {
+
+  public:
+
+    /*!
+     @class
+
+     @discussion An Owner holds captured handles. It is reference
+     counted, because it is shared by the object that owns it and by
+     the context whose handles it captured.
+     */
+    class HAL_EXPORT Owner {
+
+    public:
+
+      Owner() HAL_NOEXCEPT {
+      }
+
+      virtual ~Owner() HAL_NOEXCEPT {
+      }
+
+      void Retain() HAL_NOEXCEPT {
+        ++reference_count__;
+      }
+
+      void Release() HAL_NOEXCEPT {
+        if (--reference_count__ == 0) {
+          delete this;
+        }
+      }
+
+      /*!
+       @method
+
+       @abstract Destroy the captured handles. This is called at most
+       once, on the thread that released the last handle that was not
+       captured, and never while the JSContextHandles lock is held.
+       */
+      virtual void DropCaptures() HAL_NOEXCEPT = 0;
+
+      Owner(const Owner&)            = delete;
+      Owner& operator=(const Owner&) = delete;
+
+    private:
+
+      friend class JSContextHandles;
+
+#pragma warning(push)
+#pragma warning(disable: 4251)
+      std::atomic<std::size_t> reference_count__ { 1 };
+      JSContextHandleBlock*    block_ptr__       { nullptr };
+      std::size_t              capture_count__   { 0 };
+#pragma warning(pop)
+    };
+
+    /*!
+     @class
+
+     @discussion While a CaptureScope is alive, the handles created
+     and destroyed on its thread are counted, so that copying a
+     callback inside the scope tells how many handles the copy holds.
+     Scopes should not be nested.
+     */
+    class HAL_EXPORT CaptureScope final {
+
+    public:
+
+      CaptureScope() HAL_NOEXCEPT;
+      ~CaptureScope() HAL_NOEXCEPT;
+
+      /*!
+       @method
+
+       @abstract Record that owner_ptr holds the handles to the global
+       context of context_ref that were created in this scope.
+       */
+      void Adopt(JSContextRef context_ref, Owner* owner_ptr);
+
+      CaptureScope(const CaptureScope&)            = delete;
+      CaptureScope& operator=(const CaptureScope&) = delete;
+
+    private:
+
+      friend class JSContextHandles;
+
+      void Count(JSContextHandleBlock* block_ptr, std::ptrdiff_t delta);
+
+#pragma warning(push)
+#pragma warning(disable: 4251)
+      std::vector<std::pair<JSContextHandleBlock*, std::ptrdiff_t>> counts__;
+#ifndef HAL_THREAD_LOCAL_ENABLE
+      std::lock_guard<std::mutex> lock__;
+      std::thread::id             thread_id__;
+#endif
+#pragma warning(pop)
+    };
+
+    /*!
+     @method
+
+     @abstract Stop counting the handles held by owner_ptr as
+     captured. An owner must call this before it destroys its handles.
+     */
+    static void Abandon(Owner* owner_ptr) HAL_NOEXCEPT;
+
+    // Count a new handle to js_global_context_ref.
+    static JSContextHandleBlock* Acquire(JSGlobalContextRef js_global_context_ref) HAL_NOEXCEPT;
+
+    // Count a copy of a handle.
+    static void Retain(JSContextHandleBlock* block_ptr) HAL_NOEXCEPT;
+
+    // Stop counting a handle. Drops the captured handles if they are
+    // the only ones left.
+    static void Release(JSContextHandleBlock* block_ptr) HAL_NOEXCEPT;
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSCONTEXTHANDLES_HPP_
@@ -0,0 +1,93 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSCONTEXTSLOTS_HPP_
+#define _HAL_DETAIL_JSCONTEXTSLOTS_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion JSContextSlots keeps a small table of slots per global
+   context (and per context group), indexed by small integers that are
+   allocated once per process. This is the storage behind
+   HAL::JSContextSlot and HAL::JSContextGroupSlot.
+
+   Each table is the private data of a holder object that hangs off
+   the global object, so it is found through the context itself and
+   is destroyed when the holder is finalized, i.e. when the context is
+   garbage collected. Any access to the holder from JavaScript throws,
+   so scripts can neither read nor replace what the slots hold.
+
+   Value slots hold JavaScript values as the indexed properties of the
+   holder, so the garbage collector traces them like any other
+   property. They are not protected, so caching a value that refers
+   back to the global object (e.g. a builtin function) does not keep
+   the context alive.
+
+   Native slots hold C++ objects. A context's native slots are
+   destroyed when its holder is finalized. A group's native slots are
+   destroyed when the last context of the group that has a table is
+   finalized. Both happen during garbage collection, so their
+   destructors must not call JavaScriptCore.
+   */
+  class HAL_EXPORT JSContextSlots final HAL_PERFORMANCE_COUNTER1(JSContextSlots) {
+
+  public:
+
+    /*!
+     @method
+
+     @abstract Allocate a value slot index that is valid in every
+     context.
+     */
+    static std::size_t AllocateIndex() HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Return the value in slot index of the global context
+     of context_ref, or nullptr if the slot is empty.
+     */
+    static JSValueRef GetValue(JSContextRef context_ref, std::size_t index) HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Store value in slot index of the global context of
+     context_ref. Storing nullptr empties the slot.
+     */
+    static void SetValue(JSContextRef context_ref, std::size_t index, JSValueRef value) HAL_NOEXCEPT;
+
+    static std::size_t AllocateNativeIndex() HAL_NOEXCEPT;
+    static void*       GetNative(JSContextRef context_ref, std::size_t index) HAL_NOEXCEPT;
+    static void        SetNative(JSContextRef context_ref, std::size_t index, std::shared_ptr<void> value) HAL_NOEXCEPT;
+
+    static std::size_t AllocateGroupIndex() HAL_NOEXCEPT;
+    static void*       GetGroupNative(JSContextRef context_ref, std::size_t index) HAL_NOEXCEPT;
+    static void        SetGroupNative(JSContextRef context_ref, std::size_t index, std::shared_ptr<void> value) HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Return the number of global contexts that have a slot
+     table.
+     */
+    static std::size_t GetCount() HAL_NOEXCEPT;
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSCONTEXTSLOTS_HPP_
@@ -12,6 +12,8 @@
 #include "HAL/JSValue.hpp"
 
 #include <vector>
+#include <cstddef>
+#include <functional>
 
 namespace HAL {
   class JSString;
@@ -71,7 +73,59 @@ namespace HAL { namespace detail {
    */
   template<typename T>
   using SetNamedValuePropertyCallback = std::function<bool(T&, const JSValue&)>;
-  
+
+  /*!
+   @typedef GetNamedNativeValuePropertyCallback
+
+   @abstract The callback to invoke when getting a property's value
+   from your JavaScript object through a typed binding.
+
+   @discussion You do not normally write one of these by hand. They
+   are generated by JSExport<T>::AddValueProperty when it is given a
+   getter with a typed signature such as
+
+   std::int32_t get_number() const;
+
+   and create the JSValueRef directly (e.g. with JSValueMakeNumber),
+   without constructing a JSObject for 'this' or a JSValue for the
+   result.
+
+   @param 1 A non-const reference to the C++ object that implements
+   your JavaScript object.
+
+   @param 2 The JavaScriptCore C API execution context.
+
+   @result Return the named property's value.
+   */
+  template<typename T>
+  using GetNamedNativeValuePropertyCallback = std::function<JSValueRef(T&, JSContextRef)>;
+
+  /*!
+   @typedef SetNamedNativeValuePropertyCallback
+
+   @abstract The callback to invoke when setting a property's value on
+   your JavaScript object through a typed binding.
+
+   @discussion You do not normally write one of these by hand. They
+   are generated by JSExport<T>::AddValueProperty when it is given a
+   setter with a typed signature such as
+
+   void set_number(std::int32_t number);
+
+   and convert the value directly from the JSValueRef.
+
+   @param 1 A non-const reference to the C++ object that implements
+   your JavaScript object.
+
+   @param 2 The JavaScriptCore C API execution context.
+
+   @param 3 The property's new value.
+
+   @result Return true to indicate that the property was set.
+   */
+  template<typename T>
+  using SetNamedNativeValuePropertyCallback = std::function<bool(T&, JSContextRef, JSValueRef)>;
+
   /*!
    @typedef CallNamedFunctionCallback
    
@@ -105,7 +159,36 @@ namespace HAL { namespace detail {
    */
   template<typename T>
   using CallNamedFunctionCallback = std::function<JSValue(T&, const std::vector<JSValue>&, JSObject&)>;
-  
+
+  /*!
+   @typedef CallNamedNativeFunctionCallback
+
+   @abstract The callback to invoke when your JavaScript object is
+   called as a function through a typed binding.
+
+   @discussion You do not normally write one of these by hand. They
+   are generated by JSExport<T>::AddFunctionProperty when it is given
+   a member function with a typed signature such as
+
+   double Scale(std::int32_t factor, const std::string& unit);
+
+   and convert each argument directly from the JavaScriptCore C API
+   arguments array, without building a std::vector<JSValue>.
+
+   @param 1 A non-const reference to the C++ object that implements
+   your JavaScript object.
+
+   @param 2 The JavaScriptCore C API execution context.
+
+   @param 3 The number of arguments in parameter 4.
+
+   @param 4 The JavaScriptCore C API arguments array.
+
+   @result Return the function's value.
+   */
+  template<typename T>
+  using CallNamedNativeFunctionCallback = std::function<JSValueRef(T&, JSContextRef, std::size_t, const JSValueRef[])>;
+
   /*!
    @typedef HasPropertyCallback
    
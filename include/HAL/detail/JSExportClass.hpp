@@ -12,6 +12,11 @@
 #include "HAL/detail/JSBase.hpp"
 #include "HAL/JSClass.hpp"
 #include "HAL/detail/JSExportClassDefinition.hpp"
+#include "HAL/detail/JSExportObjectPool.hpp"
+#include "HAL/detail/JSExportFinalizerQueue.hpp"
+#include "HAL/detail/JSExportTypeTag.hpp"
+#include "HAL/detail/JSExportIdentityMap.hpp"
+#include "HAL/detail/JSExportError.hpp"
 
 #include "HAL/JSString.hpp"
 #include "HAL/JSValue.hpp"
@@ -33,6 +38,9 @@
 #include <typeindex>
 #include <unordered_map>
 #include <list>
+#include <new>
+#include <atomic>
+#include <type_traits>
 
 namespace HAL {
   template<typename T>
@@ -48,6 +56,16 @@ namespace HAL { namespace detail {
   template<typename T>
   class JSExportClassDefinition;
   
+  /*!
+   @class
+   
+   @discussion The cache hit and miss counts of a memoized property.
+   */
+  struct JSExportPropertyStatistics final {
+    std::uint64_t hit_count  { 0 };
+    std::uint64_t miss_count { 0 };
+  };
+  
   /*!
    @class
    
@@ -89,6 +107,17 @@ namespace HAL { namespace detail {
     // Making this public only for testing porpose.
     static std::vector<std::string> GetCachedKeys();
 
+    // Return the native object of object_ref if it was created by
+    // this JSExportClass or by one whose SetParent chain includes it,
+    // otherwise nullptr.
+    static T* Downcast(JSContextRef context_ref, JSObjectRef object_ref) HAL_NOEXCEPT;
+
+    // Return the JavaScript object that owns native_object.
+    static JSObject Wrap(T& native_object);
+
+    // Return the cache hit and miss counts of each memoized property.
+    static std::unordered_map<std::string, JSExportPropertyStatistics> GetPropertyStatistics();
+
   private:
     
     void Print() const;
@@ -109,6 +138,11 @@ namespace HAL { namespace detail {
     static JSValueRef  GetNamedValuePropertyCallback(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef property_name_ref, JSValueRef* exception);
     static bool        SetNamedValuePropertyCallback(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef property_name_ref, JSValueRef value_ref, JSValueRef* exception);
     
+    // Support for JSStaticValue of memoized properties, which wrap
+    // the callbacks above.
+    static JSValueRef  GetMemoizedValuePropertyCallback(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef property_name_ref, JSValueRef* exception);
+    static bool        SetMemoizedValuePropertyCallback(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef property_name_ref, JSValueRef value_ref, JSValueRef* exception);
+    
     // Support for JSStaticFunction
     static JSValueRef  CallNamedFunctionCallback(JSContextRef context_ref, JSObjectRef function_ref, JSObjectRef this_object_ref, size_t argument_count, const JSValueRef arguments_array[], JSValueRef* exception);
     
@@ -126,16 +160,36 @@ namespace HAL { namespace detail {
     static JSValueRef  JSObjectConvertToTypeCallback(JSContextRef context_ref, JSObjectRef object_ref, JSType type, JSValueRef* exception);
     
     // Helper functions.
+    static T*   CreateNativeObject(const JSContext& js_context);
+    static T*   CreateNativeObject(const JSContext& js_context, std::true_type);
+    static T*   CreateNativeObject(const JSContext& js_context, std::false_type);
+    static void DestroyNativeObject(T* native_object_ptr) HAL_NOEXCEPT;
+    static void DestroyNativeObject(T* native_object_ptr, std::true_type) HAL_NOEXCEPT;
+    static void DestroyNativeObject(T* native_object_ptr, std::false_type) HAL_NOEXCEPT;
+    static void DestroyNativeObjectCallback(void* native_object_ptr);
+    static void FinalizeNativeObject(T* native_object_ptr);
+    static void SetConstructor(JSContextRef context_ref, JSObjectRef object_ref, JSObjectRef constructor_ref);
     static JSValue CreateJSError(const std::string& function_name, const std::string& location, JSObject js_object, const js_runtime_error& e);
     static JSValue CreateJSError(const std::string& function_name, JSObject js_object, const std::exception& e);
     static JSValue CreateJSError(const std::string& function_name, JSObject js_object, const std::string& what);
     static std::string GetJSExportComponentName(const std::string& function_name, const std::string& location = "");
     
     static JSExportClassDefinition<T> js_export_class_definition__;
+    static const JSExportTypeTag*   js_export_type_tag__;
+    static JSClassRef               js_export_class_ref__;
     static std::unordered_map<std::string, JSValue> constants_cache__;
     static std::list<std::string>                   constants_cache_history__;
     static std::uint32_t                            constants_cache_capacity__;
     
+    struct MemoizedPropertyCounters {
+      std::atomic<std::uint64_t> hit_count  { 0 };
+      std::atomic<std::uint64_t> miss_count { 0 };
+    };
+    
+    // Created once per memoized property when the class is created,
+    // so the map itself never changes while properties are read.
+    static std::unordered_map<std::string, MemoizedPropertyCounters> memoized_property_counters__;
+    
 #undef HAL_DETAIL_JSEXPORTCLASS_LOCK_GUARD_STATIC
 #ifdef HAL_THREAD_SAFE
     static std::recursive_mutex mutex_static__;
@@ -153,6 +207,12 @@ namespace HAL { namespace detail {
   template<typename T>
   JSExportClassDefinition<T> JSExportClass<T>::js_export_class_definition__;
 
+  template<typename T>
+  const JSExportTypeTag* JSExportClass<T>::js_export_type_tag__ { nullptr };
+
+  template<typename T>
+  JSClassRef JSExportClass<T>::js_export_class_ref__ { nullptr };
+
   template<typename T>
   std::unordered_map<std::string, JSValue> JSExportClass<T>::constants_cache__;
 
@@ -166,6 +226,9 @@ namespace HAL { namespace detail {
   template<typename T>
   std::uint32_t JSExportClass<T>::constants_cache_capacity__ = 16;
 
+  template<typename T>
+  std::unordered_map<std::string, typename JSExportClass<T>::MemoizedPropertyCounters> JSExportClass<T>::memoized_property_counters__;
+
   template<typename T>
   JSExportClass<T>::JSExportClass() HAL_NOEXCEPT {
     HAL_LOG_TRACE("JSExportClass<", typeid(T).name(), ">:: ctor 1 ", this);
@@ -177,6 +240,11 @@ namespace HAL { namespace detail {
     HAL_DETAIL_JSEXPORTCLASS_LOCK_GUARD_STATIC;
     HAL_LOG_TRACE("JSExportClass<", typeid(T).name(), ">:: ctor 2 ", this);
     js_export_class_definition__ = js_export_class_definition;
+    js_export_class_ref__        = js_class_ref__;
+    js_export_type_tag__         = JSExportTypeTag::Register(js_class_ref__, js_export_class_definition.get_js_class_definition().parentClass);
+    for (const auto& property_name : js_export_class_definition__.get_export_state().named_memoized__) {
+      memoized_property_counters__[property_name];
+    }
     //js_export_class_definition__.Print();
   }
   
@@ -188,13 +256,13 @@ namespace HAL { namespace detail {
   template<typename T>
   void JSExportClass<T>::Print() const {
     HAL_JSCLASS_LOCK_GUARD;
-    for (const auto& entry : js_export_class_definition__.named_value_property_callback_map__) {
+    for (const auto& entry : js_export_class_definition__.get_export_state().named_value_property_callback_map__) {
       const auto& name       = entry.first;
       const auto& attributes = entry.second.get_attributes();
       HAL_LOG_DEBUG("JSExportClass: has value property callback ", name, " with attributes ", to_string(attributes));
     }
     
-    for (const auto& entry : js_export_class_definition__.named_function_property_callback_map__) {
+    for (const auto& entry : js_export_class_definition__.get_export_state().named_function_property_callback_map__) {
       const auto& name       = entry.first;
       const auto& attributes = entry.second.get_attributes();
       HAL_LOG_DEBUG("JSExportClass: has function property callback ", name, " with attributes ", to_string(attributes));
@@ -210,15 +278,20 @@ namespace HAL { namespace detail {
     JSObject js_object(JSContext(context_ref), object_ref);
     HAL_LOG_DEBUG("JSExportClass<", typeid(T).name(), ">::Initialize: JSContextRef = ", context_ref, ", JSObjectRef = ", object_ref);
 
-    const auto previous_native_object_ptr = static_cast<JSExport<T>*>(js_object.GetPrivate());
-    const auto native_object_ptr          = new T(js_object.get_context());
+    const auto previous_native_object_ptr = static_cast<T*>(js_object.GetPrivate());
+    const auto native_object_ptr          = CreateNativeObject(js_object.get_context());
     
     if (previous_native_object_ptr != nullptr) {
       HAL_LOG_DEBUG("JSExportClass<", typeid(T).name(), ">::Initialize: replace ", previous_native_object_ptr, " with ", native_object_ptr, " for ", object_ref);
-      delete previous_native_object_ptr;
+      JSExportIdentityMap::UnRegister(context_ref, previous_native_object_ptr);
+      DestroyNativeObject(previous_native_object_ptr);
     }
     
+    native_object_ptr -> js_export_signature__ = GetJSExportSignature(native_object_ptr);
+    native_object_ptr -> js_export_type_tag__  = js_export_type_tag__;
+    
     const bool result = js_object.SetPrivate(native_object_ptr);
+    JSExportIdentityMap::Register(context_ref, native_object_ptr, object_ref);
     HAL_LOG_DEBUG("JSExportClass<", typeid(T).name(), ">::Initialize: private data set to ", js_object.GetPrivate(), " for ", object_ref);
     
     native_object_ptr->postInitialize(js_object);
@@ -230,16 +303,131 @@ namespace HAL { namespace detail {
   void JSExportClass<T>::JSObjectFinalizeCallback(JSObjectRef object_ref) {
     HAL_DETAIL_JSEXPORTCLASS_LOCK_GUARD_STATIC;
     
-    auto native_object_ptr = static_cast<JSExport<T>*>(JSObjectGetPrivate(object_ref));
+    auto native_object_ptr = static_cast<T*>(JSObjectGetPrivate(object_ref));
     
     HAL_LOG_DEBUG("JSExportClass<", typeid(T).name(), ">::Finalize: delete native object ", native_object_ptr, " for ", object_ref);
     if (native_object_ptr) {
-      //delete reinterpret_cast<T*>(native_object_ptr);
-      delete native_object_ptr;
       JSObjectSetPrivate(object_ref, nullptr);
+      JSExportIdentityMap::UnRegister(static_cast<JSContextRef>(native_object_ptr -> js_context__), native_object_ptr);
+      FinalizeNativeObject(native_object_ptr);
+    }
+  }
+  
+  // Destroy the native object now, or hand it to the
+  // JSExportFinalizerQueue as requested by JSExportTraits<T>.
+  template<typename T>
+  void JSExportClass<T>::FinalizeNativeObject(T* native_object_ptr) {
+#ifndef HAL_THREAD_SAFE
+    // ~JSExportObject releases its JSContext and updates the JSObject
+    // private data map, which only HAL_THREAD_SAFE locks.
+    static_assert(!JSExportTraits<T>::thread_safe_finalization,
+                  "JSExportTraits<T>: thread_safe_finalization requires HAL_THREAD_SAFE");
+#endif
+    if (!JSExportTraits<T>::defer_finalization) {
+      DestroyNativeObject(native_object_ptr);
+      return;
+    }
+    
+    auto& node = native_object_ptr -> finalizer_node__;
+    node.native_object_ptr = native_object_ptr;
+    node.finalizer         = &JSExportClass<T>::DestroyNativeObjectCallback;
+    if (JSExportTraits<T>::thread_safe_finalization) {
+      JSExportFinalizerQueue::EnqueueBackground(&node);
+    } else {
+      JSExportFinalizerQueue::Enqueue(&node);
+    }
+  }
+  
+  template<typename T>
+  void JSExportClass<T>::DestroyNativeObjectCallback(void* native_object_ptr) {
+    DestroyNativeObject(static_cast<T*>(native_object_ptr));
+  }
+  
+  // Native objects come from the global allocator unless
+  // JSExportTraits<T>::use_object_pool is set.
+  template<typename T>
+  T* JSExportClass<T>::CreateNativeObject(const JSContext& js_context) {
+    return CreateNativeObject(js_context, std::integral_constant<bool, JSExportTraits<T>::use_object_pool>());
+  }
+  
+  template<typename T>
+  T* JSExportClass<T>::CreateNativeObject(const JSContext& js_context, std::true_type) {
+    void* storage = JSExportObjectPool<T>::Allocate();
+    try {
+      return new (storage) T(js_context);
+    } catch (...) {
+      JSExportObjectPool<T>::Deallocate(storage);
+      throw;
     }
   }
   
+  template<typename T>
+  T* JSExportClass<T>::CreateNativeObject(const JSContext& js_context, std::false_type) {
+    return new T(js_context);
+  }
+  
+  template<typename T>
+  void JSExportClass<T>::DestroyNativeObject(T* native_object_ptr) HAL_NOEXCEPT {
+    DestroyNativeObject(native_object_ptr, std::integral_constant<bool, JSExportTraits<T>::use_object_pool>());
+  }
+  
+  template<typename T>
+  void JSExportClass<T>::DestroyNativeObject(T* native_object_ptr, std::true_type) HAL_NOEXCEPT {
+    native_object_ptr -> ~T();
+    JSExportObjectPool<T>::Deallocate(native_object_ptr);
+  }
+  
+  template<typename T>
+  void JSExportClass<T>::DestroyNativeObject(T* native_object_ptr, std::false_type) HAL_NOEXCEPT {
+    delete native_object_ptr;
+  }
+  
+  template<typename T>
+  T* JSExportClass<T>::Downcast(JSContextRef, JSObjectRef object_ref) HAL_NOEXCEPT {
+    // The tag in the private data decides on its own, so there is no
+    // walk of the JavaScriptCore class chain. GetJSExportTypeTag
+    // rejects the private data of objects no JSExportClass created.
+    if (js_export_type_tag__ == nullptr) {
+      return nullptr;
+    }
+    
+    const auto native_object_ptr = static_cast<JSExportObject*>(JSObjectGetPrivate(object_ref));
+    if (native_object_ptr == nullptr) {
+      return nullptr;
+    }
+    
+    const auto type_tag_ptr = GetJSExportTypeTag(native_object_ptr);
+    if (type_tag_ptr == nullptr || !type_tag_ptr -> IsKindOf(*js_export_type_tag__)) {
+      return nullptr;
+    }
+    
+    // Private data always points to the native object itself, see
+    // JSObjectInitializeCallback.
+    return static_cast<T*>(static_cast<void*>(native_object_ptr));
+  }
+
+  template<typename T>
+  JSObject JSExportClass<T>::Wrap(T& native_object) {
+    const auto& js_context = native_object.js_context__;
+    const auto  object_ref = JSExportIdentityMap::Find(static_cast<JSContextRef>(js_context), &native_object);
+    if (object_ref == nullptr) {
+      ThrowRuntimeError(GetJSExportComponentName("Wrap"), "native object has no live JavaScript object");
+    }
+    return JSObject(js_context, object_ref);
+  }
+
+  template<typename T>
+  std::unordered_map<std::string, JSExportPropertyStatistics> JSExportClass<T>::GetPropertyStatistics() {
+    std::unordered_map<std::string, JSExportPropertyStatistics> statistics;
+    for (const auto& entry : memoized_property_counters__) {
+      JSExportPropertyStatistics property_statistics;
+      property_statistics.hit_count  = entry.second.hit_count;
+      property_statistics.miss_count = entry.second.miss_count;
+      statistics.emplace(entry.first, property_statistics);
+    }
+    return statistics;
+  }
+
   template<typename T>
   void JSExportClass<T>::EvictCache() {
     assert(!constants_cache_history__.empty());
@@ -273,23 +461,29 @@ namespace HAL { namespace detail {
   template<typename T>
   JSValueRef JSExportClass<T>::GetNamedValuePropertyCallback(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef property_name_ref, JSValueRef* exception) try {
     
-    JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
-    
     const std::string property_name = JSString(property_name_ref);
     
-    const auto callback_position = js_export_class_definition__.named_value_property_callback_map__.find(property_name);
-    const bool callback_found    = callback_position != js_export_class_definition__.named_value_property_callback_map__.end();
-    
-    HAL_LOG_DEBUG("JSExportClass<", typeid(T).name(), ">::GetNamedProperty: callback found = ", callback_found, " for ", to_string(js_object), ".", property_name);
+    const auto callback_position = js_export_class_definition__.get_export_state().named_value_property_callback_map__.find(property_name);
+    const bool callback_found    = callback_position != js_export_class_definition__.get_export_state().named_value_property_callback_map__.end();
     
     // precondition
     assert(callback_found);
     
     try {
+      // Typed bindings produce the JSValueRef themselves, so there is
+      // no need to wrap object_ref in a JSObject.
+      const auto& native_get_callback = (callback_position -> second).native_get_callback();
+      if (native_get_callback) {
+        return native_get_callback(*static_cast<T*>(JSObjectGetPrivate(object_ref)), context_ref);
+      }
+      
+      JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
+      
+      HAL_LOG_DEBUG("JSExportClass<", typeid(T).name(), ">::GetNamedProperty: callback found = ", callback_found, " for ", to_string(js_object), ".", property_name);
 
       // check if it's a constant
-      const auto constant_position = js_export_class_definition__.named_constants__.find(property_name);
-      const bool constant_found    = constant_position != js_export_class_definition__.named_constants__.end();
+      const auto constant_position = js_export_class_definition__.get_export_state().named_constants__.find(property_name);
+      const bool constant_found    = constant_position != js_export_class_definition__.get_export_state().named_constants__.end();
       if (constant_found) {
 
         HAL_LOG_DEBUG("JSExportClass<", typeid(T).name(), ">::GetNamedProperty: constant found = ", constant_found, " for ", to_string(js_object), ".", property_name);
@@ -362,20 +556,26 @@ namespace HAL { namespace detail {
   template<typename T>
   bool JSExportClass<T>::SetNamedValuePropertyCallback(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef property_name_ref, JSValueRef value_ref, JSValueRef* exception) try {
     
-    JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
-    JSValue  js_value(js_object.get_context(), value_ref);
-    
     const std::string property_name = JSString(property_name_ref);
     
-    const auto callback_position = js_export_class_definition__.named_value_property_callback_map__.find(property_name);
-    const bool callback_found    = callback_position != js_export_class_definition__.named_value_property_callback_map__.end();
-    
-    HAL_LOG_DEBUG("JSExportClass<", typeid(T).name(), ">::SetNamedProperty: callback found = ", callback_found, " for ", to_string(js_object), ".", property_name);
+    const auto callback_position = js_export_class_definition__.get_export_state().named_value_property_callback_map__.find(property_name);
+    const bool callback_found    = callback_position != js_export_class_definition__.get_export_state().named_value_property_callback_map__.end();
     
     // precondition
     assert(callback_found);
     
     try {
+      // Typed bindings read value_ref directly.
+      const auto& native_set_callback = (callback_position -> second).native_set_callback();
+      if (native_set_callback) {
+        return native_set_callback(*static_cast<T*>(JSObjectGetPrivate(object_ref)), context_ref, value_ref);
+      }
+      
+      JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
+      JSValue  js_value(js_object.get_context(), value_ref);
+      
+      HAL_LOG_DEBUG("JSExportClass<", typeid(T).name(), ">::SetNamedProperty: callback found = ", callback_found, " for ", to_string(js_object), ".", property_name);
+      
       auto native_object_ptr = static_cast<T*>(js_object.GetPrivate());
       const auto callback    = (callback_position -> second).set_callback();
       const auto result      = callback(*native_object_ptr, js_value);
@@ -400,6 +600,66 @@ namespace HAL { namespace detail {
     return false;
   }
   
+  template<typename T>
+  JSValueRef JSExportClass<T>::GetMemoizedValuePropertyCallback(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef property_name_ref, JSValueRef* exception) try {
+    
+    const std::string property_name = JSString(property_name_ref);
+    
+    const auto counters_position = memoized_property_counters__.find(property_name);
+    const bool counters_found    = counters_position != memoized_property_counters__.end();
+    
+    // precondition
+    assert(counters_found);
+    
+    // Memoized properties are cached in the native object.
+    auto native_object_ptr = static_cast<T*>(JSObjectGetPrivate(object_ref));
+    const auto memoized_value_ref = native_object_ptr -> GetMemoizedProperty(property_name);
+    if (memoized_value_ref) {
+      ++(counters_position -> second).hit_count;
+      return memoized_value_ref;
+    }
+    ++(counters_position -> second).miss_count;
+    
+    const auto value_ref = GetNamedValuePropertyCallback(context_ref, object_ref, property_name_ref, exception);
+    if (value_ref) {
+      JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
+      native_object_ptr -> SetMemoizedProperty(property_name, JSValue(js_object.get_context(), value_ref));
+    }
+    
+    return value_ref;
+    
+  } catch (const std::exception& e) {
+    JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
+    *exception = static_cast<JSValueRef>(CreateJSError("GetNamedProperty", js_object, e));
+    return nullptr;
+  } catch (...) {
+    JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
+    *exception = static_cast<JSValueRef>(CreateJSError("GetNamedProperty", js_object, "unknown exception"));
+    return nullptr;
+  }
+  
+  template<typename T>
+  bool JSExportClass<T>::SetMemoizedValuePropertyCallback(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef property_name_ref, JSValueRef value_ref, JSValueRef* exception) try {
+    
+    const bool result = SetNamedValuePropertyCallback(context_ref, object_ref, property_name_ref, value_ref, exception);
+    
+    // A successful set invalidates the cached value.
+    if (result) {
+      static_cast<T*>(JSObjectGetPrivate(object_ref)) -> InvalidateProperty(JSString(property_name_ref));
+    }
+    
+    return result;
+    
+  } catch (const std::exception& e) {
+    JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
+    *exception = static_cast<JSValueRef>(CreateJSError("SetNamedProperty", js_object, e));
+    return false;
+  } catch (...) {
+    JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
+    *exception = static_cast<JSValueRef>(CreateJSError("SetNamedProperty", js_object, "unknown exception"));
+    return false;
+  }
+  
   template<typename T>
   JSValueRef JSExportClass<T>::CallNamedFunctionCallback(JSContextRef context_ref, JSObjectRef function_ref, JSObjectRef this_object_ref, size_t argument_count, const JSValueRef arguments_array[], JSValueRef* exception) try {
     
@@ -417,8 +677,8 @@ namespace HAL { namespace detail {
     // precondition
     assert(js_object.IsFunction());
     
-    const auto callback_position = js_export_class_definition__.named_function_property_callback_map__.find(function_name);
-    const bool callback_found    = callback_position != js_export_class_definition__.named_function_property_callback_map__.end();
+    const auto callback_position = js_export_class_definition__.get_export_state().named_function_property_callback_map__.find(function_name);
+    const bool callback_found    = callback_position != js_export_class_definition__.get_export_state().named_function_property_callback_map__.end();
     const auto native_this_ptr   = static_cast<T*>(this_object.GetPrivate());
 
     HAL_LOG_DEBUG("JSExportClass<", typeid(T).name(), ">::CallNamedFunction: callback found = ", callback_found, " for this[", native_this_ptr, "].", function_name, "(...)");
@@ -427,6 +687,19 @@ namespace HAL { namespace detail {
     assert(callback_found);
 
     try {
+      // Typed bindings convert their arguments directly from
+      // arguments_array and produce the JSValueRef themselves.
+      const auto& native_callback = (callback_position -> second).native_function_callback();
+      if (native_callback) {
+        const auto result = native_callback(*native_this_ptr, context_ref, argument_count, arguments_array);
+        
+        if (!JSError::NativeStack__.empty()) {
+          JSError::NativeStack__.pop_back();
+        }
+        
+        return result;
+      }
+      
       const auto callback = (callback_position -> second).function_callback();
       const auto result   = callback(*native_this_ptr, to_vector(this_object.get_context(), argument_count, arguments_array), this_object);
       
@@ -481,14 +754,7 @@ namespace HAL { namespace detail {
 
     HAL_LOG_ERROR(name, ": ", e.what());
 
-    auto js_error = js_context.CreateError();
-    js_error.SetProperty("message",    js_context.CreateString(e.js_message()));
-    js_error.SetProperty("name",       js_context.CreateString(e.js_name()));
-    js_error.SetProperty("fileName",   js_context.CreateString(e.js_filename()));
-    js_error.SetProperty("stack",       js_context.CreateString(e.js_stack()));
-    js_error.SetProperty("nativeStack", js_context.CreateString(e.js_nativeStack()));
-    js_error.SetProperty("lineNumber", js_context.CreateNumber(e.js_linenumber()));
-    return js_error;
+    return JSValue(js_context, JSExportError::Create(static_cast<JSContextRef>(js_context), e));
   }
 
   template<typename T>
@@ -503,11 +769,7 @@ namespace HAL { namespace detail {
 
     HAL_LOG_ERROR(name, ": ", what);
 
-    auto js_error = js_context.CreateError();
-    js_error.SetProperty("message",    js_context.CreateString(what));
-    js_error.SetProperty("name", js_context.CreateString(name));
-    js_error.SetProperty("nativeStack", js_context.CreateString(JSError::GetNativeStack()));
-    return js_error;
+    return JSValue(js_context, JSExportError::Create(static_cast<JSContextRef>(js_context), name, what));
   }
   
   template<typename T>
@@ -516,7 +778,7 @@ namespace HAL { namespace detail {
     JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
     JSString property_name(property_name_ref);
     
-    auto       callback       = js_export_class_definition__.has_property_callback__;
+    auto       callback       = js_export_class_definition__.get_export_state().has_property_callback__;
     const bool callback_found = callback != nullptr;
 
     const auto native_object_ptr = static_cast<const T*>(js_object.GetPrivate());
@@ -545,7 +807,7 @@ namespace HAL { namespace detail {
     JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
     JSString property_name(property_name_ref);
     
-    auto       callback       = js_export_class_definition__.get_property_callback__;
+    auto       callback       = js_export_class_definition__.get_export_state().get_property_callback__;
     const bool callback_found = callback != nullptr;
     
     auto native_object_ptr = static_cast<T*>(js_object.GetPrivate());
@@ -593,7 +855,7 @@ namespace HAL { namespace detail {
     JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
     JSString property_name(property_name_ref);
     
-    auto       callback       = js_export_class_definition__.set_property_callback__;
+    auto       callback       = js_export_class_definition__.get_export_state().set_property_callback__;
     const bool callback_found = callback != nullptr;
     
     auto native_object_ptr = static_cast<T*>(js_object.GetPrivate());
@@ -628,7 +890,7 @@ namespace HAL { namespace detail {
     JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
     JSString property_name(property_name_ref);
     
-    auto       callback       = js_export_class_definition__.delete_property_callback__;
+    auto       callback       = js_export_class_definition__.get_export_state().delete_property_callback__;
     const bool callback_found = callback != nullptr;
     
     auto native_object_ptr = static_cast<T*>(js_object.GetPrivate());
@@ -663,7 +925,7 @@ namespace HAL { namespace detail {
     JSObject                  js_object(JSObject::FindJSObject(context_ref, object_ref));
     JSPropertyNameAccumulator js_property_name_accumulator(property_names);
     
-    auto       callback       = js_export_class_definition__.get_property_names_callback__;
+    auto       callback       = js_export_class_definition__.get_export_state().get_property_names_callback__;
     const bool callback_found = callback != nullptr;
     
     auto native_object_ptr = static_cast<T*>(js_object.GetPrivate());
@@ -689,7 +951,7 @@ namespace HAL { namespace detail {
     // precondition
     assert(js_object.IsFunction());
     
-    auto       callback       = js_export_class_definition__.call_as_function_callback__;
+    auto       callback       = js_export_class_definition__.get_export_state().call_as_function_callback__;
     const bool callback_found = callback != nullptr;
     
     auto native_object_ptr = static_cast<T*>(js_object.GetPrivate());
@@ -721,18 +983,19 @@ namespace HAL { namespace detail {
   template<typename T>
   JSObjectRef JSExportClass<T>::JSObjectCallAsConstructorCallback(JSContextRef context_ref, JSObjectRef constructor_ref, size_t argument_count, const JSValueRef arguments_array[], JSValueRef* exception) try {
     
-    JSObject  js_object(JSObject::FindJSObject(context_ref, constructor_ref));
-    JSContext js_context = js_object.get_context();
-
-    auto new_object = js_context.CreateObject(JSExport<T>::Class());
-    const auto native_object_ptr = static_cast<T*>(new_object.GetPrivate());
+    // Create the instance straight from the cached JSClassRef, which
+    // runs JSObjectInitializeCallback, without going through
+    // JSContext::CreateObject and JSExport<T>::Class().
+    const auto new_object_ref    = JSObjectMake(context_ref, js_export_class_ref__, nullptr);
+    const auto native_object_ptr = static_cast<T*>(JSObjectGetPrivate(new_object_ref));
     HAL_LOG_DEBUG("JSExportClass<", typeid(T).name(), ">::CallAsConstructor: for this[", native_object_ptr, "]");
-
-    new_object.SetProperty("constructor", js_object);
-
+    
+    SetConstructor(context_ref, new_object_ref, constructor_ref);
+    
+    JSContext js_context(context_ref);
     native_object_ptr->postCallAsConstructor(js_context, to_vector(js_context, argument_count, arguments_array));
-
-    return static_cast<JSObjectRef>(new_object);
+    
+    return new_object_ref;
     
   } catch (const js_runtime_error& e) {
     JSObject js_object(JSObject::FindJSObject(context_ref, constructor_ref));
@@ -748,26 +1011,52 @@ namespace HAL { namespace detail {
     return nullptr;
   }
   
+  // Make object_ref.constructor return constructor_ref. When the
+  // class has an automatic prototype, which JavaScriptCore shares
+  // between all instances in a context, the property is defined once
+  // on that prototype. Writing it to every instance instead would
+  // turn each one into a dictionary-shaped object.
   template<typename T>
-  bool JSExportClass<T>::JSObjectHasInstanceCallback(JSContextRef context_ref, JSObjectRef constructor_ref, JSValueRef possible_instance_ref, JSValueRef* exception) try {
-    JSObject js_object(JSObject::FindJSObject(context_ref, constructor_ref));
-    JSValue  possible_instance(js_object.get_context(), possible_instance_ref);
-
-    bool result = false;
-    if (possible_instance.IsObject()) {
-      JSObject possible_object = static_cast<JSObject>(possible_instance);
-      if (possible_object.GetPrivate() != nullptr) {
-        auto possible_js_export_ptr     = static_cast<JSExport<T>*>(possible_object.GetPrivate());
-        auto possible_native_object_ptr = dynamic_cast<T*>(possible_js_export_ptr);
-        if (possible_native_object_ptr != nullptr) {
-          result = true;
+  void JSExportClass<T>::SetConstructor(JSContextRef context_ref, JSObjectRef object_ref, JSObjectRef constructor_ref) {
+    static const JSString constructor_name("constructor");
+    const auto constructor_name_ref = static_cast<JSStringRef>(constructor_name);
+    
+    JSValueRef exception { nullptr };
+    if (!(js_export_class_definition__.get_js_class_definition().attributes & kJSClassAttributeNoAutomaticPrototype)) {
+      const auto prototype_ref = JSValueToObject(context_ref, JSObjectGetPrototype(context_ref, object_ref), nullptr);
+      const auto current_ref   = prototype_ref ? JSObjectGetProperty(context_ref, prototype_ref, constructor_name_ref, &exception) : nullptr;
+      
+      if (current_ref && JSValueIsStrictEqual(context_ref, current_ref, constructor_ref)) {
+        return;
+      }
+      
+      // Claim the prototype unless another T constructor already has.
+      const bool claimed = current_ref && JSValueIsObject(context_ref, current_ref) && Downcast(context_ref, JSValueToObject(context_ref, current_ref, nullptr)) != nullptr;
+      if (prototype_ref && !exception && !claimed) {
+        JSObjectSetProperty(context_ref, prototype_ref, constructor_name_ref, constructor_ref, kJSPropertyAttributeDontEnum, &exception);
+        if (!exception) {
+          return;
         }
       }
     }
     
-    auto native_object_ptr = static_cast<T*>(js_object.GetPrivate());
-    static_cast<void>(native_object_ptr);
-    HAL_LOG_DEBUG("JSExportClass<", typeid(T).name(), ">::HasInstance: result = ", result, " for ", to_string(possible_instance), " instanceof this[", native_object_ptr, "]");
+    exception = nullptr;
+    JSObjectSetProperty(context_ref, object_ref, constructor_name_ref, constructor_ref, kJSPropertyAttributeNone, &exception);
+    if (exception) {
+      ThrowRuntimeError("JSExportClass", JSValue(JSContext(context_ref), exception));
+    }
+  }
+  
+  template<typename T>
+  bool JSExportClass<T>::JSObjectHasInstanceCallback(JSContextRef context_ref, JSObjectRef constructor_ref, JSValueRef possible_instance_ref, JSValueRef* exception) try {
+    // The type tags make this a bit test, so there is no need to wrap
+    // either argument.
+    bool result = false;
+    if (JSValueIsObject(context_ref, possible_instance_ref)) {
+      result = Downcast(context_ref, JSValueToObject(context_ref, possible_instance_ref, nullptr)) != nullptr;
+    }
+    
+    HAL_LOG_DEBUG("JSExportClass<", typeid(T).name(), ">::HasInstance: result = ", result, " for ", possible_instance_ref, " instanceof ", constructor_ref);
     return result;
     
   } catch (const js_runtime_error& e) {
@@ -789,7 +1078,7 @@ namespace HAL { namespace detail {
     JSObject js_object(JSObject::FindJSObject(context_ref, object_ref));
     JSValue::Type js_value_type = ToJSValueType(type);
     
-    auto       callback       = js_export_class_definition__.convert_to_type_callback__;
+    auto       callback       = js_export_class_definition__.get_export_state().convert_to_type_callback__;
     const bool callback_found = callback != nullptr;
     
     const auto native_object_ptr = static_cast<const T*>(js_object.GetPrivate());
@@ -17,8 +17,11 @@
 #include "HAL/detail/JSExportNamedFunctionPropertyCallback.hpp"
 #include "HAL/detail/JSExportCallbacks.hpp"
 
+#include <cassert>
 #include <string>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace HAL { namespace detail {
   
@@ -42,7 +45,8 @@ namespace HAL { namespace detail {
    derived from JSExport.
    
    The only way to create a JSExportClassDefinition is by using a
-   JSExportClassDefinitionBuilder.
+   JSExportClassDefinitionBuilder. Like JSClassDefinition its state
+   is built once and shared by all copies.
    
    This class is thread safe and immutable by design.
    */
@@ -51,7 +55,7 @@ namespace HAL { namespace detail {
   public:
     
     JSExportClassDefinition(const JSExportClassDefinitionBuilder<T>& builder);
-    JSExportClassDefinition()                                          = default;
+    JSExportClassDefinition()                                          HAL_NOEXCEPT;
     ~JSExportClassDefinition()                                         = default;
     JSExportClassDefinition(const JSExportClassDefinition&)            HAL_NOEXCEPT;
     JSExportClassDefinition(JSExportClassDefinition&&)                 HAL_NOEXCEPT;
@@ -61,162 +65,124 @@ namespace HAL { namespace detail {
     
   private:
     
-    void InitializeNamedPropertyCallbacks() HAL_NOEXCEPT;
-
-    // Only JSExportClass can access our private member variables.
+    // Only JSExportClass can access our state.
     template<typename U>
     friend class JSExportClass;
     
-    std::unordered_set<std::string>               named_constants__;
-    JSExportNamedValuePropertyCallbackMap_t<T>    named_value_property_callback_map__;
-    JSExportNamedFunctionPropertyCallbackMap_t<T> named_function_property_callback_map__;
-    HasPropertyCallback<T>                        has_property_callback__        { nullptr };
-    GetPropertyCallback<T>                        get_property_callback__        { nullptr };
-    SetPropertyCallback<T>                        set_property_callback__        { nullptr };
-    DeletePropertyCallback<T>                     delete_property_callback__     { nullptr };
-    GetPropertyNamesCallback<T>                   get_property_names_callback__  { nullptr };
-    CallAsFunctionCallback<T>                     call_as_function_callback__    { nullptr };
-    ConvertToTypeCallback<T>                      convert_to_type_callback__     { nullptr };
+    struct State : JSClassDefinition::State {
+      std::unordered_set<std::string>               named_constants__;
+      std::unordered_set<std::string>               named_memoized__;
+      JSExportNamedValuePropertyCallbackMap_t<T>    named_value_property_callback_map__;
+      JSExportNamedFunctionPropertyCallbackMap_t<T> named_function_property_callback_map__;
+      HasPropertyCallback<T>                        has_property_callback__        { nullptr };
+      GetPropertyCallback<T>                        get_property_callback__        { nullptr };
+      SetPropertyCallback<T>                        set_property_callback__        { nullptr };
+      DeletePropertyCallback<T>                     delete_property_callback__     { nullptr };
+      GetPropertyNamesCallback<T>                   get_property_names_callback__  { nullptr };
+      CallAsFunctionCallback<T>                     call_as_function_callback__    { nullptr };
+      ConvertToTypeCallback<T>                      convert_to_type_callback__     { nullptr };
+    };
+    
+    static std::shared_ptr<const State> CreateState(const JSExportClassDefinitionBuilder<T>& builder);
+    static std::shared_ptr<const State> GetEmptyState() HAL_NOEXCEPT;
+    static void InitializeNamedPropertyCallbacks(State& state) HAL_NOEXCEPT;
+    
+    // Every JSExportClassDefinition<T> is created with a State, but
+    // assigning a plain JSClassDefinition to one through a
+    // JSClassDefinition reference replaces it with a base State.
+    const State& get_export_state() const HAL_NOEXCEPT {
+      assert(dynamic_cast<const State*>(&get_state()) != nullptr);
+      return static_cast<const State&>(get_state());
+    }
   };
   
+  template<typename T>
+  JSExportClassDefinition<T>::JSExportClassDefinition() HAL_NOEXCEPT
+  : JSClassDefinition(GetEmptyState()) {
+  }
+  
   template<typename T>
   JSExportClassDefinition<T>::JSExportClassDefinition(const JSExportClassDefinition<T>& rhs) HAL_NOEXCEPT
-  : JSClassDefinition(rhs)
-  , named_constants__(rhs.named_constants__)
-  , named_value_property_callback_map__(rhs.named_value_property_callback_map__)
-  , named_function_property_callback_map__(rhs.named_function_property_callback_map__)
-  , has_property_callback__(rhs.has_property_callback__)
-  , get_property_callback__(rhs.get_property_callback__)
-  , set_property_callback__(rhs.set_property_callback__)
-  , delete_property_callback__(rhs.delete_property_callback__)
-  , get_property_names_callback__(rhs.get_property_names_callback__)
-  , call_as_function_callback__(rhs.call_as_function_callback__)
-  , convert_to_type_callback__(rhs.convert_to_type_callback__) {
-    InitializeNamedPropertyCallbacks();
-    
-//    std::clog << "MDL: copy ctor" << std::endl;
-//    Print();
+  : JSClassDefinition(rhs) {
   }
   
   template<typename T>
   JSExportClassDefinition<T>::JSExportClassDefinition(JSExportClassDefinition<T>&& rhs) HAL_NOEXCEPT
-  : JSClassDefinition(rhs)
-  , named_constants__(std::move(rhs.named_constants__))
-  , named_value_property_callback_map__(std::move(rhs.named_value_property_callback_map__))
-  , named_function_property_callback_map__(std::move(rhs.named_function_property_callback_map__))
-  , has_property_callback__(std::move(rhs.has_property_callback__))
-  , get_property_callback__(std::move(rhs.get_property_callback__))
-  , set_property_callback__(std::move(rhs.set_property_callback__))
-  , delete_property_callback__(std::move(rhs.delete_property_callback__))
-  , get_property_names_callback__(std::move(rhs.get_property_names_callback__))
-  , call_as_function_callback__(std::move(rhs.call_as_function_callback__))
-  , convert_to_type_callback__(std::move(rhs.convert_to_type_callback__)) {
-    InitializeNamedPropertyCallbacks();
-    
-//    std::clog << "MDL: move ctor" << std::endl;
-//    Print();
+  : JSClassDefinition(std::move(rhs)) {
   }
   
   template<typename T>
   JSExportClassDefinition<T>& JSExportClassDefinition<T>::operator=(const JSExportClassDefinition<T>& rhs) HAL_NOEXCEPT {
-    HAL_JSCLASSDEFINITION_LOCK_GUARD;
     JSClassDefinition::operator=(rhs);
-    named_constants__                      = rhs.named_constants__;
-    named_value_property_callback_map__    = rhs.named_value_property_callback_map__;
-    named_function_property_callback_map__ = rhs.named_function_property_callback_map__;
-    has_property_callback__                = rhs.has_property_callback__;
-    get_property_callback__                = rhs.get_property_callback__;
-    set_property_callback__                = rhs.set_property_callback__;
-    delete_property_callback__             = rhs.delete_property_callback__;
-    get_property_names_callback__          = rhs.get_property_names_callback__;
-    call_as_function_callback__            = rhs.call_as_function_callback__;
-    convert_to_type_callback__             = rhs.convert_to_type_callback__;
-    InitializeNamedPropertyCallbacks();
-    
-//    std::clog << "MDL: copy assignment" << std::endl;
-//    Print();
-    
     return *this;
-    }
-    
-    template<typename T>
-    JSExportClassDefinition<T>& JSExportClassDefinition<T>::operator=(JSExportClassDefinition<T>&& rhs) HAL_NOEXCEPT {
-      HAL_JSCLASSDEFINITION_LOCK_GUARD;
-      swap(rhs);
-      InitializeNamedPropertyCallbacks();
-      
-//      std::clog << "MDL: move assignment" << std::endl;
-//      Print();
-      
-      return *this;
-    }
-    
-    template<typename T>
-    void JSExportClassDefinition<T>::swap(JSExportClassDefinition<T>& other) HAL_NOEXCEPT {
-      HAL_JSCLASSDEFINITION_LOCK_GUARD;
-      JSClassDefinition::swap(other);
-      using std::swap;
-      
-      // By swapping the members of two classes, the two classes are
-      // effectively swapped.
-      swap(named_constants__                     , other.named_constants__);
-      swap(named_value_property_callback_map__   , other.named_value_property_callback_map__);
-      swap(named_function_property_callback_map__, other.named_function_property_callback_map__);
-      swap(has_property_callback__               , other.has_property_callback__);
-      swap(get_property_callback__               , other.get_property_callback__);
-      swap(set_property_callback__               , other.set_property_callback__);
-      swap(delete_property_callback__            , other.delete_property_callback__);
-      swap(get_property_names_callback__         , other.get_property_names_callback__);
-      swap(call_as_function_callback__           , other.call_as_function_callback__);
-      swap(convert_to_type_callback__            , other.convert_to_type_callback__);
-    }
+  }
+  
+  template<typename T>
+  JSExportClassDefinition<T>& JSExportClassDefinition<T>::operator=(JSExportClassDefinition<T>&& rhs) HAL_NOEXCEPT {
+    JSClassDefinition::operator=(std::move(rhs));
+    return *this;
+  }
+  
+  template<typename T>
+  void JSExportClassDefinition<T>::swap(JSExportClassDefinition<T>& other) HAL_NOEXCEPT {
+    JSClassDefinition::swap(other);
+  }
+  
+  template<typename T>
+  void swap(JSExportClassDefinition<T>& first, JSExportClassDefinition<T>& second) HAL_NOEXCEPT {
+    first.swap(second);
+  }
+  
+  template<typename T>
+  std::shared_ptr<const typename JSExportClassDefinition<T>::State> JSExportClassDefinition<T>::GetEmptyState() HAL_NOEXCEPT {
+    static const std::shared_ptr<const State> empty_state = [] {
+      auto state = std::make_shared<State>();
+      state -> js_class_definition__ = kJSClassDefinitionEmpty;
+      return state;
+    }();
+    return empty_state;
+  }
+  
+  template<typename T>
+  void JSExportClassDefinition<T>::InitializeNamedPropertyCallbacks(State& state) HAL_NOEXCEPT {
     
-    template<typename T>
-    void swap(JSExportClassDefinition<T>& first, JSExportClassDefinition<T>& second) HAL_NOEXCEPT {
-      first.swap(second);
+    // Initialize staticValues. The names point into the keys of the
+    // callback maps, which never change once the state is built.
+    state.js_class_definition__.staticValues = nullptr;
+    if (!state.named_value_property_callback_map__.empty()) {
+      for (const auto& entry : state.named_value_property_callback_map__) {
+        const auto& property_name       = entry.first;
+        const auto& property_attributes = entry.second.get_attributes();
+        // Only memoized properties pay for the cache lookup.
+        const bool  memoized            = state.named_memoized__.count(property_name) > 0;
+        ::JSStaticValue static_value;
+        static_value.name        = property_name.c_str();
+        static_value.getProperty = memoized ? JSExportClass<T>::GetMemoizedValuePropertyCallback : JSExportClass<T>::GetNamedValuePropertyCallback;
+        static_value.setProperty = memoized ? JSExportClass<T>::SetMemoizedValuePropertyCallback : JSExportClass<T>::SetNamedValuePropertyCallback;
+        static_value.attributes  = ToJSPropertyAttributes(property_attributes);
+        state.static_values__.push_back(static_value);
+      }
+      state.static_values__.push_back({nullptr, nullptr, nullptr, kJSPropertyAttributeNone});
+      state.js_class_definition__.staticValues = &state.static_values__[0];
     }
     
-    template<typename T>
-    void JSExportClassDefinition<T>::InitializeNamedPropertyCallbacks() HAL_NOEXCEPT {
-      
-      // Initialize staticValues.
-      static_values__.clear();
-      js_class_definition__.staticValues = nullptr;
-      if (!named_value_property_callback_map__.empty()) {
-        for (const auto& entry : named_value_property_callback_map__) {
-          const auto& property_name       = entry.first;
-          const auto& property_attributes = entry.second.get_attributes();
-          ::JSStaticValue static_value;
-          static_value.name        = property_name.c_str();
-          static_value.getProperty = JSExportClass<T>::GetNamedValuePropertyCallback;
-          static_value.setProperty = JSExportClass<T>::SetNamedValuePropertyCallback;
-          static_value.attributes  = ToJSPropertyAttributes(property_attributes);
-          static_values__.push_back(static_value);
-          // HAL_LOG_DEBUG("JSExportClassDefinition<", name__, "> added value property ", static_values__.back().name);
-        }
-        static_values__.push_back({nullptr, nullptr, nullptr, kJSPropertyAttributeNone});
-        js_class_definition__.staticValues = &static_values__[0];
-      }
-      
-      // Initialize staticFunctions.
-      static_functions__.clear();
-      js_class_definition__.staticFunctions = nullptr;
-      if (!named_function_property_callback_map__.empty()) {
-        for (const auto& entry : named_function_property_callback_map__) {
-          const auto& function_name = entry.first;
-          const auto& property_attributes = entry.second.get_attributes();
-          ::JSStaticFunction static_function;
-          static_function.name           = function_name.c_str();
-          static_function.callAsFunction = JSExportClass<T>::CallNamedFunctionCallback;
-          static_function.attributes     = ToJSPropertyAttributes(property_attributes);
-          static_functions__.push_back(static_function);
-          // HAL_LOG_DEBUG("JSExportClassDefinition<", name__, "> added function property ", static_functions__.back().name);
-        }
-        static_functions__.push_back({nullptr, nullptr, kJSPropertyAttributeNone});
-        js_class_definition__.staticFunctions = &static_functions__[0];
+    // Initialize staticFunctions.
+    state.js_class_definition__.staticFunctions = nullptr;
+    if (!state.named_function_property_callback_map__.empty()) {
+      for (const auto& entry : state.named_function_property_callback_map__) {
+        const auto& function_name       = entry.first;
+        const auto& property_attributes = entry.second.get_attributes();
+        ::JSStaticFunction static_function;
+        static_function.name           = function_name.c_str();
+        static_function.callAsFunction = JSExportClass<T>::CallNamedFunctionCallback;
+        static_function.attributes     = ToJSPropertyAttributes(property_attributes);
+        state.static_functions__.push_back(static_function);
       }
+      state.static_functions__.push_back({nullptr, nullptr, kJSPropertyAttributeNone});
+      state.js_class_definition__.staticFunctions = &state.static_functions__[0];
     }
-    
-    }} // namespace HAL { namespace detail {
-    
+  }
+  
+}} // namespace HAL { namespace detail {
+
 #endif // _HAL_DETAIL_JSEXPORTCLASSDEFINITION_HPP_
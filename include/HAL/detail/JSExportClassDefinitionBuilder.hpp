@@ -259,6 +259,25 @@ namespace HAL { namespace detail {
       return *this;
     }
 
+    /*!
+     @method
+
+     @abstract Add typed callbacks to invoke when getting and/or
+     setting a value property on your JavaScript object. This is the
+     same as the AddValueProperty above, except the callbacks create
+     and consume JSValueRefs directly.
+
+     @result A reference to the builder for chaining.
+     */
+    JSExportClassDefinitionBuilder<T>& AddValueProperty(const JSString& property_name, GetNamedNativeValuePropertyCallback<T> native_get_callback, SetNamedNativeValuePropertyCallback<T> native_set_callback, bool enumerable = true) {
+      std::unordered_set<JSPropertyAttribute> attributes { JSPropertyAttribute::DontDelete };
+      static_cast<void>(!enumerable          && attributes.insert(JSPropertyAttribute::DontEnum).second);
+      static_cast<void>(!native_set_callback && attributes.insert(JSPropertyAttribute::ReadOnly).second);
+      HAL_DETAIL_JSEXPORTCLASSDEFINITIONBUILDER_LOCK_GUARD;
+      AddValuePropertyCallback(JSExportNamedValuePropertyCallback<T>(property_name, native_get_callback, native_set_callback, attributes));
+      return *this;
+    }
+
     /*!
      @method
      
@@ -312,6 +331,71 @@ namespace HAL { namespace detail {
       return *this;
     }   
     
+    /*!
+     @method
+     
+     @abstract Add callbacks to invoke when getting and setting a
+     memoized property on your JavaScript object. The getter callback
+     is called on the first read, and its result is cached in the
+     native object and returned by every later read until native code
+     calls JSExportObject::InvalidateProperty.
+     
+     The property will always have the 'DontDelete' attribute. If a
+     setter callback is not provided then the property will also have
+     the 'ReadOnly' attribute. A successful set from JavaScript
+     invalidates the cached value. By default the property is
+     enumerable unless you specify otherwise.
+     
+     @discussion Unlike a constant property, which is cached once per
+     class, a memoized property is cached per object and can be
+     invalidated. For example, given this class definition:
+     
+     class Foo : public JSExportObject {
+     JSValue GetSummary() const;
+     void SetName(const std::string& name) {
+     name__ = name;
+     InvalidateProperty("summary");
+     }
+     };
+     
+     You would call the builder like this:
+     
+     JSExportClassDefinitionBuilder<Foo> builder("Foo");
+     builder.AddMemoizedProperty("summary", &Foo::GetSummary);
+     
+     The cached value is protected from the garbage collector for as
+     long as it is cached, so it should not refer back to the
+     JavaScript object that owns it.
+     
+     @param property_name A JSString containing the property's name.
+     
+     @param get_callback The callback to invoke when the property has
+     no cached value.
+     
+     @param set_callback The callback to invoke when setting a
+     property's value on your JavaScript object.
+     
+     @param enumerable An optional property attribute that specifies
+     whether the property is enumerable. The default value is true,
+     which means the property is enumerable.
+     
+     @throws std::invalid_argument exception under these preconditions:
+     
+     1. If property_name is empty.
+     
+     2. If get_callback is missing.
+     
+     @result A reference to the builder for chaining.
+     */
+    JSExportClassDefinitionBuilder<T>& AddMemoizedProperty(const JSString& property_name, GetNamedValuePropertyCallback<T> get_callback, SetNamedValuePropertyCallback<T> set_callback = nullptr, bool enumerable = true) {
+      std::unordered_set<JSPropertyAttribute> attributes { JSPropertyAttribute::DontDelete };
+      static_cast<void>(!enumerable   && attributes.insert(JSPropertyAttribute::DontEnum).second);
+      static_cast<void>(!set_callback && attributes.insert(JSPropertyAttribute::ReadOnly).second);
+      HAL_DETAIL_JSEXPORTCLASSDEFINITIONBUILDER_LOCK_GUARD;
+      AddMemoizedPropertyCallback(JSExportNamedValuePropertyCallback<T>(property_name, get_callback, set_callback, attributes));
+      return *this;
+    }
+    
     /*!
      @method
      
@@ -352,6 +436,24 @@ namespace HAL { namespace detail {
       return *this;
     }
     
+    /*!
+     @method
+     
+     @abstract Add a typed function property to your JavaScript
+     object with the 'DontDelete' and 'ReadOnly' attributes. This is
+     the same as the AddFunctionProperty above, except the callback
+     receives the JavaScriptCore C API arguments array directly.
+     
+     @result A reference to the builder for chaining.
+     */
+    JSExportClassDefinitionBuilder<T>& AddFunctionProperty(const JSString& function_name, CallNamedNativeFunctionCallback<T> native_function_callback, bool enumerable = true) {
+      std::unordered_set<JSPropertyAttribute> attributes { JSPropertyAttribute::None };
+      static_cast<void>(!enumerable && attributes.insert(JSPropertyAttribute::DontEnum).second);
+      HAL_DETAIL_JSEXPORTCLASSDEFINITIONBUILDER_LOCK_GUARD;
+      AddFunctionPropertyCallback(JSExportNamedFunctionPropertyCallback<T>(function_name, native_function_callback, attributes));
+      return *this;
+    }
+    
     /*!
      @method
      
@@ -692,6 +794,7 @@ namespace HAL { namespace detail {
   private:
     
     void AddConstantPropertyCallback(const JSExportNamedValuePropertyCallback<T>& value_property_callback);
+    void AddMemoizedPropertyCallback(const JSExportNamedValuePropertyCallback<T>& value_property_callback);
     void AddValuePropertyCallback(const JSExportNamedValuePropertyCallback<T>& value_property_callback);
     void AddFunctionPropertyCallback(const JSExportNamedFunctionPropertyCallback<T>& function_property_callback);
     
@@ -704,6 +807,7 @@ namespace HAL { namespace detail {
     std::string                                   name__;
     JSClass                                       parent__;
     std::unordered_set<std::string>               named_constants__;
+    std::unordered_set<std::string>               named_memoized__;
     JSExportNamedValuePropertyCallbackMap_t<T>    named_value_property_callback_map__;
     JSExportNamedFunctionPropertyCallbackMap_t<T> named_function_property_callback_map__;
     HasPropertyCallback<T>                        has_property_callback__        { nullptr };
@@ -737,6 +841,26 @@ namespace HAL { namespace detail {
     AddValuePropertyCallback(value_property_callback);
   } 
 
+  template<typename T>
+  void JSExportClassDefinitionBuilder<T>::AddMemoizedPropertyCallback(const JSExportNamedValuePropertyCallback<T>& value_property_callback) {
+    const std::string internal_component_name = "JSExportClassDefinitionBuilder<" + name__ + ">::AddMemoizedPropertyCallback";
+    const auto property_name                  = value_property_callback.get_name();
+    const auto position                       = named_memoized__.find(property_name);
+    const bool found                          = position != named_memoized__.end();
+    
+    if (found) {
+      const std::string message = "Memoized property " + property_name + " already added";
+      ThrowInvalidArgument(internal_component_name, message);
+    }
+    
+    AddValuePropertyCallback(value_property_callback);
+    
+    const auto callback_insert_result = named_memoized__.emplace(property_name);
+    const bool callback_inserted      = callback_insert_result.second;
+    
+    assert(callback_inserted);
+  }
+
   template<typename T>
   void JSExportClassDefinitionBuilder<T>::AddValuePropertyCallback(const JSExportNamedValuePropertyCallback<T>& value_property_callback) {
     const std::string internal_component_name = "JSExportClassDefinitionBuilder<" + name__ + ">::AddValuePropertyCallback";
@@ -820,18 +944,28 @@ namespace HAL { namespace detail {
   
   template<typename T>
   JSExportClassDefinition<T>::JSExportClassDefinition(const JSExportClassDefinitionBuilder<T>& builder)
-  : JSClassDefinition(builder.js_class_definition__)
-  , named_constants__(builder.named_constants__)
-  , named_value_property_callback_map__(builder.named_value_property_callback_map__)
-  , named_function_property_callback_map__(builder.named_function_property_callback_map__)
-  , has_property_callback__(builder.has_property_callback__)
-  , get_property_callback__(builder.get_property_callback__)
-  , set_property_callback__(builder.set_property_callback__)
-  , delete_property_callback__(builder.delete_property_callback__)
-  , get_property_names_callback__(builder.get_property_names_callback__)
-  , call_as_function_callback__(builder.call_as_function_callback__)
-  , convert_to_type_callback__(builder.convert_to_type_callback__) {
-    InitializeNamedPropertyCallbacks();
+  : JSClassDefinition(CreateState(builder)) {
+  }
+  
+  template<typename T>
+  std::shared_ptr<const typename JSExportClassDefinition<T>::State> JSExportClassDefinition<T>::CreateState(const JSExportClassDefinitionBuilder<T>& builder) {
+    auto state = std::make_shared<State>();
+    state -> name__                                 = builder.name__;
+    state -> js_class_definition__                  = builder.js_class_definition__;
+    state -> js_class_definition__.className        = state -> name__.c_str();
+    state -> named_constants__                      = builder.named_constants__;
+    state -> named_memoized__                       = builder.named_memoized__;
+    state -> named_value_property_callback_map__    = builder.named_value_property_callback_map__;
+    state -> named_function_property_callback_map__ = builder.named_function_property_callback_map__;
+    state -> has_property_callback__                = builder.has_property_callback__;
+    state -> get_property_callback__                = builder.get_property_callback__;
+    state -> set_property_callback__                = builder.set_property_callback__;
+    state -> delete_property_callback__             = builder.delete_property_callback__;
+    state -> get_property_names_callback__          = builder.get_property_names_callback__;
+    state -> call_as_function_callback__            = builder.call_as_function_callback__;
+    state -> convert_to_type_callback__             = builder.convert_to_type_callback__;
+    InitializeNamedPropertyCallbacks(*state);
+    return state;
   }
   
 }} // namespace HAL { namespace detail {
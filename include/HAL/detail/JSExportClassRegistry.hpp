@@ -0,0 +1,92 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSEXPORTCLASSREGISTRY_HPP_
+#define _HAL_DETAIL_JSEXPORTCLASSREGISTRY_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+
+#include <cstddef>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion How long it took to create the JSClass of one
+   JSExport<T> class.
+   */
+  struct JSExportClassWarmUp final {
+    std::string               name;
+    std::chrono::microseconds duration { 0 };
+  };
+
+  /*!
+   @class
+
+   @discussion JSExportClassRegistry keeps track of every JSExport<T>
+   class in the program. Each JSExport<T> registers itself during
+   static initialization, so WarmUp can create all of their JSClasses
+   before the first JavaScript object is created instead of on first
+   use.
+   */
+  class HAL_EXPORT JSExportClassRegistry final HAL_PERFORMANCE_COUNTER1(JSExportClassRegistry) {
+
+  public:
+
+    typedef void (*WarmUpCallback)();
+
+    /*!
+     @method
+
+     @abstract Register a class. warm_up_callback must create the
+     class' JSClass, and must be safe to call more than once and from
+     any thread.
+
+     @result Always true, so that the result can initialize a static
+     data member.
+     */
+    static bool Register(const std::string& name, WarmUpCallback warm_up_callback);
+
+    /*!
+     @method
+
+     @abstract Call the warm up callback of every registered class,
+     spread across thread_count threads (including the calling
+     thread).
+
+     @discussion Classes are independent of each other except along
+     SetParent chains. A class whose parent has not been created yet
+     creates it first, so the parent's cost is included in the child's
+     duration, and a thread that needs a parent another thread is
+     creating waits for it.
+
+     @param thread_count The number of threads to use, or 0 to use one
+     per hardware thread.
+
+     @result The time each class took, in registration order.
+
+     @throws The first exception thrown by a warm up callback, after
+     all threads have finished.
+     */
+    static std::vector<JSExportClassWarmUp> WarmUp(std::size_t thread_count = 0);
+
+    /*!
+     @method
+
+     @abstract Return the number of registered classes.
+     */
+    static std::size_t GetCount() HAL_NOEXCEPT;
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSEXPORTCLASSREGISTRY_HPP_
@@ -0,0 +1,77 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSEXPORTERROR_HPP_
+#define _HAL_DETAIL_JSEXPORTERROR_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+#include "HAL/detail/JSUtil.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion JSExportError creates the JavaScript Error objects that
+   JSExportClass throws when a native callback throws a C++ exception.
+
+   The Errors are objects of a class whose private data holds their
+   fields. The fields ('message', 'name', 'fileName', 'lineNumber',
+   'stack' and 'nativeStack', as far as an Error has them) are own
+   properties served by getters, which create the JavaScript strings
+   only when JavaScript reads them. Assigning to a field replaces it
+   with an ordinary property. This keeps exceptions that JavaScript
+   catches and ignores cheap.
+   */
+  class HAL_EXPORT JSExportError final HAL_PERFORMANCE_COUNTER1(JSExportError) {
+
+  public:
+
+    /*!
+     @method
+
+     @abstract Create an Error for a C++ exception thrown by native
+     code.
+
+     @discussion 'nativeStack' reports JSError::NativeStack__ as it is
+     now, not as it is when JavaScript reads it, but it is only
+     formatted when JavaScript reads it. The Error inherits 'stack'
+     from an ordinary Error constructed at the same time, since only
+     JavaScriptCore can capture the JavaScript stack.
+
+     @result The Error, or the exception JavaScriptCore threw while
+     creating it.
+     */
+    static JSValueRef Create(JSContextRef context_ref, const std::string& name, const std::string& message);
+
+    /*!
+     @method
+
+     @abstract Create an Error for a JavaScript exception that passed
+     through native code, restoring the fields it had in JavaScript.
+
+     @result The Error, or the exception JavaScriptCore threw while
+     creating it.
+     */
+    static JSValueRef Create(JSContextRef context_ref, const js_runtime_error& e);
+
+    /*!
+     @method
+
+     @abstract Return the number of Errors created by JSExportError
+     that have not been finalized.
+     */
+    static std::size_t GetCount() HAL_NOEXCEPT;
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSEXPORTERROR_HPP_
@@ -0,0 +1,98 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSEXPORTFINALIZERQUEUE_HPP_
+#define _HAL_DETAIL_JSEXPORTFINALIZERQUEUE_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+
+#include <cstddef>
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion JSExportFinalizerQueue holds native objects whose
+   JavaScript objects have been garbage collected but whose C++
+   destructors have not run yet. This keeps expensive destructors out
+   of the JavaScriptCore garbage collector's finalizer, and therefore
+   out of GC pauses.
+
+   There are two queues, both lock-free for producers:
+
+   1. The deferred queue, which is only drained when
+   JSContextGroup::DrainFinalizers is called.
+
+   2. The background queue, which is drained by a single background
+   thread that is started the first time it is used. Only native
+   objects whose destructors may run on any thread belong here, which
+   requires HAL_THREAD_SAFE.
+
+   The queues link the Node embedded in each native object, so
+   enqueueing from the garbage collector's finalizer never allocates.
+
+   JSExportClass enqueues native objects according to
+   JSExportTraits<T>::defer_finalization and
+   JSExportTraits<T>::thread_safe_finalization.
+   */
+  class HAL_EXPORT JSExportFinalizerQueue final HAL_PERFORMANCE_COUNTER1(JSExportFinalizerQueue) {
+
+  public:
+
+    typedef void (*Finalizer)(void* native_object_ptr);
+
+    // A queue entry, owned by the object it finalizes. The finalizer
+    // may destroy the Node.
+    struct Node {
+      void*     native_object_ptr { nullptr };
+      Finalizer finalizer         { nullptr };
+      Node*     next              { nullptr };
+    };
+
+    /*!
+     @method
+
+     @abstract Queue node_ptr's native object to be finalized by the
+     next call to Drain.
+     */
+    static void Enqueue(Node* node_ptr) HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Queue node_ptr's native object to be finalized on the
+     background finalizer thread. If that thread has already been
+     stopped (i.e. during process exit) the finalizer runs
+     immediately.
+     */
+    static void EnqueueBackground(Node* node_ptr);
+
+    /*!
+     @method
+
+     @abstract Run the finalizers of every native object in the
+     deferred queue, in the order they were enqueued, on the calling
+     thread.
+
+     @result The number of native objects finalized.
+     */
+    static std::size_t Drain();
+
+    /*!
+     @method
+
+     @abstract Return the number of native objects waiting in the
+     deferred queue.
+     */
+    static std::size_t GetPendingCount() HAL_NOEXCEPT;
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSEXPORTFINALIZERQUEUE_HPP_
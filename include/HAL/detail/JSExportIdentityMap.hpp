@@ -0,0 +1,89 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSEXPORTIDENTITYMAP_HPP_
+#define _HAL_DETAIL_JSEXPORTIDENTITYMAP_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+
+#include <cstddef>
+
+#ifdef HAL_THREAD_SAFE
+#include <atomic>
+#endif
+
+namespace HAL {
+  class JSExportObject;
+}
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion JSExportIdentityMap maps each native object created by
+   a JSExportClass to the JavaScript object that owns it in the
+   native object's global context.
+
+   Each native object holds its own entry, so the map needs no global
+   table and no lock. Entries are atomic when HAL_THREAD_SAFE is
+   defined.
+
+   The map is weak: it does not protect the JavaScript objects from
+   the garbage collector. JSExportClass adds an entry when it
+   initializes a JavaScript object and removes it when the object is
+   finalized, so an entry is only present while the JavaScript object
+   is alive.
+   */
+  class HAL_EXPORT JSExportIdentityMap final HAL_PERFORMANCE_COUNTER1(JSExportIdentityMap) {
+
+  public:
+
+    // The entry embedded in a JSExportObject. It identifies the
+    // JavaScript object of that native object only, so it is neither
+    // copied nor moved with it.
+    class Entry final {
+    public:
+      Entry() HAL_NOEXCEPT {
+      }
+
+      Entry(const Entry&) HAL_NOEXCEPT
+      : Entry() {
+      }
+
+      Entry& operator=(const Entry&) HAL_NOEXCEPT {
+        return *this;
+      }
+
+    private:
+      friend class JSExportIdentityMap;
+
+#ifdef HAL_THREAD_SAFE
+      std::atomic<JSObjectRef> object_ref__ { nullptr };
+#else
+      JSObjectRef              object_ref__ { nullptr };
+#endif
+    };
+
+    static void Register(JSContextRef context_ref, JSExportObject* native_object_ptr, JSObjectRef object_ref) HAL_NOEXCEPT;
+
+    static void UnRegister(JSContextRef context_ref, JSExportObject* native_object_ptr) HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Return the JavaScript object that owns
+     native_object_ptr in the global context of context_ref, or
+     nullptr if there isn't one.
+     */
+    static JSObjectRef Find(JSContextRef context_ref, const JSExportObject* native_object_ptr) HAL_NOEXCEPT;
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSEXPORTIDENTITYMAP_HPP_
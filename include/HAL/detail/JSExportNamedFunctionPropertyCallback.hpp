@@ -73,10 +73,40 @@ namespace HAL { namespace detail {
                                           CallNamedFunctionCallback<T> function_callback,
                                           const std::unordered_set<JSPropertyAttribute>& attributes);
     
+    /*!
+     @method
+     
+     @abstract Create a callback for a typed function property, one
+     that converts its arguments directly from the JavaScriptCore C
+     API arguments array.
+     
+     @param name The function property's name.
+     
+     @param native_function_callback The callback to invoke when
+     calling the JavaScript object as a function.
+     
+     @param attributes The set of JSPropertyAttributes to give to
+     the function property.
+     
+     @throws std::invalid_argument exception under these
+     preconditions:
+     
+     1. If function_name is empty.
+     
+     2. If the native_function_callback is not provided.
+     */
+    JSExportNamedFunctionPropertyCallback(const std::string& function_name,
+                                          CallNamedNativeFunctionCallback<T> native_function_callback,
+                                          const std::unordered_set<JSPropertyAttribute>& attributes);
+    
     CallNamedFunctionCallback<T> function_callback() const {
       return function_callback__;
     }
     
+    const CallNamedNativeFunctionCallback<T>& native_function_callback() const {
+      return native_function_callback__;
+    }
+    
     ~JSExportNamedFunctionPropertyCallback()                                                       = default;
     JSExportNamedFunctionPropertyCallback(const JSExportNamedFunctionPropertyCallback&)            HAL_NOEXCEPT;
     JSExportNamedFunctionPropertyCallback(JSExportNamedFunctionPropertyCallback&&)                 HAL_NOEXCEPT;
@@ -89,7 +119,8 @@ namespace HAL { namespace detail {
     template<typename U>
     friend bool operator==(const JSExportNamedFunctionPropertyCallback<U>& lhs, const JSExportNamedFunctionPropertyCallback<U>& rhs) HAL_NOEXCEPT;
     
-    CallNamedFunctionCallback<T> function_callback__ { nullptr };
+    CallNamedFunctionCallback<T>       function_callback__        { nullptr };
+    CallNamedNativeFunctionCallback<T> native_function_callback__ { nullptr };
   };
   
   template<typename T>
@@ -105,23 +136,39 @@ namespace HAL { namespace detail {
     }
   }
   
+  template<typename T>
+  JSExportNamedFunctionPropertyCallback<T>::JSExportNamedFunctionPropertyCallback(
+                                                                                  const std::string& function_name,
+                                                                                  CallNamedNativeFunctionCallback<T> native_function_callback,
+                                                                                  const std::unordered_set<JSPropertyAttribute>& attributes)
+  : JSPropertyCallback(function_name, attributes)
+  , native_function_callback__(native_function_callback) {
+    
+    if (!native_function_callback) {
+      ThrowInvalidArgument("JSExportNamedFunctionPropertyCallback", "native_function_callback is missing");
+    }
+  }
+  
   template<typename T>
   JSExportNamedFunctionPropertyCallback<T>::JSExportNamedFunctionPropertyCallback(const JSExportNamedFunctionPropertyCallback& rhs) HAL_NOEXCEPT
   : JSPropertyCallback(rhs)
-  , function_callback__(rhs.function_callback__) {
+  , function_callback__(rhs.function_callback__)
+  , native_function_callback__(rhs.native_function_callback__) {
   }
   
   template<typename T>
   JSExportNamedFunctionPropertyCallback<T>::JSExportNamedFunctionPropertyCallback(JSExportNamedFunctionPropertyCallback&& rhs) HAL_NOEXCEPT
   : JSPropertyCallback(rhs)
-  , function_callback__(std::move(rhs.function_callback__)) {
+  , function_callback__(std::move(rhs.function_callback__))
+  , native_function_callback__(std::move(rhs.native_function_callback__)) {
   }
   
   template<typename T>
   JSExportNamedFunctionPropertyCallback<T>& JSExportNamedFunctionPropertyCallback<T>::operator=(const JSExportNamedFunctionPropertyCallback<T>& rhs) HAL_NOEXCEPT {
     HAL_DETAIL_JSPROPERTYCALLBACK_LOCK_GUARD;
     JSPropertyCallback::operator=(rhs);
-    function_callback__ = rhs.function_callback__;
+    function_callback__        = rhs.function_callback__;
+    native_function_callback__ = rhs.native_function_callback__;
     return *this;
   }
   
@@ -140,7 +187,8 @@ namespace HAL { namespace detail {
     
     // By swapping the members of two classes, the two classes are
     // effectively swapped.
-    swap(function_callback__, other.function_callback__);
+    swap(function_callback__       , other.function_callback__);
+    swap(native_function_callback__, other.native_function_callback__);
   }
   
   template<typename T>
@@ -160,6 +208,14 @@ namespace HAL { namespace detail {
       return false;
     }
     
+    if (lhs.native_function_callback__ && !rhs.native_function_callback__) {
+      return false;
+    }
+    
+    if (!lhs.native_function_callback__ && rhs.native_function_callback__) {
+      return false;
+    }
+    
     return static_cast<JSPropertyCallback>(lhs) == static_cast<JSPropertyCallback>(rhs);
   }
   
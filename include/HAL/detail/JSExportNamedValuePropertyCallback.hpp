@@ -66,6 +66,36 @@ namespace HAL { namespace detail {
                                        SetNamedValuePropertyCallback<T> set_callback,
                                        const std::unordered_set<JSPropertyAttribute>& attributes);
     
+    /*!
+     @method
+     
+     @abstract Set the typed callbacks to invoke when getting and
+     setting a property value on a JavaScript object. These work
+     directly with JSValueRef and are checked before the JSValue
+     based callbacks.
+     
+     @param name The value property's name.
+     
+     @param native_get_callback The callback to invoke when getting a
+     property's value from a JavaScript object.
+     
+     @param native_set_callback The callback to invoke when setting a
+     property's value on a JavaScript object. This may be nullptr,
+     in which case the ReadOnly attribute is automatically set.
+     
+     @param attributes The set of JSPropertyAttributes to give to
+     the value property.
+     
+     @result An object which describes a JavaScript value property.
+     
+     @throws std::invalid_argument exception under the same
+     preconditions as the JSValue based constructor.
+     */
+    JSExportNamedValuePropertyCallback(const std::string& property_name,
+                                       GetNamedNativeValuePropertyCallback<T> native_get_callback,
+                                       SetNamedNativeValuePropertyCallback<T> native_set_callback,
+                                       const std::unordered_set<JSPropertyAttribute>& attributes);
+    
     GetNamedValuePropertyCallback<T> get_callback() const HAL_NOEXCEPT {
       return get_callback__;
     }
@@ -74,6 +104,14 @@ namespace HAL { namespace detail {
       return set_callback__;
     }
     
+    const GetNamedNativeValuePropertyCallback<T>& native_get_callback() const HAL_NOEXCEPT {
+      return native_get_callback__;
+    }
+    
+    const SetNamedNativeValuePropertyCallback<T>& native_set_callback() const HAL_NOEXCEPT {
+      return native_set_callback__;
+    }
+    
     ~JSExportNamedValuePropertyCallback()                                                    = default;
     JSExportNamedValuePropertyCallback(const JSExportNamedValuePropertyCallback&)            HAL_NOEXCEPT;
     JSExportNamedValuePropertyCallback(JSExportNamedValuePropertyCallback&&)                 HAL_NOEXCEPT;
@@ -86,8 +124,12 @@ namespace HAL { namespace detail {
     template<typename U>
     friend bool operator==(const JSExportNamedValuePropertyCallback<U>& lhs, const JSExportNamedValuePropertyCallback<U>& rhs) HAL_NOEXCEPT;
     
-    GetNamedValuePropertyCallback<T> get_callback__;
-    SetNamedValuePropertyCallback<T> set_callback__;
+    void ValidateCallbacks(bool has_get_callback, bool has_set_callback, const std::unordered_set<JSPropertyAttribute>& attributes);
+    
+    GetNamedValuePropertyCallback<T>       get_callback__;
+    SetNamedValuePropertyCallback<T>       set_callback__;
+    GetNamedNativeValuePropertyCallback<T> native_get_callback__;
+    SetNamedNativeValuePropertyCallback<T> native_set_callback__;
   };
   
   template<typename T>
@@ -99,24 +141,40 @@ namespace HAL { namespace detail {
   : JSPropertyCallback(property_name, attributes)
   , get_callback__(get_callback)
   , set_callback__(set_callback) {
-    
-    if (!get_callback && !set_callback) {
+    ValidateCallbacks(static_cast<bool>(get_callback), static_cast<bool>(set_callback), attributes);
+  }
+  
+  template<typename T>
+  JSExportNamedValuePropertyCallback<T>::JSExportNamedValuePropertyCallback(
+                                                                            const std::string& property_name,
+                                                                            GetNamedNativeValuePropertyCallback<T> native_get_callback,
+                                                                            SetNamedNativeValuePropertyCallback<T> native_set_callback,
+                                                                            const std::unordered_set<JSPropertyAttribute>& attributes)
+  : JSPropertyCallback(property_name, attributes)
+  , native_get_callback__(native_get_callback)
+  , native_set_callback__(native_set_callback) {
+    ValidateCallbacks(static_cast<bool>(native_get_callback), static_cast<bool>(native_set_callback), attributes);
+  }
+  
+  template<typename T>
+  void JSExportNamedValuePropertyCallback<T>::ValidateCallbacks(bool has_get_callback, bool has_set_callback, const std::unordered_set<JSPropertyAttribute>& attributes) {
+    if (!has_get_callback && !has_set_callback) {
       ThrowInvalidArgument("JSExportNamedValuePropertyCallback", "Both get_callback and set_callback are missing. At least one callback must be provided");
     }
     
     if (attributes.find(JSPropertyAttribute::ReadOnly) != attributes.end()) {
-      if (!get_callback) {
+      if (!has_get_callback) {
         ThrowInvalidArgument("JSExportNamedValuePropertyCallback", "ReadOnly attribute is set but get_callback is missing");
       }
       
-      if (set_callback) {
+      if (has_set_callback) {
         ThrowInvalidArgument("JSExportNamedValuePropertyCallback", "ReadOnly attribute is set but set_callback is provided");
       }
     }
     
     // Force the ReadOnly attribute if only the get_callback is
     // provided.
-    if (get_callback && !set_callback) {
+    if (has_get_callback && !has_set_callback) {
       attributes__.insert(JSPropertyAttribute::ReadOnly);
     }
   }
@@ -125,14 +183,18 @@ namespace HAL { namespace detail {
   JSExportNamedValuePropertyCallback<T>::JSExportNamedValuePropertyCallback(const JSExportNamedValuePropertyCallback& rhs) HAL_NOEXCEPT
   : JSPropertyCallback(rhs)
   , get_callback__(rhs.get_callback__)
-  , set_callback__(rhs.set_callback__) {
+  , set_callback__(rhs.set_callback__)
+  , native_get_callback__(rhs.native_get_callback__)
+  , native_set_callback__(rhs.native_set_callback__) {
   }
   
   template<typename T>
   JSExportNamedValuePropertyCallback<T>::JSExportNamedValuePropertyCallback(JSExportNamedValuePropertyCallback&& rhs) HAL_NOEXCEPT
   : JSPropertyCallback(rhs)
   , get_callback__(std::move(rhs.get_callback__))
-  , set_callback__(std::move(rhs.set_callback__)) {
+  , set_callback__(std::move(rhs.set_callback__))
+  , native_get_callback__(std::move(rhs.native_get_callback__))
+  , native_set_callback__(std::move(rhs.native_set_callback__)) {
   }
   
   template<typename T>
@@ -141,6 +203,8 @@ namespace HAL { namespace detail {
     JSPropertyCallback::operator=(rhs);
     get_callback__ = rhs.get_callback__;
     set_callback__ = rhs.set_callback__;
+    native_get_callback__ = rhs.native_get_callback__;
+    native_set_callback__ = rhs.native_set_callback__;
     return *this;
   }
   
@@ -161,6 +225,8 @@ namespace HAL { namespace detail {
     // effectively swapped.
     swap(get_callback__, other.get_callback__);
     swap(set_callback__, other.set_callback__);
+    swap(native_get_callback__, other.native_get_callback__);
+    swap(native_set_callback__, other.native_set_callback__);
   }
   
   template<typename T>
@@ -190,6 +256,24 @@ namespace HAL { namespace detail {
       return false;
     }
     
+    // native_get_callback__
+    if (lhs.native_get_callback__ && !rhs.native_get_callback__) {
+      return false;
+    }
+    
+    if (!lhs.native_get_callback__ && rhs.native_get_callback__) {
+      return false;
+    }
+    
+    // native_set_callback__
+    if (lhs.native_set_callback__ && !rhs.native_set_callback__) {
+      return false;
+    }
+    
+    if (!lhs.native_set_callback__ && rhs.native_set_callback__) {
+      return false;
+    }
+    
     return static_cast<JSPropertyCallback>(lhs) == static_cast<JSPropertyCallback>(rhs);
   }
   
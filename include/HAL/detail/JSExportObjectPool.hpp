@@ -0,0 +1,295 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSEXPORTOBJECTPOOL_HPP_
+#define _HAL_DETAIL_JSEXPORTOBJECTPOOL_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+#include "HAL/JSExportTraits.hpp"
+
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <type_traits>
+
+#undef HAL_DETAIL_JSEXPORTOBJECTPOOL_THREAD_CACHE
+#if defined(HAL_THREAD_SAFE) && defined(HAL_THREAD_LOCAL_ENABLE)
+#define HAL_DETAIL_JSEXPORTOBJECTPOOL_THREAD_CACHE
+#endif
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion A snapshot of a JSExportObjectPool's occupancy.
+   */
+  struct JSExportObjectPoolStatistics final {
+
+    // The number of slabs allocated so far. Slabs are never freed.
+    std::size_t slab_count         { 0 };
+
+    // The total number of native objects the slabs can hold.
+    std::size_t capacity           { 0 };
+
+    // The number of live native objects.
+    std::size_t in_use             { 0 };
+
+    // The high-water mark of in_use.
+    std::size_t peak_in_use        { 0 };
+
+    // The number of free slots held in per-thread caches.
+    std::size_t thread_cached      { 0 };
+
+    std::size_t allocation_count   { 0 };
+    std::size_t deallocation_count { 0 };
+
+    // Return in_use as a fraction of capacity.
+    double occupancy() const HAL_NOEXCEPT {
+      return capacity > 0 ? static_cast<double>(in_use) / capacity : 0;
+    }
+  };
+
+  /*!
+   @class
+
+   @discussion A JSExportObjectPool hands out raw storage for the
+   native objects of a single JSExport<T> class. Storage is carved out
+   of fixed-size slabs (JSExportTraits<T>::object_pool_slab_size
+   objects each) and recycled through a free list, so once the pool
+   has warmed up creating and finalizing JavaScript objects no longer
+   touches the global allocator.
+
+   When HAL_THREAD_SAFE is defined each thread also keeps a small
+   cache of free slots (JSExportTraits<T>::object_pool_thread_cache_size)
+   so that most allocations and deallocations don't take the pool's
+   lock.
+
+   The pool only manages memory. Constructing and destroying the
+   objects is up to the caller.
+   */
+  template<typename T>
+  class JSExportObjectPool final {
+
+  public:
+
+    /*!
+     @method
+
+     @abstract Return uninitialized storage suitably sized and aligned
+     for a T.
+
+     @throws std::bad_alloc if a new slab could not be allocated.
+     */
+    static void* Allocate();
+
+    /*!
+     @method
+
+     @abstract Return storage previously obtained from Allocate to the
+     pool. The T that lived there must already have been destroyed.
+     */
+    static void Deallocate(void* ptr) HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Return a snapshot of the pool's occupancy.
+     */
+    static JSExportObjectPoolStatistics GetStatistics() HAL_NOEXCEPT;
+
+  private:
+
+    static const std::size_t slab_size__         = JSExportTraits<T>::object_pool_slab_size;
+    static const std::size_t thread_cache_size__ = JSExportTraits<T>::object_pool_thread_cache_size;
+
+    static_assert(slab_size__ > 0, "JSExportTraits<T>::object_pool_slab_size must be greater than zero");
+
+    union Slot {
+      Slot* next;
+      typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type storage;
+    };
+
+    struct Pool {
+      std::vector<std::unique_ptr<Slot[]>> slabs;
+      Slot*                                free_list { nullptr };
+      std::atomic<std::size_t>             in_use { 0 };
+      std::atomic<std::size_t>             peak_in_use { 0 };
+      std::atomic<std::size_t>             thread_cached { 0 };
+      std::atomic<std::size_t>             allocation_count { 0 };
+      std::atomic<std::size_t>             deallocation_count { 0 };
+#ifdef HAL_THREAD_SAFE
+      std::mutex                           mutex;
+#endif
+    };
+
+    // The pool is intentionally leaked so that objects finalized
+    // during static destruction (e.g. by a static JSContextGroup) can
+    // still be returned to it.
+    static Pool& GetPool() {
+      static Pool* pool_ptr = new Pool();
+      return *pool_ptr;
+    }
+
+    // Pop a slot from the shared free list, growing the pool by one
+    // slab if it is empty. The caller must hold the lock.
+    static Slot* PopSlot(Pool& pool);
+
+    static void UpdateStatistics(Pool& pool) HAL_NOEXCEPT;
+
+#ifdef HAL_DETAIL_JSEXPORTOBJECTPOOL_THREAD_CACHE
+    struct ThreadCache {
+      Slot*       head { nullptr };
+      std::size_t size { 0 };
+
+      // Give the cached slots back when the thread exits.
+      ~ThreadCache() {
+        Pool& pool = GetPool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        while (head) {
+          Slot* slot     = head;
+          head           = slot -> next;
+          slot -> next   = pool.free_list;
+          pool.free_list = slot;
+        }
+        pool.thread_cached -= size;
+        size = 0;
+      }
+    };
+
+    static ThreadCache& GetThreadCache() {
+      static thread_local ThreadCache thread_cache;
+      return thread_cache;
+    }
+#endif
+  };
+
+  template<typename T>
+  typename JSExportObjectPool<T>::Slot* JSExportObjectPool<T>::PopSlot(Pool& pool) {
+    if (!pool.free_list) {
+      std::unique_ptr<Slot[]> slab(new Slot[slab_size__]);
+      for (std::size_t i = 0; i < slab_size__; ++i) {
+        slab[i].next   = pool.free_list;
+        pool.free_list = &slab[i];
+      }
+      pool.slabs.push_back(std::move(slab));
+    }
+
+    Slot* slot     = pool.free_list;
+    pool.free_list = slot -> next;
+    return slot;
+  }
+
+  template<typename T>
+  void JSExportObjectPool<T>::UpdateStatistics(Pool& pool) HAL_NOEXCEPT {
+    ++pool.allocation_count;
+    const std::size_t in_use = ++pool.in_use;
+    std::size_t peak_in_use  = pool.peak_in_use;
+    while (in_use > peak_in_use && !pool.peak_in_use.compare_exchange_weak(peak_in_use, in_use)) {
+    }
+  }
+
+  template<typename T>
+  void* JSExportObjectPool<T>::Allocate() {
+    Pool& pool = GetPool();
+    Slot* slot = nullptr;
+
+#ifdef HAL_DETAIL_JSEXPORTOBJECTPOOL_THREAD_CACHE
+    ThreadCache& thread_cache = GetThreadCache();
+    if (thread_cache.head) {
+      slot              = thread_cache.head;
+      thread_cache.head = slot -> next;
+      --thread_cache.size;
+      --pool.thread_cached;
+    } else {
+      // Refill half of the thread cache while we hold the lock.
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      slot = PopSlot(pool);
+      for (std::size_t i = 0; i < thread_cache_size__ / 2; ++i) {
+        Slot* cached_slot = PopSlot(pool);
+        cached_slot -> next = thread_cache.head;
+        thread_cache.head   = cached_slot;
+        ++thread_cache.size;
+        ++pool.thread_cached;
+      }
+    }
+#else
+#ifdef HAL_THREAD_SAFE
+    std::lock_guard<std::mutex> lock(pool.mutex);
+#endif
+    slot = PopSlot(pool);
+#endif
+
+    UpdateStatistics(pool);
+    return &slot -> storage;
+  }
+
+  template<typename T>
+  void JSExportObjectPool<T>::Deallocate(void* ptr) HAL_NOEXCEPT {
+    if (!ptr) {
+      return;
+    }
+
+    Pool& pool = GetPool();
+    Slot* slot = static_cast<Slot*>(ptr);
+
+    --pool.in_use;
+    ++pool.deallocation_count;
+
+#ifdef HAL_DETAIL_JSEXPORTOBJECTPOOL_THREAD_CACHE
+    ThreadCache& thread_cache = GetThreadCache();
+    slot -> next      = thread_cache.head;
+    thread_cache.head = slot;
+    ++thread_cache.size;
+    ++pool.thread_cached;
+
+    // Return half of an overflowing thread cache to the shared pool.
+    if (thread_cache.size > thread_cache_size__) {
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      while (thread_cache.size > thread_cache_size__ / 2) {
+        Slot* returned_slot = thread_cache.head;
+        thread_cache.head   = returned_slot -> next;
+        --thread_cache.size;
+        --pool.thread_cached;
+        returned_slot -> next = pool.free_list;
+        pool.free_list        = returned_slot;
+      }
+    }
+#else
+#ifdef HAL_THREAD_SAFE
+    std::lock_guard<std::mutex> lock(pool.mutex);
+#endif
+    slot -> next   = pool.free_list;
+    pool.free_list = slot;
+#endif
+  }
+
+  template<typename T>
+  JSExportObjectPoolStatistics JSExportObjectPool<T>::GetStatistics() HAL_NOEXCEPT {
+    Pool& pool = GetPool();
+    JSExportObjectPoolStatistics statistics;
+    {
+#ifdef HAL_THREAD_SAFE
+      std::lock_guard<std::mutex> lock(pool.mutex);
+#endif
+      statistics.slab_count = pool.slabs.size();
+      statistics.capacity   = pool.slabs.size() * slab_size__;
+    }
+    statistics.in_use             = pool.in_use;
+    statistics.peak_in_use        = pool.peak_in_use;
+    statistics.thread_cached      = pool.thread_cached;
+    statistics.allocation_count   = pool.allocation_count;
+    statistics.deallocation_count = pool.deallocation_count;
+    return statistics;
+  }
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSEXPORTOBJECTPOOL_HPP_
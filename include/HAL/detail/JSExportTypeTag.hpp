@@ -0,0 +1,100 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSEXPORTTYPETAG_HPP_
+#define _HAL_DETAIL_JSEXPORTTYPETAG_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace HAL {
+  class JSExportObject;
+}
+
+namespace HAL { namespace detail {
+  
+  /*!
+   @class
+   
+   @discussion A JSExportTypeTag identifies the JSExportClass that
+   created a native object. Every JSExportClass registers one tag
+   with a small integer type id and a bitset of the type ids of its
+   ancestors along its SetParent chain (including itself), so
+   deciding whether a native object is an instance of a class is a
+   single bit test rather than a dynamic_cast.
+   
+   Tags are created once per JSClass and are never destroyed.
+   */
+  class HAL_EXPORT JSExportTypeTag final HAL_PERFORMANCE_COUNTER1(JSExportTypeTag) {
+    
+  public:
+    
+    /*!
+     @method
+     
+     @abstract Return the tag for js_class_ref, registering it if
+     necessary.
+     
+     @param js_class_ref The JSClassRef being registered.
+     
+     @param parent_js_class_ref The JSClassRef of its parent, or
+     nullptr. If the parent was registered, its ancestors become
+     ancestors of js_class_ref.
+     */
+    static const JSExportTypeTag* Register(JSClassRef js_class_ref, JSClassRef parent_js_class_ref);
+    
+    std::uint32_t get_type_id() const HAL_NOEXCEPT {
+      return type_id__;
+    }
+    
+    /*!
+     @method
+     
+     @abstract Return true if this tag is the same as ancestor or
+     ancestor appears in this tag's SetParent chain.
+     */
+    bool IsKindOf(const JSExportTypeTag& ancestor) const HAL_NOEXCEPT {
+      const std::size_t word = ancestor.type_id__ / 64;
+      return word < ancestors__.size() && ((ancestors__[word] >> (ancestor.type_id__ % 64)) & 1) != 0;
+    }
+    
+  private:
+    
+    JSExportTypeTag(std::uint32_t type_id, const JSExportTypeTag* parent_ptr);
+    
+    JSExportTypeTag(const JSExportTypeTag&)            = delete;
+    JSExportTypeTag& operator=(const JSExportTypeTag&) = delete;
+    
+    // Silence 4251 on Windows since private member variables do not
+    // need to be exported from a DLL.
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    std::uint32_t              type_id__;
+    std::vector<std::uint64_t> ancestors__;
+#pragma warning(pop)
+  };
+  
+  // Mixed into the address of a native object to form the signature
+  // that marks its tag as valid.
+  static const std::uintptr_t JSExportSignatureKey = static_cast<std::uintptr_t>(0x4A534578706F7274ULL);
+  
+  // Return the signature a native object at native_object_ptr
+  // carries. Defined in JSExportObject.hpp.
+  inline std::uintptr_t GetJSExportSignature(const JSExportObject* native_object_ptr) HAL_NOEXCEPT;
+  
+  // Return the tag of the JSExportClass that created the native
+  // object, or nullptr if native_object_ptr is the private data of an
+  // object that no JSExportClass created. Defined in
+  // JSExportObject.hpp.
+  inline const JSExportTypeTag* GetJSExportTypeTag(const JSExportObject* native_object_ptr) HAL_NOEXCEPT;
+  
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSEXPORTTYPETAG_HPP_
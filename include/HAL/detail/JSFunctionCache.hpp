@@ -0,0 +1,79 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSFUNCTIONCACHE_HPP_
+#define _HAL_DETAIL_JSFUNCTIONCACHE_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+#include "HAL/JSContext.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion JSFunctionCache keeps the functions compiled by
+   JSContext::CreateFunction(body, ...) so that creating the same
+   function again in the same global context returns the existing
+   function object instead of parsing its body again.
+
+   Each global context has its own least recently used cache, which
+   is empty and disabled until it is given a capacity. The function
+   objects are held by a hidden object reachable from the global
+   object, so they are traced by the garbage collector and go away
+   with the context.
+   */
+  class HAL_EXPORT JSFunctionCache final HAL_PERFORMANCE_COUNTER1(JSFunctionCache) {
+
+  public:
+
+    /*!
+     @method
+
+     @abstract Return whether the cache of the global context of
+     context_ref has a capacity greater than zero.
+     */
+    static bool IsEnabled(JSContextRef context_ref) HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Return the key identifying a function with the given
+     body, parameter names, name, source URL and starting line
+     number.
+     */
+    static std::string MakeKey(const JSString& body, const std::vector<JSString>& parameter_names, const JSString& function_name, const JSString& source_url, int starting_line_number);
+
+    /*!
+     @method
+
+     @abstract Return the function cached under key, or nullptr,
+     counting a hit or a miss.
+     */
+    static JSObjectRef Find(JSContextRef context_ref, const std::string& key) HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Cache function_ref under key, evicting the least
+     recently used function if the cache is full.
+     */
+    static void Insert(JSContextRef context_ref, const std::string& key, JSObjectRef function_ref) HAL_NOEXCEPT;
+
+    static void SetCapacity(JSContextRef context_ref, std::size_t capacity) HAL_NOEXCEPT;
+    static JSFunctionCacheStatistics GetStatistics(JSContextRef context_ref) HAL_NOEXCEPT;
+    static void Invalidate(JSContextRef context_ref) HAL_NOEXCEPT;
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSFUNCTIONCACHE_HPP_
@@ -0,0 +1,81 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSFUNCTIONCLASS_HPP_
+#define _HAL_DETAIL_JSFUNCTIONCLASS_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+#include "HAL/JSContext.hpp"
+
+#include <cstddef>
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion JSFunctionClass creates the JavaScript function objects
+   behind a JSFunction that calls C++. Each one is an object of a
+   private JSClass whose private data points to a record holding the
+   C++ callback and the function's name, so calling it from
+   JavaScript is a single pointer load rather than a lookup in a
+   global table. Copying a JSFunction copies a reference to the
+   function object, never the record.
+
+   Each function object has a record of its own, since the record
+   also holds the name. Records are reference counted: the function
+   object holds one reference, which its finalizer releases, and
+   JSContextHandles holds another while the callback holds handles to
+   the function's context (see below).
+
+   The function objects inherit from Function.prototype through the
+   class's prototype, which is linked to Function.prototype once per
+   context, and serve 'name' from the record, so they behave like the
+   ones created by JSObjectMakeFunctionWithCallback.
+
+   A callback may capture a JSContext, JSValue or JSObject of the
+   function's own context, which would keep the context alive for as
+   long as the function exists. The handles the callback captures are
+   counted while it is copied into the record, and the record empties
+   its callback once they are the only handles to the context left
+   (see JSContextHandles), so the context and its functions can still
+   be collected.
+   */
+  class HAL_EXPORT JSFunctionClass final HAL_PERFORMANCE_COUNTER1(JSFunctionClass) {
+
+  public:
+
+    static JSObjectRef MakeFunction(JSContextRef context_ref, JSStringRef function_name_ref, const JSFunctionCallback& callback);
+    static JSObjectRef MakeFunction(JSContextRef context_ref, JSStringRef function_name_ref, const JSNativeFunctionCallback& callback);
+
+    /*!
+     @method
+
+     @abstract Create a function object that does nothing and returns
+     undefined.
+     */
+    static JSObjectRef MakeFunction(JSContextRef context_ref, JSStringRef function_name_ref);
+
+    /*!
+     @method
+
+     @abstract Return the number of live function objects.
+     */
+    static std::size_t GetCount() HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Return the number of live callback records.
+     */
+    static std::size_t GetRecordCount() HAL_NOEXCEPT;
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSFUNCTIONCLASS_HPP_
@@ -0,0 +1,196 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSNATIVEFUNCTION_HPP_
+#define _HAL_DETAIL_JSNATIVEFUNCTION_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+#include "HAL/detail/JSUtil.hpp"
+#include "HAL/detail/JSValueConverter.hpp"
+#include "HAL/detail/JSExportCallbacks.hpp"
+
+#include <string>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <type_traits>
+#include <JavaScriptCore/JavaScript.h>
+
+namespace HAL { namespace detail {
+
+  // C++11 stand-in for std::index_sequence.
+  template<std::size_t... I>
+  struct index_sequence {
+  };
+
+  template<std::size_t N, std::size_t... I>
+  struct make_index_sequence : make_index_sequence<N - 1, N - 1, I...> {
+  };
+
+  template<std::size_t... I>
+  struct make_index_sequence<0, I...> : index_sequence<I...> {
+  };
+
+  template<bool...>
+  struct bool_pack;
+
+  template<bool... B>
+  struct all_true : std::is_same<bool_pack<true, B...>, bool_pack<B..., true>> {
+  };
+
+  /*!
+   @class
+
+   @discussion JSNativeFunction adapts a C++ callable with the
+   signature R(Args...) to the JavaScriptCore C API calling
+   convention. Each argument is converted directly from the
+   JSValueRef array with a JSValueConverter, and the result is
+   converted back to a JSValueRef the same way, so no
+   std::vector<JSValue> is ever built.
+
+   The argument and result types are checked at compile-time. At
+   run-time calling with fewer arguments than the signature requires
+   throws std::invalid_argument; extra arguments are ignored, as they
+   are in JavaScript.
+   */
+  template<typename R, typename... Args>
+  class JSNativeFunction final {
+
+    static_assert(all_true<HasJSValueConverter<Args>::value...>::value,
+                  "JSNativeFunction: every argument type must be one of double, int32_t, uint32_t, bool, std::string, JSValue or JSObject");
+    static_assert(std::is_void<R>::value || HasJSValueConverter<R>::value,
+                  "JSNativeFunction: the result type must be void or one of double, int32_t, uint32_t, bool, std::string, JSValue or JSObject");
+
+  public:
+
+    static const std::size_t arity = sizeof...(Args);
+
+    template<typename F>
+    static JSValueRef Call(F& function, JSContextRef context_ref, std::size_t argument_count, const JSValueRef arguments_array[]) {
+      if (argument_count < arity) {
+        ThrowInvalidArgument("JSNativeFunction", "expected " + std::to_string(arity) + " arguments but got " + std::to_string(argument_count));
+      }
+      return Call(function, context_ref, arguments_array, make_index_sequence<arity>(), std::is_void<R>());
+    }
+
+  private:
+
+    template<typename F, std::size_t... I>
+    static JSValueRef Call(F& function, JSContextRef context_ref, const JSValueRef arguments_array[], index_sequence<I...>, std::false_type) {
+      static_cast<void>(arguments_array);
+      return JSValueConverter<typename std::decay<R>::type>::ToJSValueRef(context_ref, function(JSValueConverter<typename std::decay<Args>::type>::FromJSValueRef(context_ref, arguments_array[I])...));
+    }
+
+    template<typename F, std::size_t... I>
+    static JSValueRef Call(F& function, JSContextRef context_ref, const JSValueRef arguments_array[], index_sequence<I...>, std::true_type) {
+      static_cast<void>(arguments_array);
+      function(JSValueConverter<typename std::decay<Args>::type>::FromJSValueRef(context_ref, arguments_array[I])...);
+      return JSValueMakeUndefined(context_ref);
+    }
+  };
+
+  /*!
+   @class
+
+   @discussion Binds a pointer to member function to an instance so
+   that JSNativeFunction can invoke it like a free function.
+   */
+  template<typename T, typename M>
+  struct JSBoundMemberFunction final {
+    T& object;
+    M  member_function;
+
+    template<typename... A>
+    auto operator()(A&&... arguments) -> decltype((object.*member_function)(std::forward<A>(arguments)...)) {
+      return (object.*member_function)(std::forward<A>(arguments)...);
+    }
+  };
+
+  /*!
+   @class
+
+   @discussion True if F is a typed member function of T, i.e. it is
+   not already usable as a CallNamedFunctionCallback<T>. This keeps
+   the typed JSExport<T>::AddFunctionProperty overloads from hijacking
+   member functions written against the std::vector<JSValue>
+   signature.
+   */
+  template<typename T, typename F>
+  struct IsJSExportTypedFunction : std::integral_constant<bool, !std::is_convertible<F, CallNamedFunctionCallback<T>>::value> {
+  };
+
+  template<typename T, typename R, typename... Args>
+  CallNamedNativeFunctionCallback<T> MakeCallNamedNativeFunctionCallback(R (T::*member_function)(Args...)) {
+    return [member_function](T& object, JSContextRef context_ref, std::size_t argument_count, const JSValueRef arguments_array[]) {
+      JSBoundMemberFunction<T, R (T::*)(Args...)> function { object, member_function };
+      return JSNativeFunction<R, Args...>::Call(function, context_ref, argument_count, arguments_array);
+    };
+  }
+
+  template<typename T, typename R, typename... Args>
+  CallNamedNativeFunctionCallback<T> MakeCallNamedNativeFunctionCallback(R (T::*member_function)(Args...) const) {
+    return [member_function](T& object, JSContextRef context_ref, std::size_t argument_count, const JSValueRef arguments_array[]) {
+      JSBoundMemberFunction<const T, R (T::*)(Args...) const> function { object, member_function };
+      return JSNativeFunction<R, Args...>::Call(function, context_ref, argument_count, arguments_array);
+    };
+  }
+
+  /*!
+   @class
+
+   @discussion True if G is a typed getter of T, i.e. it is not
+   already usable as a GetNamedValuePropertyCallback<T>. This plays
+   the same role for JSExport<T>::AddValueProperty as
+   IsJSExportTypedFunction does for AddFunctionProperty.
+   */
+  template<typename T, typename G>
+  struct IsJSExportTypedGetter : std::integral_constant<bool, !std::is_convertible<G, GetNamedValuePropertyCallback<T>>::value> {
+  };
+
+  template<typename T, typename R>
+  GetNamedNativeValuePropertyCallback<T> MakeGetNamedNativeValuePropertyCallback(R (T::*get_callback)() const) {
+    static_assert(HasJSValueConverter<R>::value,
+                  "MakeGetNamedNativeValuePropertyCallback: the getter must return one of double, int32_t, uint32_t, bool, std::string, JSValue or JSObject");
+    return [get_callback](T& object, JSContextRef context_ref) {
+      return JSValueConverter<typename std::decay<R>::type>::ToJSValueRef(context_ref, (object.*get_callback)());
+    };
+  }
+
+  // A setter returning void always succeeds.
+  template<typename T, typename M, typename V>
+  bool InvokeNativeSetter(T& object, M set_callback, V&& value, std::true_type) {
+    (object.*set_callback)(std::forward<V>(value));
+    return true;
+  }
+
+  template<typename T, typename M, typename V>
+  bool InvokeNativeSetter(T& object, M set_callback, V&& value, std::false_type) {
+    return (object.*set_callback)(std::forward<V>(value));
+  }
+
+  template<typename T, typename S, typename A>
+  SetNamedNativeValuePropertyCallback<T> MakeSetNamedNativeValuePropertyCallback(S (T::*set_callback)(A)) {
+    static_assert(HasJSValueConverter<A>::value,
+                  "MakeSetNamedNativeValuePropertyCallback: the setter argument must be one of double, int32_t, uint32_t, bool, std::string, JSValue or JSObject");
+    static_assert(std::is_void<S>::value || std::is_same<S, bool>::value,
+                  "MakeSetNamedNativeValuePropertyCallback: the setter must return void or bool");
+    return [set_callback](T& object, JSContextRef context_ref, JSValueRef value_ref) {
+      return InvokeNativeSetter(object, set_callback, JSValueConverter<typename std::decay<A>::type>::FromJSValueRef(context_ref, value_ref), std::is_void<S>());
+    };
+  }
+
+  template<typename R, typename... Args>
+  JSNativeFunctionCallback MakeJSNativeFunctionCallback(std::function<R(Args...)> callback) {
+    return [callback](JSContextRef context_ref, std::size_t argument_count, const JSValueRef arguments_array[]) mutable {
+      return JSNativeFunction<R, Args...>::Call(callback, context_ref, argument_count, arguments_array);
+    };
+  }
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSNATIVEFUNCTION_HPP_
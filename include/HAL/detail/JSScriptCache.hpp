@@ -0,0 +1,61 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSSCRIPTCACHE_HPP_
+#define _HAL_DETAIL_JSSCRIPTCACHE_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+#include "HAL/JSContextGroup.hpp"
+#include "HAL/JSString.hpp"
+
+#include <cstddef>
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion JSScriptCache keeps the scripts compiled by
+   JSContext::JSEvaluateScript and JSContext::TryEvaluate so that
+   evaluating the same source again, in any context of the same
+   context group, skips parsing it.
+
+   Each context group has its own least recently used cache, which is
+   empty and disabled until it is given a capacity. Compiling a script
+   once and evaluating it many times needs the JSScriptRef API, which
+   only some JavaScriptCore builds expose (HAL_HAVE_JSSCRIPTREF).
+   Without it Evaluate always declines and the caller evaluates the
+   script as usual.
+   */
+  class HAL_EXPORT JSScriptCache final HAL_PERFORMANCE_COUNTER1(JSScriptCache) {
+
+  public:
+
+    static bool IsSupported() HAL_NOEXCEPT;
+
+    /*!
+     @method
+
+     @abstract Evaluate script with the cached compiled script of the
+     context group of context_ref, compiling and caching it on a miss.
+
+     @result false if the cache is disabled or unsupported, or script
+     has a syntax error, in which case the caller must evaluate script
+     itself. Otherwise true, and result_ref and exception are set as
+     by JSEvaluateScript.
+     */
+    static bool Evaluate(JSContextRef context_ref, const JSString& script, JSObjectRef this_object_ref, const JSString& source_url, int starting_line_number, JSValueRef* result_ref, JSValueRef* exception) HAL_NOEXCEPT;
+
+    static void SetCapacity(JSContextGroupRef context_group_ref, std::size_t capacity) HAL_NOEXCEPT;
+    static JSScriptCacheStatistics GetStatistics(JSContextGroupRef context_group_ref) HAL_NOEXCEPT;
+    static void Clear(JSContextGroupRef context_group_ref) HAL_NOEXCEPT;
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSSCRIPTCACHE_HPP_
@@ -0,0 +1,62 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSSCRIPTFILE_HPP_
+#define _HAL_DETAIL_JSSCRIPTFILE_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion JSScriptFile loads a script file for
+   JSContext::EvaluateScriptFile with as few copies of its text as
+   possible.
+
+   The file is memory mapped rather than read, and its UTF-8 is
+   transcoded straight from the mapping into one UTF-16 buffer, with a
+   fast path that widens runs of ASCII. JavaScriptCore's
+   JSStringCreateWithUTF8CString would need a terminated copy of the
+   text and transcodes into a temporary buffer of its own, so the
+   buffer is handed to JSStringCreateWithCharacters instead. Unlike a
+   JSString, the result keeps no UTF-8 copy of the text.
+   */
+  class HAL_EXPORT JSScriptFile final HAL_PERFORMANCE_COUNTER1(JSScriptFile) {
+
+  public:
+
+    /*!
+     @method
+
+     @abstract Return a new JSStringRef holding the text of the UTF-8
+     file at path, which the caller must release.
+
+     @throws std::runtime_error if the file can't be opened or mapped.
+     */
+    static JSStringRef CreateString(const std::string& path);
+
+    /*!
+     @method
+
+     @abstract Return a new JSStringRef holding the length bytes of
+     UTF-8 at utf8, which the caller must release.
+
+     @discussion A leading byte order mark is skipped, and each
+     malformed sequence becomes U+FFFD.
+     */
+    static JSStringRef CreateString(const char* utf8, std::size_t length);
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSSCRIPTFILE_HPP_
@@ -0,0 +1,66 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSTHREADPOOL_HPP_
+#define _HAL_DETAIL_JSTHREADPOOL_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion JSThreadPool runs the native half of JSEventLoop's
+   async functions. Its work never touches JavaScriptCore; results go
+   back to the event loop's thread through JSEventLoop::Post.
+
+   Post starts the threads as they are needed, up to thread_count, so
+   an event loop without async functions has none. The destructor
+   waits for the work already started and drops the rest.
+   */
+  class HAL_EXPORT JSThreadPool final HAL_PERFORMANCE_COUNTER1(JSThreadPool) {
+
+  public:
+
+    explicit JSThreadPool(std::size_t thread_count) HAL_NOEXCEPT;
+    ~JSThreadPool() HAL_NOEXCEPT;
+
+    void Post(std::function<void()> work);
+
+  private:
+
+    void Run() HAL_NOEXCEPT;
+
+    JSThreadPool(const JSThreadPool&)            = delete;
+    JSThreadPool& operator=(const JSThreadPool&) = delete;
+
+    // Silence 4251 on Windows since private member variables do not
+    // need to be exported from a DLL.
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    std::size_t                       thread_count__;
+    std::vector<std::thread>          threads__;
+    std::mutex                        mutex__;
+    std::condition_variable           work_condition__;
+    std::deque<std::function<void()>> work__;
+    bool                              stopping__ { false };
+#pragma warning(pop)
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSTHREADPOOL_HPP_
@@ -0,0 +1,174 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#ifndef _HAL_DETAIL_JSVALUECONVERTER_HPP_
+#define _HAL_DETAIL_JSVALUECONVERTER_HPP_
+
+#include "HAL/detail/JSBase.hpp"
+#include "HAL/detail/JSUtil.hpp"
+#include "HAL/JSContext.hpp"
+#include "HAL/JSValue.hpp"
+#include "HAL/JSObject.hpp"
+
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <type_traits>
+#include <cassert>
+#include <JavaScriptCore/JavaScript.h>
+
+namespace HAL { namespace detail {
+
+  /*!
+   @class
+
+   @discussion A JSValueConverter converts between a native C++ type
+   and a JavaScriptCore C API JSValueRef without constructing an
+   intermediate JSValue. This is what makes the typed native
+   function and property bindings cheap: arguments are read straight
+   out of the JSValueRef array that JavaScriptCore hands to a
+   callback, and results are created with JSValueMakeNumber,
+   JSValueMakeBoolean and friends.
+
+   Only the specializations below exist. Using any other type in a
+   typed binding is a compile-time error.
+   */
+  template<typename U>
+  struct JSValueConverter;
+
+  /*!
+   @class
+
+   @discussion Compile-time test for whether a JSValueConverter
+   exists for a type, after stripping references and cv-qualifiers.
+   */
+  template<typename U, typename = void>
+  struct HasJSValueConverter : std::false_type {
+  };
+
+  template<typename U>
+  struct HasJSValueConverter<U, decltype(static_cast<void>(sizeof(JSValueConverter<typename std::decay<U>::type>)))> : std::true_type {
+  };
+
+  template<>
+  struct JSValueConverter<double> {
+    static double FromJSValueRef(JSContextRef context_ref, JSValueRef value_ref) {
+      JSValueRef exception { nullptr };
+      const double result = JSValueToNumber(context_ref, value_ref, &exception);
+      if (exception) {
+        ThrowRuntimeError("JSValueConverter", JSValue(JSContext(context_ref), exception));
+      }
+      return result;
+    }
+
+    static JSValueRef ToJSValueRef(JSContextRef context_ref, double value) {
+      return JSValueMakeNumber(context_ref, value);
+    }
+  };
+
+  template<>
+  struct JSValueConverter<std::int32_t> {
+    static std::int32_t FromJSValueRef(JSContextRef context_ref, JSValueRef value_ref) {
+      return to_int32_t(JSValueConverter<double>::FromJSValueRef(context_ref, value_ref));
+    }
+
+    static JSValueRef ToJSValueRef(JSContextRef context_ref, std::int32_t value) {
+      return JSValueMakeNumber(context_ref, value);
+    }
+  };
+
+  template<>
+  struct JSValueConverter<std::uint32_t> {
+    static std::uint32_t FromJSValueRef(JSContextRef context_ref, JSValueRef value_ref) {
+      // As with JSValue::operator uint32_t, ToUint32 only differs
+      // from ToInt32 in how the resulting bit-pattern is interpreted.
+      return JSValueConverter<std::int32_t>::FromJSValueRef(context_ref, value_ref);
+    }
+
+    static JSValueRef ToJSValueRef(JSContextRef context_ref, std::uint32_t value) {
+      return JSValueMakeNumber(context_ref, value);
+    }
+  };
+
+  template<>
+  struct JSValueConverter<bool> {
+    static bool FromJSValueRef(JSContextRef context_ref, JSValueRef value_ref) {
+#ifdef HAL_USE_STRING_BOOLEAN_CONVERSION
+      // Keep the Java-like "true"/"false" string semantics of
+      // JSValue::operator bool.
+      if (JSValueIsString(context_ref, value_ref)) {
+        return static_cast<bool>(JSValue(JSContext(context_ref), value_ref));
+      }
+#endif
+      return JSValueToBoolean(context_ref, value_ref);
+    }
+
+    static JSValueRef ToJSValueRef(JSContextRef context_ref, bool value) {
+      return JSValueMakeBoolean(context_ref, value);
+    }
+  };
+
+  template<>
+  struct JSValueConverter<std::string> {
+    static std::string FromJSValueRef(JSContextRef context_ref, JSValueRef value_ref) {
+      JSValueRef exception { nullptr };
+      const auto js_string_ref = JSValueToStringCopy(context_ref, value_ref, &exception);
+      if (exception) {
+        assert(!js_string_ref);
+        ThrowRuntimeError("JSValueConverter", JSValue(JSContext(context_ref), exception));
+      }
+
+      std::vector<char> buffer(JSStringGetMaximumUTF8CStringSize(js_string_ref));
+      const auto size = JSStringGetUTF8CString(js_string_ref, buffer.data(), buffer.size());
+      JSStringRelease(js_string_ref);
+
+      // size includes the null terminator.
+      return size > 0 ? std::string(buffer.data(), size - 1) : std::string();
+    }
+
+    static JSValueRef ToJSValueRef(JSContextRef context_ref, const std::string& value) {
+      const auto js_string_ref = JSStringCreateWithUTF8CString(value.c_str());
+      const auto value_ref     = JSValueMakeString(context_ref, js_string_ref);
+      JSStringRelease(js_string_ref);
+      return value_ref;
+    }
+  };
+
+  template<>
+  struct JSValueConverter<JSValue> {
+    static JSValue FromJSValueRef(JSContextRef context_ref, JSValueRef value_ref) {
+      return JSValue(JSContext(context_ref), value_ref);
+    }
+
+    static JSValueRef ToJSValueRef(JSContextRef, const JSValue& value) {
+      return static_cast<JSValueRef>(value);
+    }
+  };
+
+  template<>
+  struct JSValueConverter<JSObject> {
+    static JSObject FromJSValueRef(JSContextRef context_ref, JSValueRef value_ref) {
+      JSValueRef exception { nullptr };
+      JSObjectRef js_object_ref = JSValueToObject(context_ref, value_ref, &exception);
+      if (exception) {
+        // If this assert fails then we need to JSValueUnprotect
+        // js_object_ref.
+        assert(!js_object_ref);
+        ThrowRuntimeError("JSValueConverter", JSValue(JSContext(context_ref), exception));
+      }
+      return JSObject(JSContext(context_ref), js_object_ref);
+    }
+
+    static JSValueRef ToJSValueRef(JSContextRef, const JSObject& value) {
+      return static_cast<JSObjectRef>(value);
+    }
+  };
+
+}} // namespace HAL { namespace detail {
+
+#endif // _HAL_DETAIL_JSVALUECONVERTER_HPP_
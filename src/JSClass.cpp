@@ -23,8 +23,8 @@ namespace HAL {
   }
   
   JSClass::JSClass(const JSClassDefinition& js_class_definition) HAL_NOEXCEPT
-  : name__(js_class_definition.name__)
-  , js_class_ref__(JSClassCreate(&js_class_definition.js_class_definition__)) {
+  : name__(js_class_definition.get_state().name__)
+  , js_class_ref__(JSClassCreate(&js_class_definition.get_js_class_definition())) {
     HAL_LOG_TRACE("JSClass:: ctor ", this);
     HAL_LOG_TRACE("JSClass:: retain ", js_class_ref__, " for ", this);
   }
@@ -10,64 +10,37 @@
 #include "HAL/detail/JSUtil.hpp"
 
 #include <string>
-#include <algorithm>
-#include <iterator>
+#include <memory>
+#include <utility>
 
 namespace HAL {
   
-  JSClassDefinition::JSClassDefinition() HAL_NOEXCEPT {
-    js_class_definition__ = kJSClassDefinitionEmpty;
+  JSClassDefinition::JSClassDefinition() HAL_NOEXCEPT
+  : state__(GetEmptyState()) {
   }
   
   JSClassDefinition::JSClassDefinition(const ::JSClassDefinition& js_class_definition)
-  : name__(js_class_definition.className) {
-
-    Initialize(js_class_definition);
-    
-    js_class_definition__.staticValues    = nullptr;
-    js_class_definition__.staticFunctions = nullptr;
-    
-    auto static_value_ptr = const_cast<::JSStaticValue*>(js_class_definition.staticValues);
-    while (static_value_ptr && static_value_ptr -> name) {
-      js_value_properties__.push_back(detail::JSStaticValue(*static_value_ptr));
-      ++static_value_ptr;
-    }
-    
-    auto static_function_ptr = const_cast<::JSStaticFunction*>(js_class_definition.staticFunctions);
-    while (static_function_ptr && static_function_ptr -> name) {
-      js_function_properties__.push_back(detail::JSStaticFunction(*static_function_ptr));
-      ++static_function_ptr;
-    }
-    
-    InitializePropertyCallbacks();
+  : state__(CreateState(js_class_definition)) {
+  }
+  
+  JSClassDefinition::JSClassDefinition(std::shared_ptr<const State> state) HAL_NOEXCEPT
+  : state__(std::move(state)) {
   }
   
   JSClassDefinition::~JSClassDefinition() HAL_NOEXCEPT {
   }
   
   JSClassDefinition::JSClassDefinition(const JSClassDefinition& rhs) HAL_NOEXCEPT
-  : name__(rhs.name__)
-  , js_value_properties__(rhs.js_value_properties__)
-  , js_function_properties__(rhs.js_function_properties__) {
-    Initialize(rhs.js_class_definition__);
-    InitializePropertyCallbacks();
+  : state__(rhs.state__) {
   }
   
   JSClassDefinition::JSClassDefinition(JSClassDefinition&& rhs) HAL_NOEXCEPT
-  : name__(std::move(rhs.name__))
-  , js_value_properties__(std::move(rhs.js_value_properties__))
-  , js_function_properties__(std::move(rhs.js_function_properties__)) {
-    Initialize(rhs.js_class_definition__);
-    InitializePropertyCallbacks();
+  : state__(rhs.state__) {
   }
   
   JSClassDefinition& JSClassDefinition::operator=(const JSClassDefinition& rhs) HAL_NOEXCEPT {
     HAL_JSCLASSDEFINITION_LOCK_GUARD;
-    name__                   = rhs.name__;
-    js_value_properties__    = rhs.js_value_properties__;
-    js_function_properties__ = rhs.js_function_properties__;
-    Initialize(rhs.js_class_definition__);
-    InitializePropertyCallbacks();
+    state__ = rhs.state__;
     return *this;
   }
   
@@ -81,90 +54,95 @@ namespace HAL {
     HAL_JSCLASSDEFINITION_LOCK_GUARD;
     using std::swap;
     
-    swap(name__                  , other.name__);
-    swap(js_value_properties__   , other.js_value_properties__);
-    swap(js_function_properties__, other.js_function_properties__);
-    swap(static_values__         , other.static_values__);
-    swap(static_functions__      , other.static_functions__);
-    swap(js_class_definition__   , other.js_class_definition__);
+    swap(state__, other.state__);
   }
   
-  void JSClassDefinition::Initialize(const ::JSClassDefinition& other) HAL_NOEXCEPT {
-    js_class_definition__.version           = other.version;
-    js_class_definition__.attributes        = other.attributes;
+  std::shared_ptr<const JSClassDefinition::State> JSClassDefinition::GetEmptyState() HAL_NOEXCEPT {
+    static const std::shared_ptr<const State> empty_state = [] {
+      auto state = std::make_shared<State>();
+      state -> js_class_definition__ = kJSClassDefinitionEmpty;
+      return state;
+    }();
+    return empty_state;
+  }
+  
+  std::shared_ptr<const JSClassDefinition::State> JSClassDefinition::CreateState(const ::JSClassDefinition& js_class_definition) {
     
-    js_class_definition__.className         = other.className;
-    js_class_definition__.parentClass       = other.parentClass;
+    // The state also owns the property names that static_values__
+    // and static_functions__ point to.
+    struct StaticState : State {
+      std::vector<detail::JSStaticValue>    js_value_properties__;
+      std::vector<detail::JSStaticFunction> js_function_properties__;
+      std::vector<std::string>              property_names__;
+    };
     
-    // staticValues and staticFunctions are handled separately by
-    // InitializePropertyCallbacks.
+    auto state = std::make_shared<StaticState>();
+    state -> name__                = js_class_definition.className;
+    state -> js_class_definition__ = js_class_definition;
+    state -> js_class_definition__.className       = state -> name__.c_str();
+    state -> js_class_definition__.staticValues    = nullptr;
+    state -> js_class_definition__.staticFunctions = nullptr;
     
-    js_class_definition__.initialize        = other.initialize;
-    js_class_definition__.finalize          = other.finalize;
-    js_class_definition__.hasProperty       = other.hasProperty;
-    js_class_definition__.getProperty       = other.getProperty;
-    js_class_definition__.setProperty       = other.setProperty;
-    js_class_definition__.deleteProperty    = other.deleteProperty;
-    js_class_definition__.getPropertyNames  = other.getPropertyNames;
-    js_class_definition__.callAsFunction    = other.callAsFunction;
-    js_class_definition__.callAsConstructor = other.callAsConstructor;
-    js_class_definition__.hasInstance       = other.hasInstance;
-    js_class_definition__.convertToType     = other.convertToType;
-  }
-  
-  void JSClassDefinition::InitializePropertyCallbacks() HAL_NOEXCEPT {
-    HAL_JSCLASSDEFINITION_LOCK_GUARD;
+    auto static_value_ptr = js_class_definition.staticValues;
+    while (static_value_ptr && static_value_ptr -> name) {
+      state -> js_value_properties__.push_back(detail::JSStaticValue(*static_value_ptr));
+      state -> property_names__.push_back(static_value_ptr -> name);
+      ++static_value_ptr;
+    }
     
-    js_class_definition__.staticValues = nullptr;
-    static_values__.clear();
-    if (!js_value_properties__.empty()) {
-      std::transform(js_value_properties__.begin(),
-                     js_value_properties__.end(),
-                     std::back_inserter(static_values__),
-                     [](detail::JSStaticValue js_value_property) {
-                       ::JSStaticValue static_value;
-                       static_value.name        = js_value_property.get_name().c_str();
-                       static_value.getProperty = js_value_property.get_callback();
-                       static_value.setProperty = js_value_property.set_callback();
-                       static_value.attributes  = detail::ToJSPropertyAttributes(js_value_property.get_attributes());
-                       return static_value;
-                     });
+    auto static_function_ptr = js_class_definition.staticFunctions;
+    while (static_function_ptr && static_function_ptr -> name) {
+      state -> js_function_properties__.push_back(detail::JSStaticFunction(*static_function_ptr));
+      state -> property_names__.push_back(static_function_ptr -> name);
+      ++static_function_ptr;
+    }
+    
+    // property_names__ no longer grows, so it is now safe to point
+    // into it.
+    auto property_name_position = state -> property_names__.begin();
+    
+    if (!state -> js_value_properties__.empty()) {
+      for (const auto& js_value_property : state -> js_value_properties__) {
+        ::JSStaticValue static_value;
+        static_value.name        = (property_name_position++) -> c_str();
+        static_value.getProperty = js_value_property.get_callback();
+        static_value.setProperty = js_value_property.set_callback();
+        static_value.attributes  = detail::ToJSPropertyAttributes(js_value_property.get_attributes());
+        state -> static_values__.push_back(static_value);
+      }
       
-      HAL_LOG_DEBUG("JSClassDefinition<", name__, "> added value property ", static_values__.back().name);
-      static_values__.push_back({nullptr, nullptr, nullptr, kJSPropertyAttributeNone});
-      js_class_definition__.staticValues = &static_values__[0];
+      HAL_LOG_DEBUG("JSClassDefinition<", state -> name__, "> added value property ", state -> static_values__.back().name);
+      state -> static_values__.push_back({nullptr, nullptr, nullptr, kJSPropertyAttributeNone});
+      state -> js_class_definition__.staticValues = &state -> static_values__[0];
     }
     
-    js_class_definition__.staticFunctions = nullptr;
-    static_functions__.clear();
-    if (!js_function_properties__.empty()) {
-      std::transform(js_function_properties__.begin(),
-                     js_function_properties__.end(),
-                     std::back_inserter(static_functions__),
-                     [](detail::JSStaticFunction js_function_property) {
-                       ::JSStaticFunction static_function;
-                       static_function.name           = js_function_property.get_name().c_str();
-                       static_function.callAsFunction = js_function_property.function_callback();
-                       static_function.attributes     = detail::ToJSPropertyAttributes(js_function_property.get_attributes());
-                       return static_function;
-                     });
+    if (!state -> js_function_properties__.empty()) {
+      for (const auto& js_function_property : state -> js_function_properties__) {
+        ::JSStaticFunction static_function;
+        static_function.name           = (property_name_position++) -> c_str();
+        static_function.callAsFunction = js_function_property.function_callback();
+        static_function.attributes     = detail::ToJSPropertyAttributes(js_function_property.get_attributes());
+        state -> static_functions__.push_back(static_function);
+      }
       
-      HAL_LOG_DEBUG("JSClassDefinition<", name__, "> added function property ", static_functions__.back().name);
-      static_functions__.push_back({nullptr, nullptr, kJSPropertyAttributeNone});
-      js_class_definition__.staticFunctions = &static_functions__[0];
+      HAL_LOG_DEBUG("JSClassDefinition<", state -> name__, "> added function property ", state -> static_functions__.back().name);
+      state -> static_functions__.push_back({nullptr, nullptr, kJSPropertyAttributeNone});
+      state -> js_class_definition__.staticFunctions = &state -> static_functions__[0];
     }
+    
+    return state;
   }
   
   std::string JSClassDefinition::get_name() const HAL_NOEXCEPT {
-    return name__;
+    return state__ -> name__;
   }
   
   std::uint32_t JSClassDefinition::get_version() const HAL_NOEXCEPT {
-    return js_class_definition__.version;
+    return state__ -> js_class_definition__.version;
   }
   
   void JSClassDefinition::Print() HAL_NOEXCEPT {
-    Print(js_class_definition__);
+    Print(state__ -> js_class_definition__);
   }
   
   void JSClassDefinition::Print(const ::JSClassDefinition& js_class_definition) HAL_NOEXCEPT {
@@ -23,8 +23,13 @@
 #include "HAL/JSError.hpp"
 #include "HAL/JSFunction.hpp"
 #include "HAL/JSRegExp.hpp"
+#include "HAL/JSResult.hpp"
 
 #include "HAL/detail/JSUtil.hpp"
+#include "HAL/detail/JSContextHandles.hpp"
+#include "HAL/detail/JSFunctionCache.hpp"
+#include "HAL/detail/JSScriptCache.hpp"
+#include "HAL/detail/JSScriptFile.hpp"
 
 #include <cassert>
 
@@ -32,22 +37,22 @@ namespace HAL {
   
   JSObject JSContext::get_global_object() const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSObject(JSContext(js_global_context_ref__), JSContextGetGlobalObject(js_global_context_ref__));
+    return JSObject(*this, JSContextGetGlobalObject(js_global_context_ref__));
   }
   
   JSValue JSContext::CreateValueFromJSON(const JSString& js_string) const {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSValue(JSContext(js_global_context_ref__), js_string, true);
+    return JSValue(*this, js_string, true);
   }
   
   JSValue JSContext::CreateString() const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSValue(JSContext(js_global_context_ref__), JSString(), false);
+    return JSValue(*this, JSString(), false);
   }
   
   JSValue JSContext::CreateString(const JSString& js_string) const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSValue(JSContext(js_global_context_ref__), js_string, false);
+    return JSValue(*this, js_string, false);
   }
   
   JSValue JSContext::CreateString(const char* string) const HAL_NOEXCEPT {
@@ -60,40 +65,40 @@ namespace HAL {
   
   JSUndefined JSContext::CreateUndefined() const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSUndefined(JSContext(js_global_context_ref__));
+    return JSUndefined(*this);
   }
   
   JSNull JSContext::CreateNull() const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSNull(JSContext(js_global_context_ref__));
+    return JSNull(*this);
   }
 	
   JSValue JSContext::CreateNativeNull() const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
     // Use JSNull to represent native nullptr
-    auto value = JSNull(JSContext(js_global_context_ref__));
+    auto value = JSNull(*this);
     value.MarkAsNativeNull();
     return value;
   }
 	
   JSBoolean JSContext::CreateBoolean(bool boolean) const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSBoolean(JSContext(js_global_context_ref__), boolean);
+    return JSBoolean(*this, boolean);
   }
   
   JSNumber JSContext::CreateNumber(double number) const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSNumber(JSContext(js_global_context_ref__), number);
+    return JSNumber(*this, number);
   }
   
   JSNumber JSContext::CreateNumber(int32_t number) const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSNumber(JSContext(js_global_context_ref__), number);
+    return JSNumber(*this, number);
   }
   
   JSNumber JSContext::CreateNumber(uint32_t number) const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSNumber(JSContext(js_global_context_ref__), number);
+    return JSNumber(*this, number);
   }
   
   JSObject JSContext::CreateObject() const HAL_NOEXCEPT {
@@ -102,7 +107,7 @@ namespace HAL {
   
   JSObject JSContext::CreateObject(const JSClass& js_class) const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSObject(JSContext(js_global_context_ref__), js_class);
+    return JSObject(*this, js_class);
   }
 
   JSObject JSContext::CreateObject(const std::unordered_map<std::string, JSValue>& properties) const HAL_NOEXCEPT {
@@ -121,42 +126,42 @@ namespace HAL {
   
   JSArray JSContext::CreateArray() const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSArray(JSContext(js_global_context_ref__));
+    return JSArray(*this);
   }
   
   JSArray JSContext::CreateArray(const std::vector<JSValue>& arguments) const {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSArray(JSContext(js_global_context_ref__), arguments);
+    return JSArray(*this, arguments);
   }
   
   JSDate JSContext::CreateDate() const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSDate(JSContext(js_global_context_ref__));
+    return JSDate(*this);
   }
   
   JSDate JSContext::CreateDate(const std::vector<JSValue>& arguments) const {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSDate(JSContext(js_global_context_ref__), arguments);
+    return JSDate(*this, arguments);
   }
   
   JSError JSContext::CreateError() const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSError(JSContext(js_global_context_ref__));
+    return JSError(*this);
   }
   
   JSError JSContext::CreateError(const std::vector<JSValue>& arguments) const {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSError(JSContext(js_global_context_ref__), arguments);
+    return JSError(*this, arguments);
   }
   
   JSRegExp JSContext::CreateRegExp() const HAL_NOEXCEPT {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSRegExp(JSContext(js_global_context_ref__));
+    return JSRegExp(*this);
   }
   
   JSRegExp JSContext::CreateRegExp(const std::vector<JSValue>& arguments) const {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSRegExp(JSContext(js_global_context_ref__), arguments);
+    return JSRegExp(*this, arguments);
   }
   
   JSFunction JSContext::CreateFunction(const JSString& body) const {
@@ -173,21 +178,33 @@ namespace HAL {
   
   JSFunction JSContext::CreateFunction(const JSString& body, const std::vector<JSString>& parameter_names, const JSString& function_name, const JSString& source_url, int starting_line_number) const {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSFunction(JSContext(js_global_context_ref__), body, parameter_names, function_name, source_url, starting_line_number);
+    return JSFunction(*this, body, parameter_names, function_name, source_url, starting_line_number);
   }
 
   JSFunction JSContext::CreateFunction() const {
-    JSFunctionCallback noop = [](const std::vector<JSValue>, JSObject& this_object){ return this_object.get_context().CreateUndefined(); };
-    return CreateFunction(noop);
+    HAL_JSCONTEXT_LOCK_GUARD;
+    return JSFunction(*this, JSString());
   }
 
+  void JSContext::SetFunctionCacheCapacity(std::size_t capacity) const HAL_NOEXCEPT {
+    detail::JSFunctionCache::SetCapacity(js_global_context_ref__, capacity);
+  }
+  
+  JSFunctionCacheStatistics JSContext::GetFunctionCacheStatistics() const HAL_NOEXCEPT {
+    return detail::JSFunctionCache::GetStatistics(js_global_context_ref__);
+  }
+  
+  void JSContext::InvalidateFunctionCache() const HAL_NOEXCEPT {
+    detail::JSFunctionCache::Invalidate(js_global_context_ref__);
+  }
+  
   JSFunction JSContext::CreateFunction(JSFunctionCallback& callback) const {
     return CreateFunction(JSString(), callback);
   }
 
   JSFunction JSContext::CreateFunction(const JSString& function_name, JSFunctionCallback& callback) const {
     HAL_JSCONTEXT_LOCK_GUARD;
-    return JSFunction(JSContext(js_global_context_ref__), function_name, callback);
+    return JSFunction(*this, function_name, callback);
   }
   
   JSValue JSContext::JSEvaluateScript(const JSString& script) const {
@@ -208,16 +225,65 @@ namespace HAL {
     JSValueRef js_value_ref { nullptr };
     const JSStringRef source_url_ref = (source_url.length() > 0) ? static_cast<JSStringRef>(source_url) : nullptr;
     JSValueRef exception { nullptr };
-    js_value_ref = ::JSEvaluateScript(js_global_context_ref__, static_cast<JSStringRef>(script), static_cast<JSObjectRef>(this_object), source_url_ref, starting_line_number, &exception);
+    if (!detail::JSScriptCache::Evaluate(js_global_context_ref__, script, static_cast<JSObjectRef>(this_object), source_url, starting_line_number, &js_value_ref, &exception)) {
+      js_value_ref = ::JSEvaluateScript(js_global_context_ref__, static_cast<JSStringRef>(script), static_cast<JSObjectRef>(this_object), source_url_ref, starting_line_number, &exception);
+    }
     
     if (exception) {
       // If this assert fails then we need to JSValueUnprotect
       // js_value_ref.
       assert(!js_value_ref);
-      detail::ThrowRuntimeError("JSContext", JSValue(JSContext(js_global_context_ref__), exception), source_url, starting_line_number);
+      detail::ThrowRuntimeError("JSContext", JSValue(*this, exception), source_url, starting_line_number);
     }
     
-    return JSValue(JSContext(js_global_context_ref__), js_value_ref);
+    return JSValue(*this, js_value_ref);
+  }
+  
+  JSResult JSContext::TryEvaluate(const JSString& script) const HAL_NOEXCEPT {
+    return TryEvaluate(script, get_global_object(), JSString());
+  }
+  
+  JSResult JSContext::TryEvaluate(const JSString& script, const JSString& source_url, int starting_line_number) const HAL_NOEXCEPT {
+    return TryEvaluate(script, get_global_object(), source_url, starting_line_number);
+  }
+  
+  JSResult JSContext::TryEvaluate(const JSString& script, JSObject this_object) const HAL_NOEXCEPT {
+    return TryEvaluate(script, this_object, JSString());
+  }
+  
+  JSResult JSContext::TryEvaluate(const JSString& script, JSObject this_object, const JSString& source_url, int starting_line_number) const HAL_NOEXCEPT {
+    HAL_JSCONTEXT_LOCK_GUARD;
+    const JSStringRef source_url_ref = (source_url.length() > 0) ? static_cast<JSStringRef>(source_url) : nullptr;
+    JSValueRef js_value_ref { nullptr };
+    JSValueRef exception { nullptr };
+    if (!detail::JSScriptCache::Evaluate(js_global_context_ref__, script, static_cast<JSObjectRef>(this_object), source_url, starting_line_number, &js_value_ref, &exception)) {
+      js_value_ref = ::JSEvaluateScript(js_global_context_ref__, static_cast<JSStringRef>(script), static_cast<JSObjectRef>(this_object), source_url_ref, starting_line_number, &exception);
+    }
+    
+    if (exception) {
+      return JSResult::Exception(*this, exception, "JSContext", source_url, starting_line_number);
+    }
+    
+    return JSResult::Value(*this, js_value_ref);
+  }
+  
+  JSValue JSContext::EvaluateScriptFile(const std::string& path) const {
+    return EvaluateScriptFile(path, get_global_object());
+  }
+  
+  JSValue JSContext::EvaluateScriptFile(const std::string& path, JSObject this_object) const {
+    HAL_JSCONTEXT_LOCK_GUARD;
+    const JSString source_url(path);
+    const JSStringRef script_ref = detail::JSScriptFile::CreateString(path);
+    JSValueRef exception { nullptr };
+    const auto js_value_ref = ::JSEvaluateScript(js_global_context_ref__, script_ref, static_cast<JSObjectRef>(this_object), static_cast<JSStringRef>(source_url), 1, &exception);
+    JSStringRelease(script_ref);
+    
+    if (exception) {
+      detail::ThrowRuntimeError("JSContext", JSValue(*this, exception), path, 1);
+    }
+    
+    return JSValue(*this, js_value_ref);
   }
   
   bool JSContext::JSCheckScriptSyntax(const JSString& script) const HAL_NOEXCEPT {
@@ -231,7 +297,7 @@ namespace HAL {
     bool result = ::JSCheckScriptSyntax(js_global_context_ref__, static_cast<JSStringRef>(script), source_url_ref, starting_line_number, &exception);
     
     if (exception) {
-      detail::ThrowRuntimeError("JSContext", JSValue(JSContext(js_global_context_ref__), exception));
+      detail::ThrowRuntimeError("JSContext", JSValue(*this, exception));
     }
     
     return result;
@@ -260,6 +326,7 @@ namespace HAL {
   JSContext::~JSContext() HAL_NOEXCEPT {
     HAL_LOG_TRACE("JSContext:: dtor ", this);
 #ifndef HAL_USE_SINGLE_CONTEXT
+    detail::JSContextHandles::Release(js_context_handles__);
     HAL_LOG_TRACE("JSContext:: release ", js_global_context_ref__, " for ", this);
     JSGlobalContextRelease(js_global_context_ref__);
 #endif
@@ -267,21 +334,25 @@ namespace HAL {
   
   JSContext::JSContext(const JSContext& rhs) HAL_NOEXCEPT
   : js_context_group__(rhs.js_context_group__)
-  , js_global_context_ref__(rhs.js_global_context_ref__) {
+  , js_global_context_ref__(rhs.js_global_context_ref__)
+  , js_context_handles__(rhs.js_context_handles__) {
     HAL_LOG_TRACE("JSContext:: copy ctor ", this);
 #ifndef HAL_USE_SINGLE_CONTEXT
     HAL_LOG_TRACE("JSContext:: retain ", js_global_context_ref__, " for ", this);
     JSGlobalContextRetain(js_global_context_ref__);
+    detail::JSContextHandles::Retain(js_context_handles__);
 #endif
   }
   
   JSContext::JSContext(JSContext&& rhs) HAL_NOEXCEPT
   : js_context_group__(std::move(rhs.js_context_group__))
-  , js_global_context_ref__(rhs.js_global_context_ref__) {
+  , js_global_context_ref__(rhs.js_global_context_ref__)
+  , js_context_handles__(rhs.js_context_handles__) {
     HAL_LOG_TRACE("JSContext:: move ctor ", this);
 #ifndef HAL_USE_SINGLE_CONTEXT
     HAL_LOG_TRACE("JSContext:: retain ", js_global_context_ref__, " for ", this);
     JSGlobalContextRetain(js_global_context_ref__);
+    detail::JSContextHandles::Retain(js_context_handles__);
 #endif
   }
   
@@ -301,6 +372,7 @@ namespace HAL {
     // effectively swapped.
     swap(js_context_group__     , other.js_context_group__);
     swap(js_global_context_ref__, other.js_global_context_ref__);
+    swap(js_context_handles__   , other.js_context_handles__);
   }
   
   JSContext::JSContext(const JSContextGroup& js_context_group, const JSClass& global_object_class) HAL_NOEXCEPT
@@ -308,6 +380,9 @@ namespace HAL {
   , js_global_context_ref__(JSGlobalContextCreateInGroup(static_cast<JSContextGroupRef>(js_context_group), static_cast<JSClassRef>(global_object_class))) {
     HAL_LOG_TRACE("JSContext:: ctor 1 ", this);
     HAL_LOG_TRACE("JSContext:: retain ", js_global_context_ref__, " (implicit) for ", this);
+#ifndef HAL_USE_SINGLE_CONTEXT
+    js_context_handles__ = detail::JSContextHandles::Acquire(js_global_context_ref__);
+#endif
   }
   
   JSContext::JSContext(JSContextRef js_context_ref) HAL_NOEXCEPT
@@ -323,6 +398,7 @@ namespace HAL {
 #ifndef HAL_USE_SINGLE_CONTEXT
     HAL_LOG_TRACE("JSContext:: retain ", js_global_context_ref__, " for ", this);
     JSGlobalContextRetain(js_global_context_ref__);
+    js_context_handles__ = detail::JSContextHandles::Acquire(js_global_context_ref__);
 #endif
   }
   
@@ -10,6 +10,8 @@
 #include "HAL/JSContext.hpp"
 #include "HAL/JSClass.hpp"
 #include "HAL/JSError.hpp"
+#include "HAL/detail/JSExportFinalizerQueue.hpp"
+#include "HAL/detail/JSScriptCache.hpp"
 
 #include <cassert>
 
@@ -31,6 +33,26 @@ namespace HAL {
     return JSContext(*this, global_object_class);
   }
   
+  std::size_t JSContextGroup::DrainFinalizers() {
+    return detail::JSExportFinalizerQueue::Drain();
+  }
+  
+  bool JSContextGroup::IsScriptCacheSupported() HAL_NOEXCEPT {
+    return detail::JSScriptCache::IsSupported();
+  }
+  
+  void JSContextGroup::SetScriptCacheCapacity(std::size_t capacity) const HAL_NOEXCEPT {
+    detail::JSScriptCache::SetCapacity(js_context_group_ref__, capacity);
+  }
+  
+  JSScriptCacheStatistics JSContextGroup::GetScriptCacheStatistics() const HAL_NOEXCEPT {
+    return detail::JSScriptCache::GetStatistics(js_context_group_ref__);
+  }
+  
+  void JSContextGroup::ClearScriptCache() const HAL_NOEXCEPT {
+    detail::JSScriptCache::Clear(js_context_group_ref__);
+  }
+  
   JSContextGroup::JSContextGroup(JSContextGroupRef js_context_group_ref) HAL_NOEXCEPT
   : js_context_group_ref__(js_context_group_ref) {
     HAL_LOG_TRACE("JSContextGroup:: ctor 2 ", this);
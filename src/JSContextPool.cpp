@@ -0,0 +1,157 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/JSContextPool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+
+namespace HAL {
+
+  JSContext& JSContextPool::Lease::get_context() const HAL_NOEXCEPT {
+    assert(js_context_pool__);
+    return js_context_pool__ -> entries__[index__].js_context;
+  }
+
+  void JSContextPool::Lease::Release() HAL_NOEXCEPT {
+    if (js_context_pool__) {
+      js_context_pool__ -> Return(index__, retire__);
+      js_context_pool__ = nullptr;
+      retire__          = false;
+    }
+  }
+
+  JSContextPool::JSContextPool(const JSContextGroup& js_context_group, std::size_t size, JSContextPoolCallback initializer, JSContextPoolCallback reset, std::size_t max_use_count)
+  : js_context_group__(js_context_group)
+  , initializer__(initializer)
+  , reset__(reset)
+  , max_use_count__(max_use_count)
+  , creation_time__(std::chrono::steady_clock::now()) {
+    entries__.reserve(size);
+    idle_indices__.reserve(size);
+    for (std::size_t index = 0; index < size; ++index) {
+      entries__.push_back(Entry { CreateContext(), 0, creation_time__ });
+      // Hand out the first context first.
+      idle_indices__.push_back(size - 1 - index);
+    }
+    statistics__.size = size;
+  }
+
+  JSContextPool::~JSContextPool() HAL_NOEXCEPT {
+    assert(idle_indices__.size() == entries__.size());
+  }
+
+  JSContextPool::Lease JSContextPool::Acquire() {
+    return Acquire(nullptr);
+  }
+
+  JSContextPool::Lease JSContextPool::TryAcquire(std::chrono::milliseconds timeout) {
+    return Acquire(&timeout);
+  }
+
+  JSContextPool::Lease JSContextPool::Acquire(const std::chrono::milliseconds* timeout) {
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex__);
+
+    if (idle_indices__.empty()) {
+      ++statistics__.wait_count;
+      const auto is_idle = [this] { return !idle_indices__.empty(); };
+      if (timeout == nullptr) {
+        idle_condition__.wait(lock, is_idle);
+      } else if (!idle_condition__.wait_for(lock, *timeout, is_idle)) {
+        ++statistics__.timeout_count;
+        return Lease();
+      }
+    }
+
+    const auto now       = std::chrono::steady_clock::now();
+    const auto wait_time = std::chrono::duration_cast<std::chrono::microseconds>(now - start);
+    ++statistics__.acquire_count;
+    statistics__.total_wait_time += wait_time;
+    statistics__.max_wait_time    = std::max(statistics__.max_wait_time, wait_time);
+    statistics__.peak_in_use      = std::max(statistics__.peak_in_use, entries__.size() - idle_indices__.size() + 1);
+
+    const auto index = idle_indices__.back();
+    idle_indices__.pop_back();
+    auto& entry = entries__[index];
+    ++entry.use_count;
+    entry.lease_time = now;
+    return Lease(this, index);
+  }
+
+  void JSContextPool::Return(std::size_t index, bool retire) HAL_NOEXCEPT {
+    // Only this lease's thread touches the entry until it is idle
+    // again, so the callbacks run without holding the mutex.
+    auto& entry = entries__[index];
+    bool recycle = retire || (max_use_count__ > 0 && entry.use_count >= max_use_count__);
+
+    if (!recycle && reset__) {
+      try {
+        reset__(entry.js_context);
+      } catch (...) {
+        recycle = true;
+      }
+    }
+
+    if (recycle) {
+      try {
+        entry.js_context = CreateContext();
+        entry.use_count  = 0;
+      } catch (const std::exception& e) {
+        HAL_LOG_ERROR("JSContextPool: initializer threw ", e.what(), ", keeping the old context");
+      } catch (...) {
+        HAL_LOG_ERROR("JSContextPool: initializer threw unknown exception, keeping the old context");
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex__);
+      busy_time__ += std::chrono::steady_clock::now() - entry.lease_time;
+      if (recycle) {
+        ++statistics__.retire_count;
+      }
+      idle_indices__.push_back(index);
+    }
+    idle_condition__.notify_one();
+  }
+
+  JSContextPoolStatistics JSContextPool::GetStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex__);
+    const auto now = std::chrono::steady_clock::now();
+    auto statistics = statistics__;
+    statistics.in_use = entries__.size() - idle_indices__.size();
+
+    // Count the time of the current leases so far, too.
+    auto busy_time = busy_time__;
+    std::vector<bool> is_idle(entries__.size(), false);
+    for (const auto index : idle_indices__) {
+      is_idle[index] = true;
+    }
+    for (std::size_t index = 0; index < entries__.size(); ++index) {
+      if (!is_idle[index]) {
+        busy_time += now - entries__[index].lease_time;
+      }
+    }
+
+    const auto pool_time = (now - creation_time__) * entries__.size();
+    if (pool_time.count() > 0) {
+      statistics.utilization = std::chrono::duration<double>(busy_time).count() / std::chrono::duration<double>(pool_time).count();
+    }
+    return statistics;
+  }
+
+  JSContext JSContextPool::CreateContext() const {
+    auto js_context = js_context_group__.CreateContext();
+    if (initializer__) {
+      initializer__(js_context);
+    }
+    return js_context;
+  }
+
+} // namespace HAL {
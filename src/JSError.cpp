@@ -74,9 +74,13 @@ std::string JSError::nativeStack() const {
 }
 
 std::string JSError::GetNativeStack() {
+	return GetNativeStack(JSError::NativeStack__);
+}
+
+std::string JSError::GetNativeStack(const std::deque<std::string>& native_stack) {
 	std::ostringstream stacktrace;
-	for (auto iter = JSError::NativeStack__.rbegin(); iter != JSError::NativeStack__.rend(); ++iter) {
-		stacktrace << (std::distance(JSError::NativeStack__.rbegin(), iter) + 1) << "  " << *iter << "\n";
+	for (auto iter = native_stack.rbegin(); iter != native_stack.rend(); ++iter) {
+		stacktrace << (std::distance(native_stack.rbegin(), iter) + 1) << "  " << *iter << "\n";
 	}
 	return stacktrace.str();
 }
@@ -0,0 +1,505 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/JSEventLoop.hpp"
+#include "HAL/JSString.hpp"
+#include "HAL/JSValue.hpp"
+#include "HAL/JSNumber.hpp"
+#include "HAL/JSUndefined.hpp"
+#include "HAL/JSObject.hpp"
+#include "HAL/JSFunction.hpp"
+#include "HAL/JSError.hpp"
+#include "HAL/JSContextSlot.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace HAL {
+
+  namespace {
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Timer {
+      JSObject                  callback;
+      std::vector<JSValue>      arguments;
+      std::chrono::milliseconds interval;
+      bool                      repeats;
+      // The sequence number of the timer's entry in the heap, so that
+      // entries left behind by clearTimeout are recognized.
+      std::uint64_t             sequence;
+    };
+
+    struct TimerEntry {
+      Clock::time_point due;
+      std::uint64_t     sequence;
+      std::uint32_t     id;
+
+      bool operator>(const TimerEntry& rhs) const {
+        return due > rhs.due || (due == rhs.due && sequence > rhs.sequence);
+      }
+    };
+
+    struct Task {
+      JSEventLoopTask   task;
+      Clock::time_point posted;
+    };
+
+    // The resolve and reject functions of a Promise returned by an
+    // async function.
+    struct Deferred {
+      JSObject resolve;
+      JSObject reject;
+    };
+
+    JSObject MakeError(const JSContext& js_context, const std::string& message) {
+      auto js_error = js_context.CreateError();
+      js_error.SetProperty("message", js_context.CreateString(message));
+      return js_error;
+    }
+
+  } // namespace {
+
+  struct JSEventLoop::State {
+    explicit State(const JSContext& js_context)
+    : js_context(js_context) {
+    }
+
+    JSContext                    js_context;
+    mutable std::mutex           mutex;
+    std::condition_variable      condition;
+    std::deque<Task>             tasks;
+    std::unordered_map<std::uint32_t, Timer> timers;
+    std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>> timer_heap;
+    std::uint32_t                next_timer_id { 1 };
+    std::uint64_t                next_sequence { 0 };
+    bool                         stop_requested { false };
+    JSEventLoopStatistics        statistics;
+    // Only created and settled on the loop's thread.
+    std::unordered_map<std::uint64_t, Deferred> deferreds;
+    std::uint64_t                next_deferred_id { 0 };
+    // Cleared when the JSEventLoop starts being destroyed.
+    detail::JSThreadPool*        thread_pool_ptr { nullptr };
+
+    void PostTask(JSEventLoopTask task) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(Task { std::move(task), Clock::now() });
+      }
+      condition.notify_one();
+    }
+
+    // Create a Promise and remember its resolve and reject functions
+    // under the returned id.
+    std::pair<std::uint64_t, JSObject> MakeDeferred() {
+#ifdef HAL_HAVE_JSOBJECTMAKEDEFERREDPROMISE
+      JSObjectRef resolve_ref { nullptr };
+      JSObjectRef reject_ref  { nullptr };
+      JSValueRef  exception   { nullptr };
+      const auto context_ref = static_cast<JSContextRef>(js_context);
+      const auto promise_ref = JSObjectMakeDeferredPromise(context_ref, &resolve_ref, &reject_ref, &exception);
+      if (exception) {
+        detail::ThrowRuntimeError("JSEventLoop", JSValue(js_context, exception));
+      }
+      const JSObject promise(js_context, promise_ref);
+      Deferred deferred { JSObject(js_context, resolve_ref), JSObject(js_context, reject_ref) };
+#else
+      // Without JSObjectMakeDeferredPromise, capture the functions
+      // with a Promise constructed in JavaScript.
+      static JSContextSlot<JSValue> make_deferred_slot;
+      if (!make_deferred_slot.Has(js_context)) {
+        make_deferred_slot.Set(js_context, js_context.CreateFunction("var deferred = {}; deferred.promise = new Promise(function(resolve, reject) { deferred.resolve = resolve; deferred.reject = reject; }); return deferred;"));
+      }
+      auto make_deferred = static_cast<JSObject>(make_deferred_slot.Get(js_context));
+      const auto deferred_object = static_cast<JSObject>(make_deferred(js_context.get_global_object()));
+      const auto promise = static_cast<JSObject>(deferred_object.GetProperty("promise"));
+      Deferred deferred { static_cast<JSObject>(deferred_object.GetProperty("resolve")), static_cast<JSObject>(deferred_object.GetProperty("reject")) };
+#endif
+      std::lock_guard<std::mutex> lock(mutex);
+      const auto id = next_deferred_id++;
+      deferreds.emplace(id, std::move(deferred));
+      return std::make_pair(id, promise);
+    }
+
+    // Settle the Promise of deferred id, on the loop's thread.
+    void Settle(std::uint64_t id, const JSAsyncResult& result, const std::string& error_message) {
+      std::unique_lock<std::mutex> lock(mutex);
+      const auto position = deferreds.find(id);
+      if (position == deferreds.end()) {
+        return;
+      }
+      auto deferred = position -> second;
+      deferreds.erase(position);
+      lock.unlock();
+
+      const auto global_object = js_context.get_global_object();
+      if (!result) {
+        deferred.reject(std::vector<JSValue> { MakeError(js_context, error_message) }, global_object);
+        return;
+      }
+
+      std::vector<JSValue> arguments;
+      try {
+        arguments.push_back(result(js_context));
+      } catch (const std::exception& e) {
+        deferred.reject(std::vector<JSValue> { MakeError(js_context, e.what()) }, global_object);
+        return;
+      }
+      deferred.resolve(arguments, global_object);
+    }
+
+    // Pop the heap entries of cleared timers. The mutex must be held.
+    void PopClearedTimers() {
+      while (!timer_heap.empty()) {
+        const auto& entry   = timer_heap.top();
+        const auto position = timers.find(entry.id);
+        if (position != timers.end() && position -> second.sequence == entry.sequence) {
+          break;
+        }
+        timer_heap.pop();
+      }
+    }
+
+    // Schedule timer id to expire at due. The mutex must be held.
+    void Schedule(std::uint32_t id, Timer& timer, Clock::time_point due) {
+      timer.sequence = next_sequence++;
+      timer_heap.push(TimerEntry { due, timer.sequence, id });
+    }
+
+    JSValue SetTimer(const std::vector<JSValue>& arguments, bool repeats) {
+      const char* function_name = repeats ? "setInterval" : "setTimeout";
+      if (arguments.empty() || !arguments[0].IsObject() || !static_cast<JSObject>(arguments[0]).IsFunction()) {
+        throw std::invalid_argument(std::string(function_name) + ": callback is not a function");
+      }
+
+      double delay = arguments.size() > 1 ? static_cast<double>(arguments[1]) : 0;
+      if (std::isnan(delay) || delay < 0) {
+        delay = 0;
+      }
+      auto interval = std::chrono::milliseconds(static_cast<std::int64_t>(std::min(delay, 2147483647.0)));
+      // A zero interval would never let RunUntilIdle finish a batch.
+      if (repeats && interval.count() == 0) {
+        interval = std::chrono::milliseconds(1);
+      }
+
+      std::uint32_t id = 0;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = next_timer_id++;
+        auto& timer = timers.emplace(id, Timer { static_cast<JSObject>(arguments[0]), std::vector<JSValue>(arguments.begin() + std::min<std::size_t>(2, arguments.size()), arguments.end()), interval, repeats, 0 }).first -> second;
+        Schedule(id, timer, Clock::now() + interval);
+      }
+      condition.notify_one();
+      return js_context.CreateNumber(id);
+    }
+
+    void ClearTimer(const std::vector<JSValue>& arguments) {
+      if (arguments.empty() || !arguments[0].IsNumber()) {
+        return;
+      }
+      const auto id = static_cast<std::uint32_t>(arguments[0]);
+      std::lock_guard<std::mutex> lock(mutex);
+      timers.erase(id);
+    }
+
+    // Wait until timeout passes, a timer expires, a task is posted or
+    // Stop is called. Return whether there is anything to dispatch.
+    bool Wait(std::chrono::milliseconds timeout) {
+      std::unique_lock<std::mutex> lock(mutex);
+      const auto deadline = Clock::now() + timeout;
+      while (true) {
+        PopClearedTimers();
+        const auto now = Clock::now();
+        if (!tasks.empty() || (!timer_heap.empty() && timer_heap.top().due <= now)) {
+          return true;
+        }
+        if (stop_requested || now >= deadline) {
+          return false;
+        }
+        const auto wake_time = timer_heap.empty() ? deadline : std::min(deadline, timer_heap.top().due);
+        condition.wait_until(lock, wake_time);
+      }
+    }
+
+    // Return whether Stop was called, and forget that it was.
+    bool ConsumeStopRequest() {
+      std::lock_guard<std::mutex> lock(mutex);
+      const bool result = stop_requested;
+      stop_requested = false;
+      return result;
+    }
+
+    bool IsIdle() const {
+      std::lock_guard<std::mutex> lock(mutex);
+      return tasks.empty() && timers.empty() && deferreds.empty();
+    }
+
+    void RecordLag(Clock::time_point due, Clock::time_point now) {
+      const auto lag = std::chrono::duration_cast<std::chrono::microseconds>(now - due);
+      statistics.total_lag += lag;
+      statistics.max_lag    = std::max(statistics.max_lag, lag);
+    }
+
+    std::size_t DispatchBatch() {
+      struct DueTimer {
+        std::uint32_t        id;
+        JSObject             callback;
+        std::vector<JSValue> arguments;
+      };
+
+      std::deque<Task>      batch_tasks;
+      std::vector<DueTimer> due_timers;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto now = Clock::now();
+        batch_tasks.swap(tasks);
+        for (const auto& task : batch_tasks) {
+          RecordLag(task.posted, now);
+        }
+
+        PopClearedTimers();
+        while (!timer_heap.empty() && timer_heap.top().due <= now) {
+          const auto entry = timer_heap.top();
+          timer_heap.pop();
+          auto& timer = timers.at(entry.id);
+          RecordLag(entry.due, now);
+          due_timers.push_back(DueTimer { entry.id, timer.callback, timer.arguments });
+          // A timeout stays in timers, without a heap entry, until it
+          // runs, so that an earlier callback can still clear it.
+          if (timer.repeats) {
+            // Skip the intervals the loop fell behind on instead of
+            // running them all at once.
+            auto next_due = entry.due + timer.interval;
+            if (next_due <= now) {
+              next_due = now + timer.interval;
+            }
+            Schedule(entry.id, timer, next_due);
+          }
+          PopClearedTimers();
+        }
+
+        statistics.task_count  += batch_tasks.size();
+        statistics.timer_count += due_timers.size();
+        if (!batch_tasks.empty() || !due_timers.empty()) {
+          ++statistics.batch_count;
+        }
+      }
+
+      for (auto& task : batch_tasks) {
+        try {
+          task.task(js_context);
+        } catch (const std::exception& e) {
+          HAL_LOG_ERROR("JSEventLoop: task threw ", e.what());
+        } catch (...) {
+          HAL_LOG_ERROR("JSEventLoop: task threw unknown exception");
+        }
+      }
+
+      const auto global_object = js_context.get_global_object();
+      std::size_t callback_count = batch_tasks.size();
+      for (auto& due_timer : due_timers) {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          const auto position = timers.find(due_timer.id);
+          // An earlier callback of this batch cleared it.
+          if (position == timers.end()) {
+            continue;
+          }
+          if (!position -> second.repeats) {
+            timers.erase(position);
+          }
+        }
+        ++callback_count;
+        try {
+          due_timer.callback(due_timer.arguments, global_object);
+        } catch (const std::exception& e) {
+          HAL_LOG_ERROR("JSEventLoop: timer ", due_timer.id, " threw ", e.what());
+        } catch (...) {
+          HAL_LOG_ERROR("JSEventLoop: timer ", due_timer.id, " threw unknown exception");
+        }
+      }
+
+      return callback_count;
+    }
+  };
+
+  JSEventLoop::JSEventLoop(const JSContext& js_context, std::size_t async_thread_count)
+  : state_ptr__(std::make_shared<State>(js_context))
+  , thread_pool__(async_thread_count > 0 ? async_thread_count : std::thread::hardware_concurrency()) {
+    state_ptr__ -> thread_pool_ptr = &thread_pool__;
+
+    const std::weak_ptr<State> weak_state_ptr = state_ptr__;
+    const auto lock_state = [weak_state_ptr]() {
+      const auto state_ptr = weak_state_ptr.lock();
+      if (!state_ptr) {
+        throw std::runtime_error("JSEventLoop: the event loop has been destroyed");
+      }
+      return state_ptr;
+    };
+
+    JSFunctionCallback set_timeout = [lock_state](const std::vector<JSValue> arguments, JSObject&) {
+      return lock_state() -> SetTimer(arguments, false);
+    };
+    JSFunctionCallback set_interval = [lock_state](const std::vector<JSValue> arguments, JSObject&) {
+      return lock_state() -> SetTimer(arguments, true);
+    };
+    JSFunctionCallback clear_timer = [lock_state](const std::vector<JSValue> arguments, JSObject&) {
+      const auto state_ptr = lock_state();
+      state_ptr -> ClearTimer(arguments);
+      return static_cast<JSValue>(state_ptr -> js_context.CreateUndefined());
+    };
+
+    auto global_object = js_context.get_global_object();
+    global_object.SetProperty("setTimeout",    js_context.CreateFunction("setTimeout",    set_timeout));
+    global_object.SetProperty("setInterval",   js_context.CreateFunction("setInterval",   set_interval));
+    global_object.SetProperty("clearTimeout",  js_context.CreateFunction("clearTimeout",  clear_timer));
+    global_object.SetProperty("clearInterval", js_context.CreateFunction("clearInterval", clear_timer));
+  }
+
+  JSEventLoop::~JSEventLoop() HAL_NOEXCEPT {
+    Stop();
+    if (thread__.joinable()) {
+      thread__.join();
+    }
+    std::unordered_map<std::uint64_t, Deferred> deferreds;
+    {
+      std::lock_guard<std::mutex> lock(state_ptr__ -> mutex);
+      state_ptr__ -> thread_pool_ptr = nullptr;
+      deferreds.swap(state_ptr__ -> deferreds);
+    }
+
+    // The loop's thread has stopped, so the Promises can be rejected
+    // here.
+    const auto& js_context   = state_ptr__ -> js_context;
+    const auto global_object = js_context.get_global_object();
+    for (auto& entry : deferreds) {
+      try {
+        entry.second.reject(std::vector<JSValue> { MakeError(js_context, "JSEventLoop: the event loop was destroyed") }, global_object);
+      } catch (const std::exception& e) {
+        HAL_LOG_ERROR("JSEventLoop: rejecting a Promise threw ", e.what());
+      } catch (...) {
+        HAL_LOG_ERROR("JSEventLoop: rejecting a Promise threw unknown exception");
+      }
+    }
+  }
+
+  void JSEventLoop::Post(JSEventLoopTask task) {
+    state_ptr__ -> PostTask(std::move(task));
+  }
+
+  void JSEventLoop::PostWork(std::function<void()> work) {
+    thread_pool__.Post(std::move(work));
+  }
+
+  JSFunction JSEventLoop::CreateAsyncFunction(const JSString& function_name, JSAsyncFunctionCallback callback) {
+    const std::weak_ptr<State> weak_state_ptr = state_ptr__;
+    JSFunctionCallback async_callback = [weak_state_ptr, callback](const std::vector<JSValue> arguments, JSObject& this_object) {
+      const auto state_ptr = weak_state_ptr.lock();
+      if (!state_ptr) {
+        throw std::runtime_error("JSEventLoop: the event loop has been destroyed");
+      }
+
+      auto work = callback(arguments, this_object);
+      auto id_and_promise = state_ptr -> MakeDeferred();
+      const auto id = id_and_promise.first;
+
+      std::lock_guard<std::mutex> lock(state_ptr -> mutex);
+      if (state_ptr -> thread_pool_ptr == nullptr) {
+        throw std::runtime_error("JSEventLoop: the event loop is being destroyed");
+      }
+      state_ptr -> thread_pool_ptr -> Post([weak_state_ptr, work, id] {
+        JSAsyncResult result;
+        std::string   error_message;
+        try {
+          result = work();
+          if (!result) {
+            error_message = "async work returned no result";
+          }
+        } catch (const std::exception& e) {
+          error_message = e.what();
+        } catch (...) {
+          error_message = "async work threw unknown exception";
+        }
+
+        const auto state_ptr = weak_state_ptr.lock();
+        if (state_ptr) {
+          std::weak_ptr<State> settle_state_ptr = state_ptr;
+          state_ptr -> PostTask([settle_state_ptr, id, result, error_message](JSContext&) {
+            const auto state_ptr = settle_state_ptr.lock();
+            if (state_ptr) {
+              state_ptr -> Settle(id, result, error_message);
+            }
+          });
+        }
+      });
+      return static_cast<JSValue>(id_and_promise.second);
+    };
+    return state_ptr__ -> js_context.CreateFunction(function_name, async_callback);
+  }
+
+  std::size_t JSEventLoop::RunOnce(std::chrono::milliseconds timeout) {
+    return state_ptr__ -> Wait(timeout) ? state_ptr__ -> DispatchBatch() : 0;
+  }
+
+  void JSEventLoop::RunUntilIdle() {
+    while (!state_ptr__ -> IsIdle()) {
+      if (state_ptr__ -> Wait(std::chrono::hours(24))) {
+        state_ptr__ -> DispatchBatch();
+      }
+      if (state_ptr__ -> ConsumeStopRequest()) {
+        return;
+      }
+    }
+  }
+
+  void JSEventLoop::Run() {
+    do {
+      if (state_ptr__ -> Wait(std::chrono::hours(24))) {
+        state_ptr__ -> DispatchBatch();
+      }
+    } while (!state_ptr__ -> ConsumeStopRequest());
+  }
+
+  void JSEventLoop::Start() {
+    if (!thread__.joinable()) {
+      thread__ = std::thread(&JSEventLoop::Run, this);
+    }
+  }
+
+  void JSEventLoop::Stop() HAL_NOEXCEPT {
+    {
+      std::lock_guard<std::mutex> lock(state_ptr__ -> mutex);
+      state_ptr__ -> stop_requested = true;
+    }
+    state_ptr__ -> condition.notify_all();
+    if (thread__.joinable() && thread__.get_id() != std::this_thread::get_id()) {
+      thread__.join();
+    }
+  }
+
+  JSEventLoopStatistics JSEventLoop::GetStatistics() const {
+    std::lock_guard<std::mutex> lock(state_ptr__ -> mutex);
+    auto statistics = state_ptr__ -> statistics;
+    statistics.pending_task_count  = state_ptr__ -> tasks.size();
+    statistics.pending_timer_count = state_ptr__ -> timers.size();
+    statistics.pending_async_count = state_ptr__ -> deferreds.size();
+    return statistics;
+  }
+
+} // namespace HAL {
@@ -0,0 +1,183 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/JSExecutor.hpp"
+#include "HAL/JSContextGroup.hpp"
+#include "HAL/JSString.hpp"
+#include "HAL/JSValue.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <thread>
+
+namespace HAL {
+
+  struct JSExecutor::Worker {
+    std::mutex                   mutex;
+    std::deque<JSExecutorJob>    jobs;
+    std::thread                  thread;
+#ifndef HAL_THREAD_LOCAL_ENABLE
+    // Set by the worker's thread itself, since thread is only assigned
+    // after the worker may have started.
+    std::atomic<std::thread::id> thread_id { std::thread::id() };
+#endif
+  };
+
+#ifdef HAL_THREAD_LOCAL_ENABLE
+  namespace {
+    // The executor and worker index of the current thread, so that
+    // jobs submitted by a job stay on its worker.
+    thread_local const JSExecutor* current_executor_ptr { nullptr };
+    thread_local std::size_t       current_worker_index { 0 };
+  }
+#endif
+
+  JSExecutor::JSExecutor(std::size_t worker_count, JSExecutorJob initializer)
+  : initializer__(initializer) {
+    if (worker_count == 0) {
+      worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Every queue exists before any worker may try to steal from it.
+    for (std::size_t index = 0; index < worker_count; ++index) {
+      workers__.emplace_back(new Worker());
+    }
+    for (std::size_t index = 0; index < worker_count; ++index) {
+      workers__[index] -> thread = std::thread(&JSExecutor::Run, this, index);
+    }
+  }
+
+  JSExecutor::~JSExecutor() HAL_NOEXCEPT {
+    {
+      std::lock_guard<std::mutex> lock(mutex__);
+      stopping__ = true;
+    }
+    job_condition__.notify_all();
+    for (auto& worker_ptr : workers__) {
+      worker_ptr -> thread.join();
+    }
+  }
+
+  std::future<std::string> JSExecutor::Evaluate(const std::string& script, const std::string& source_url) {
+    return Submit([script, source_url](JSContext& js_context) {
+      return static_cast<std::string>(js_context.JSEvaluateScript(JSString(script), JSString(source_url)));
+    });
+  }
+
+  std::size_t JSExecutor::GetCurrentWorkerIndex() const HAL_NOEXCEPT {
+#ifdef HAL_THREAD_LOCAL_ENABLE
+    return (current_executor_ptr == this) ? current_worker_index : workers__.size();
+#else
+    // Without thread_local storage, look for this thread among the
+    // workers.
+    const auto thread_id = std::this_thread::get_id();
+    for (std::size_t index = 0; index < workers__.size(); ++index) {
+      if (workers__[index] -> thread_id.load() == thread_id) {
+        return index;
+      }
+    }
+    return workers__.size();
+#endif
+  }
+
+  void JSExecutor::Post(JSExecutorJob job) {
+    const auto current_index = GetCurrentWorkerIndex();
+    const auto index = (current_index < workers__.size()) ? current_index : next_worker__++ % workers__.size();
+    {
+      // Count the job before publishing it, under the queue's mutex,
+      // so that a worker can't pop it and decrement pending_count__
+      // first.
+      auto& worker = *workers__[index];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      {
+        std::lock_guard<std::mutex> pending_lock(mutex__);
+        ++pending_count__;
+      }
+      worker.jobs.push_back(std::move(job));
+    }
+    job_condition__.notify_one();
+  }
+
+  bool JSExecutor::Pop(std::size_t index, JSExecutorJob& job) HAL_NOEXCEPT {
+    // Take the oldest job of this worker's own queue, or else steal
+    // the newest job of another's.
+    for (std::size_t offset = 0; offset < workers__.size(); ++offset) {
+      auto& worker = *workers__[(index + offset) % workers__.size()];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      if (worker.jobs.empty()) {
+        continue;
+      }
+      if (offset == 0) {
+        job = std::move(worker.jobs.front());
+        worker.jobs.pop_front();
+      } else {
+        job = std::move(worker.jobs.back());
+        worker.jobs.pop_back();
+      }
+      // Still holding the queue's mutex, which Post also holds while
+      // it counts a job, so pending_count__ never drops below the
+      // number of queued jobs.
+      std::lock_guard<std::mutex> pending_lock(mutex__);
+      --pending_count__;
+      return true;
+    }
+    return false;
+  }
+
+  void JSExecutor::Run(std::size_t index) HAL_NOEXCEPT {
+#ifdef HAL_THREAD_LOCAL_ENABLE
+    current_executor_ptr = this;
+    current_worker_index = index;
+#else
+    workers__[index] -> thread_id = std::this_thread::get_id();
+#endif
+
+    // Created and destroyed on this thread only.
+    JSContextGroup js_context_group;
+    JSContext js_context = js_context_group.CreateContext();
+
+    try {
+      if (initializer__) {
+        initializer__(js_context);
+      }
+    } catch (const std::exception& e) {
+      HAL_LOG_ERROR("JSExecutor: initializer threw ", e.what());
+    } catch (...) {
+      HAL_LOG_ERROR("JSExecutor: initializer threw unknown exception");
+    }
+
+    JSExecutorJob job;
+    while (true) {
+      if (Pop(index, job)) {
+        try {
+          job(js_context);
+        } catch (const std::exception& e) {
+          HAL_LOG_ERROR("JSExecutor: job threw ", e.what());
+        } catch (...) {
+          HAL_LOG_ERROR("JSExecutor: job threw unknown exception");
+        }
+        job = nullptr;
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(mutex__);
+      job_condition__.wait(lock, [this] { return stopping__ || pending_count__ > 0; });
+      if (pending_count__ == 0) {
+        break;
+      }
+    }
+
+#ifdef HAL_THREAD_LOCAL_ENABLE
+    current_executor_ptr = nullptr;
+#else
+    workers__[index] -> thread_id = std::thread::id();
+#endif
+  }
+
+} // namespace HAL {
@@ -8,6 +8,7 @@
 
 #include "HAL/JSExportObject.hpp"
 #include "HAL/JSUndefined.hpp"
+#include "HAL/detail/JSExportIdentityMap.hpp"
 #include <utility>
 
 namespace HAL {
@@ -30,9 +31,37 @@ namespace HAL {
   }
   
   JSObject JSExportObject::get_object() HAL_NOEXCEPT {
+    const auto object_ref = detail::JSExportIdentityMap::Find(static_cast<JSContextRef>(js_context__), this);
+    if (object_ref) {
+      return JSObject(js_context__, object_ref);
+    }
     return JSObject::FindJSObjectFromPrivateData(get_context(), this);
   }
   
+  void JSExportObject::InvalidateProperty(const std::string& property_name) HAL_NOEXCEPT {
+    HAL_JSEXPORTOBJECT_LOCK_GUARD;
+    memoized_properties__.erase(property_name);
+  }
+  
+  void JSExportObject::InvalidateProperties() HAL_NOEXCEPT {
+    HAL_JSEXPORTOBJECT_LOCK_GUARD;
+    memoized_properties__.clear();
+  }
+  
+  JSValueRef JSExportObject::GetMemoizedProperty(const std::string& property_name) HAL_NOEXCEPT {
+    HAL_JSEXPORTOBJECT_LOCK_GUARD;
+    const auto position = memoized_properties__.find(property_name);
+    return position != memoized_properties__.end() ? static_cast<JSValueRef>(position -> second) : nullptr;
+  }
+  
+  void JSExportObject::SetMemoizedProperty(const std::string& property_name, const JSValue& js_value) {
+    HAL_JSEXPORTOBJECT_LOCK_GUARD;
+    const auto insert_result = memoized_properties__.emplace(property_name, js_value);
+    if (!insert_result.second) {
+      insert_result.first -> second = js_value;
+    }
+  }
+  
   JSExportObject::JSExportObject(const JSContext& js_context) HAL_NOEXCEPT
   : js_context__(js_context) {
     HAL_LOG_DEBUG("JSExportObject:: ctor ", this);
@@ -48,7 +77,8 @@ namespace HAL {
     
     // By swapping the members of two classes, the two classes are
     // effectively swapped.
-    swap(js_context__  , other.js_context__);
+    swap(js_context__         , other.js_context__);
+    swap(memoized_properties__, other.memoized_properties__);
   }
   
 } // namespace HAL {
@@ -0,0 +1,56 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/JSInvoker.hpp"
+#include "HAL/detail/JSUtil.hpp"
+
+namespace HAL {
+
+  JSInvoker::JSInvoker(const JSObject& function, const JSObject& this_object, std::size_t arity)
+  : js_context__(function.get_context())
+  , function__(function)
+  , this_object__(this_object)
+  , context_ref__(static_cast<JSContextRef>(js_context__))
+  , function_ref__(static_cast<JSObjectRef>(function__))
+  , this_object_ref__(static_cast<JSObjectRef>(this_object__))
+  , arguments__(arity, nullptr) {
+    if (!function__.IsFunction()) {
+      detail::ThrowRuntimeError("JSInvoker", "This JavaScript object is not a function.");
+    }
+
+    // Until SetArgument is called, pass undefined rather than nullptr.
+    const auto undefined_ref = JSValueMakeUndefined(context_ref__);
+    for (auto& argument : arguments__) {
+      argument = undefined_ref;
+    }
+  }
+
+  double JSInvoker::InvokeAsNumber() {
+    const auto js_value_ref = InvokeWithArguments();
+    JSValueRef exception { nullptr };
+    const double result = JSValueToNumber(context_ref__, js_value_ref, &exception);
+    if (exception) {
+      ThrowException(exception);
+    }
+    return result;
+  }
+
+  void JSInvoker::Map(const std::vector<JSValue>& arguments, std::vector<JSValue>& results) {
+    results.clear();
+    results.reserve(arguments.size());
+    for (const auto& argument : arguments) {
+      const auto argument_ref = static_cast<JSValueRef>(argument);
+      results.push_back(JSValue(js_context__, Call(&argument_ref, 1)));
+    }
+  }
+
+  void JSInvoker::ThrowException(JSValueRef exception) const {
+    detail::ThrowRuntimeError("JSInvoker", JSValue(js_context__, exception));
+  }
+
+} // namespace HAL {
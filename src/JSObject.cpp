@@ -17,8 +17,11 @@
 #include "HAL/JSNumber.hpp"
 #include "HAL/JSError.hpp"
 #include "HAL/JSArray.hpp"
+#include "HAL/JSResult.hpp"
 
+#include "HAL/detail/JSArgumentBuffer.hpp"
 #include "HAL/detail/JSPropertyNameAccumulator.hpp"
+#include "HAL/detail/JSBuiltins.hpp"
 #include "HAL/detail/JSUtil.hpp"
 
 #include <algorithm>
@@ -62,6 +65,28 @@ namespace HAL {
     return JSValue(js_context__, js_value_ref);
   }
   
+  JSResult JSObject::TryGetProperty(const JSString& property_name) const HAL_NOEXCEPT {
+    HAL_JSOBJECT_LOCK_GUARD;
+    JSValueRef exception { nullptr };
+    const auto js_value_ref = JSObjectGetProperty(static_cast<JSContextRef>(js_context__), js_object_ref__, static_cast<JSStringRef>(property_name), &exception);
+    if (exception) {
+      return JSResult::Exception(js_context__, exception, "JSObject");
+    }
+    
+    return JSResult::Value(js_context__, js_value_ref);
+  }
+  
+  JSResult JSObject::TryGetProperty(unsigned property_index) const HAL_NOEXCEPT {
+    HAL_JSOBJECT_LOCK_GUARD;
+    JSValueRef exception { nullptr };
+    const auto js_value_ref = JSObjectGetPropertyAtIndex(static_cast<JSContextRef>(js_context__), js_object_ref__, property_index, &exception);
+    if (exception) {
+      return JSResult::Exception(js_context__, exception, "JSObject");
+    }
+    
+    return JSResult::Value(js_context__, js_value_ref);
+  }
+  
   void JSObject::SetProperty(const JSString& property_name, const JSValue& property_value, const std::unordered_set<JSPropertyAttribute>& attributes) {
     HAL_JSOBJECT_LOCK_GUARD;
     
@@ -114,59 +139,64 @@ namespace HAL {
 
   bool JSObject::IsArray() const HAL_NOEXCEPT {
     HAL_JSOBJECT_LOCK_GUARD;
-
-    JSObject global_object = js_context__.get_global_object();
-    JSValue array_value = global_object.GetProperty("Array");
-    if (!array_value.IsObject()) {
-      return false;
-    }
-    
-    JSObject array = static_cast<JSObject>(array_value);
-    JSValue isArray_value = array.GetProperty("isArray");
-    if (!isArray_value.IsObject()) {
-      return false;
-    }
-    JSObject isArray = static_cast<JSObject>(isArray_value);
-    if (!isArray.IsFunction()) {
+    const auto context_ref = static_cast<JSContextRef>(js_context__);
+#ifdef HAL_HAVE_JSVALUEISARRAY
+    return JSValueIsArray(context_ref, js_object_ref__);
+#else
+    const auto is_array_ref = detail::JSBuiltins::GetArrayIsArray(context_ref);
+    if (is_array_ref == nullptr || !JSObjectIsFunction(context_ref, is_array_ref)) {
       return false;
     }
 
-    JSValue self = static_cast<JSValue>(*this);
-    JSValue result = isArray(self, global_object);
-    if (result.IsBoolean()) {
-        return static_cast<bool>(result);
-    }
-    
-    return false;
+    const JSValueRef argument_ref = js_object_ref__;
+    const auto       result_ref   = JSObjectCallAsFunction(context_ref, is_array_ref, nullptr, 1, &argument_ref, nullptr);
+    return result_ref && JSValueIsBoolean(context_ref, result_ref) && JSValueToBoolean(context_ref, result_ref);
+#endif
   }
   
   bool JSObject::IsError() const HAL_NOEXCEPT {
     HAL_JSOBJECT_LOCK_GUARD;
-    const auto global_object = js_context__.get_global_object();
-    const auto error_value = global_object.GetProperty("Error");
-    if (!error_value.IsObject()) {
+    const auto context_ref = static_cast<JSContextRef>(js_context__);
+    const auto error_ref   = detail::JSBuiltins::GetErrorConstructor(context_ref);
+    if (error_ref == nullptr) {
       return false;
     }
-    const auto error = static_cast<JSObject>(error_value);
-    const auto self  = static_cast<JSValue>(*this);
-    return static_cast<std::string>(self) == "[object Error]" || self.IsInstanceOfConstructor(error);
+
+    JSValueRef exception { nullptr };
+    return JSValueIsInstanceOfConstructor(context_ref, js_object_ref__, error_ref, &exception) && !exception;
   }
   
-  JSValue JSObject::operator()(                                        JSObject this_object) { return CallAsFunction(std::vector<JSValue>()                      , this_object); }
-  JSValue JSObject::operator()(JSValue&                     argument , JSObject this_object) { return CallAsFunction({argument}                                  , this_object); }
-  JSValue JSObject::operator()(const JSString&              argument , JSObject this_object) { return CallAsFunction(detail::to_vector(js_context__, {argument}) , this_object); }
+  JSValue JSObject::operator()(                                        JSObject this_object) { return CallAsFunction(nullptr, 0, static_cast<JSObjectRef>(this_object)); }
+  JSValue JSObject::operator()(JSValue&                     argument , JSObject this_object) { return Call(this_object, argument); }
+  JSValue JSObject::operator()(const JSString&              argument , JSObject this_object) { return Call(this_object, js_context__.CreateString(argument)); }
   JSValue JSObject::operator()(const std::vector<JSValue>&  arguments, JSObject this_object) { return CallAsFunction(arguments                                   , this_object); }
   JSValue JSObject::operator()(const std::vector<JSString>& arguments, JSObject this_object) { return CallAsFunction(detail::to_vector(js_context__, arguments)  , this_object); }
   
+  JSValue JSObject::Call(const JSValue arguments[], std::size_t argument_count, const JSObject& this_object) {
+    const detail::JSArgumentBuffer arguments_array(arguments, argument_count);
+    return CallAsFunction(arguments_array.data(), arguments_array.size(), static_cast<JSObjectRef>(this_object));
+  }
+  
   bool JSObject::IsConstructor() const HAL_NOEXCEPT {
     return JSObjectIsConstructor(static_cast<JSContextRef>(js_context__), js_object_ref__);
   }
   
-  JSObject JSObject::CallAsConstructor(                                      ) { return CallAsConstructor(std::vector<JSValue>  {}        ); }
-  JSObject JSObject::CallAsConstructor(const JSValue&               argument ) { return CallAsConstructor(std::vector<JSValue>  {argument}); }
-  JSObject JSObject::CallAsConstructor(const JSString&              argument ) { return CallAsConstructor(std::vector<JSString> {argument}); }
+  JSObject JSObject::CallAsConstructor(                                      ) { return CallAsConstructor(nullptr, 0); }
+  JSObject JSObject::CallAsConstructor(const JSValue&               argument ) { return Construct(argument); }
+  JSObject JSObject::CallAsConstructor(const JSString&              argument ) { return Construct(js_context__.CreateString(argument)); }
   JSObject JSObject::CallAsConstructor(const std::vector<JSString>& arguments) { return CallAsConstructor(detail::to_vector(js_context__, arguments)); }
+  
   JSObject JSObject::CallAsConstructor(const std::vector<JSValue>&  arguments) {
+    const detail::JSArgumentBuffer arguments_array(arguments);
+    return CallAsConstructor(arguments_array.data(), arguments_array.size());
+  }
+  
+  JSObject JSObject::Construct(const JSValue arguments[], std::size_t argument_count) {
+    const detail::JSArgumentBuffer arguments_array(arguments, argument_count);
+    return CallAsConstructor(arguments_array.data(), arguments_array.size());
+  }
+  
+  JSObject JSObject::CallAsConstructor(const JSValueRef arguments_array[], std::size_t argument_count) {
     HAL_JSOBJECT_LOCK_GUARD;
     
     if (!IsConstructor()) {
@@ -174,13 +204,7 @@ namespace HAL {
     }
     
     JSValueRef exception { nullptr };
-    JSObjectRef js_object_ref = nullptr;
-    if (!arguments.empty()) {
-      const auto arguments_array = detail::to_vector(arguments);
-      js_object_ref = JSObjectCallAsConstructor(static_cast<JSContextRef>(js_context__), js_object_ref__, arguments_array.size(), &arguments_array[0], &exception);
-    } else {
-      js_object_ref = JSObjectCallAsConstructor(static_cast<JSContextRef>(js_context__), js_object_ref__, 0, nullptr, &exception);
-    }
+    JSObjectRef js_object_ref = JSObjectCallAsConstructor(static_cast<JSContextRef>(js_context__), js_object_ref__, argument_count, arguments_array, &exception);
     
     if (exception) {
       // If this assert fails then we need to JSValueUnprotect
@@ -288,6 +312,11 @@ namespace HAL {
   }
   
   JSValue JSObject::CallAsFunction(const std::vector<JSValue>&  arguments, JSObject this_object) {
+    const detail::JSArgumentBuffer arguments_array(arguments);
+    return CallAsFunction(arguments_array.data(), arguments_array.size(), static_cast<JSObjectRef>(this_object));
+  }
+  
+  JSValue JSObject::CallAsFunction(const JSValueRef arguments_array[], std::size_t argument_count, JSObjectRef this_object_ref) {
     HAL_JSOBJECT_LOCK_GUARD;
     
     if (!IsFunction()) {
@@ -295,13 +324,7 @@ namespace HAL {
     }
     
     JSValueRef exception { nullptr };
-    JSValueRef js_value_ref { nullptr };
-    if (!arguments.empty()) {
-      const auto arguments_array = detail::to_vector(arguments);
-      js_value_ref = JSObjectCallAsFunction(static_cast<JSContextRef>(js_context__), js_object_ref__, static_cast<JSObjectRef>(this_object), arguments_array.size(), &arguments_array[0], &exception);
-    } else {
-      js_value_ref = JSObjectCallAsFunction(static_cast<JSContextRef>(js_context__), js_object_ref__, static_cast<JSObjectRef>(this_object), 0, nullptr, &exception);
-    }
+    JSValueRef js_value_ref = JSObjectCallAsFunction(static_cast<JSContextRef>(js_context__), js_object_ref__, this_object_ref, argument_count, arguments_array, &exception);
     
     if (exception) {
       // If this assert fails then we need to JSValueUnprotect
@@ -314,6 +337,32 @@ namespace HAL {
     return JSValue(js_context__, js_value_ref);
   }
   
+  JSResult JSObject::TryCall(const std::vector<JSValue>& arguments, JSObject this_object) HAL_NOEXCEPT {
+    HAL_JSOBJECT_LOCK_GUARD;
+    
+    const auto context_ref = static_cast<JSContextRef>(js_context__);
+    JSValueRef exception { nullptr };
+    
+    // JavaScriptCore returns NULL without an exception for an object
+    // that can't be called, so raise the TypeError JavaScript would.
+    if (!JSObjectIsFunction(context_ref, js_object_ref__)) {
+      static const JSString message("This JavaScript object is not a function.");
+      const JSValueRef message_ref = JSValueMakeString(context_ref, static_cast<JSStringRef>(message));
+      const auto type_error_constructor_ref = detail::JSBuiltins::GetTypeErrorConstructor(context_ref);
+      const auto error_ref = type_error_constructor_ref ? JSObjectCallAsConstructor(context_ref, type_error_constructor_ref, 1, &message_ref, &exception) : JSObjectMakeError(context_ref, 1, &message_ref, &exception);
+      return JSResult::Exception(js_context__, error_ref ? error_ref : exception, "JSObject");
+    }
+    
+    const detail::JSArgumentBuffer arguments_array(arguments);
+    JSValueRef js_value_ref = JSObjectCallAsFunction(context_ref, js_object_ref__, static_cast<JSObjectRef>(this_object), arguments_array.size(), arguments_array.data(), &exception);
+    
+    if (exception) {
+      return JSResult::Exception(js_context__, exception, "JSObject");
+    }
+    
+    return JSResult::Value(js_context__, js_value_ref);
+  }
+  
   void JSObject::GetPropertyNames(const JSPropertyNameAccumulator& accumulator) const HAL_NOEXCEPT {
     HAL_JSOBJECT_LOCK_GUARD;
     for (const auto& property_name : static_cast<std::vector<JSString>>(GetPropertyNames())) {
@@ -0,0 +1,56 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/JSResult.hpp"
+#include "HAL/JSUndefined.hpp"
+#include "HAL/detail/JSUtil.hpp"
+
+namespace HAL {
+  
+  JSValue JSResult::get_value() const {
+    ThrowIfException();
+    return js_value__;
+  }
+  
+  JSValue JSResult::get_exception() const HAL_NOEXCEPT {
+    if (has_exception__) {
+      return js_value__;
+    }
+    return js_value__.get_context().CreateUndefined();
+  }
+  
+  std::string JSResult::get_exception_message() const {
+    if (has_exception__) {
+      return to_string(js_value__);
+    }
+    return "";
+  }
+  
+  void JSResult::ThrowIfException() const {
+    if (has_exception__) {
+      detail::ThrowRuntimeError(internal_component_name__, js_value__, source_url__, line_number__);
+    }
+  }
+  
+  JSResult JSResult::Value(const JSContext& js_context, JSValueRef js_value_ref) HAL_NOEXCEPT {
+    return JSResult(JSValue(js_context, js_value_ref), false, nullptr, "", 0);
+  }
+  
+  JSResult JSResult::Exception(const JSContext& js_context, JSValueRef exception_ref, const char* internal_component_name, const std::string& source_url, int line_number) HAL_NOEXCEPT {
+    return JSResult(JSValue(js_context, exception_ref), true, internal_component_name, source_url, line_number);
+  }
+  
+  JSResult::JSResult(const JSValue& js_value, bool has_exception, const char* internal_component_name, const std::string& source_url, int line_number) HAL_NOEXCEPT
+  : js_value__(js_value)
+  , has_exception__(has_exception)
+  , internal_component_name__(internal_component_name)
+  , source_url__(source_url)
+  , line_number__(line_number) {
+  }
+  
+} // namespace HAL {
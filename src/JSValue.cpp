@@ -22,6 +22,7 @@
 #include "HAL/JSError.hpp"
 #include "HAL/JSFunction.hpp"
 #include "HAL/JSRegExp.hpp"
+#include "HAL/JSResult.hpp"
 
 #include "HAL/JSClass.hpp"
 
@@ -236,6 +237,17 @@ namespace HAL {
     return JSValueIsObjectOfClass(static_cast<JSContextRef>(js_context__), js_value_ref__, static_cast<JSClassRef>(js_class));
   }
   
+  JSResult JSValue::TryToObject() const HAL_NOEXCEPT {
+    HAL_JSVALUE_LOCK_GUARD;
+    JSValueRef exception { nullptr };
+    const auto js_object_ref = JSValueToObject(static_cast<JSContextRef>(js_context__), js_value_ref__, &exception);
+    if (exception) {
+      return JSResult::Exception(js_context__, exception, "JSValue");
+    }
+    
+    return JSResult::Value(js_context__, js_object_ref);
+  }
+  
   bool JSValue::IsInstanceOfConstructor(const JSObject& constructor) const {
     HAL_JSVALUE_LOCK_GUARD;
     JSValueRef exception { nullptr };
@@ -0,0 +1,73 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/detail/JSBuiltins.hpp"
+#include "HAL/detail/JSContextSlots.hpp"
+#include "HAL/JSString.hpp"
+
+namespace HAL { namespace detail {
+
+  namespace {
+
+    // Return the object at global[name], or global[name][member_name]
+    // if member_name isn't nullptr, caching it in slot index.
+    JSObjectRef GetBuiltin(JSContextRef context_ref, std::size_t index, const JSString& name, const JSString* member_name) HAL_NOEXCEPT {
+      const auto cached_ref = JSContextSlots::GetValue(context_ref, index);
+      if (cached_ref) {
+        return JSValueToObject(context_ref, cached_ref, nullptr);
+      }
+
+      auto value_ref = JSObjectGetProperty(context_ref, JSContextGetGlobalObject(context_ref), static_cast<JSStringRef>(name), nullptr);
+      if (member_name && value_ref && JSValueIsObject(context_ref, value_ref)) {
+        value_ref = JSObjectGetProperty(context_ref, JSValueToObject(context_ref, value_ref, nullptr), static_cast<JSStringRef>(*member_name), nullptr);
+      }
+
+      if (!value_ref || !JSValueIsObject(context_ref, value_ref)) {
+        return nullptr;
+      }
+
+      JSContextSlots::SetValue(context_ref, index, value_ref);
+      return JSValueToObject(context_ref, value_ref, nullptr);
+    }
+
+  } // namespace {
+
+  JSObjectRef JSBuiltins::GetArrayIsArray(JSContextRef context_ref) HAL_NOEXCEPT {
+    static const std::size_t index = JSContextSlots::AllocateIndex();
+    static const JSString    array_name("Array");
+    static const JSString    is_array_name("isArray");
+    return GetBuiltin(context_ref, index, array_name, &is_array_name);
+  }
+
+  JSObjectRef JSBuiltins::GetErrorConstructor(JSContextRef context_ref) HAL_NOEXCEPT {
+    static const std::size_t index = JSContextSlots::AllocateIndex();
+    static const JSString    error_name("Error");
+    return GetBuiltin(context_ref, index, error_name, nullptr);
+  }
+
+  JSObjectRef JSBuiltins::GetErrorPrototype(JSContextRef context_ref) HAL_NOEXCEPT {
+    static const std::size_t index = JSContextSlots::AllocateIndex();
+    static const JSString    error_name("Error");
+    static const JSString    prototype_name("prototype");
+    return GetBuiltin(context_ref, index, error_name, &prototype_name);
+  }
+
+  JSObjectRef JSBuiltins::GetFunctionPrototype(JSContextRef context_ref) HAL_NOEXCEPT {
+    static const std::size_t index = JSContextSlots::AllocateIndex();
+    static const JSString    function_name("Function");
+    static const JSString    prototype_name("prototype");
+    return GetBuiltin(context_ref, index, function_name, &prototype_name);
+  }
+
+  JSObjectRef JSBuiltins::GetTypeErrorConstructor(JSContextRef context_ref) HAL_NOEXCEPT {
+    static const std::size_t index = JSContextSlots::AllocateIndex();
+    static const JSString    type_error_name("TypeError");
+    return GetBuiltin(context_ref, index, type_error_name, nullptr);
+  }
+
+}} // namespace HAL { namespace detail {
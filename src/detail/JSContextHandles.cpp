@@ -0,0 +1,203 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/detail/JSContextHandles.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace HAL { namespace detail {
+
+  struct JSContextHandleBlock final {
+
+    explicit JSContextHandleBlock(JSGlobalContextRef js_global_context_ref) HAL_NOEXCEPT
+    : js_global_context_ref(js_global_context_ref) {
+    }
+
+    const JSGlobalContextRef js_global_context_ref;
+
+    // Both counts only change under handles_mutex when the result may
+    // make them equal, so a thread that sees handle_count above
+    // captured_count + 1 can decrement without the lock.
+    std::atomic<std::size_t> handle_count   { 0 };
+    std::atomic<std::size_t> captured_count { 0 };
+
+    std::unordered_set<JSContextHandles::Owner*> owners;
+  };
+
+  namespace {
+
+    std::mutex                                                    handles_mutex;
+    std::unordered_map<JSGlobalContextRef, JSContextHandleBlock*> handle_blocks;
+
+#ifdef HAL_THREAD_LOCAL_ENABLE
+    thread_local JSContextHandles::CaptureScope* active_scope_ptr { nullptr };
+
+    JSContextHandles::CaptureScope* GetActiveScope() HAL_NOEXCEPT {
+      return active_scope_ptr;
+    }
+#else
+    // Without thread_local storage only one scope may be active at a
+    // time, so scopes take capture_mutex for their lifetime.
+    std::mutex                                   capture_mutex;
+    std::atomic<JSContextHandles::CaptureScope*> active_scope_ptr { nullptr };
+    std::atomic<std::thread::id>                 active_thread_id;
+
+    JSContextHandles::CaptureScope* GetActiveScope() HAL_NOEXCEPT {
+      const auto scope_ptr = active_scope_ptr.load();
+      return (scope_ptr && active_thread_id.load() == std::this_thread::get_id()) ? scope_ptr : nullptr;
+    }
+#endif
+
+  } // namespace {
+
+#ifdef HAL_THREAD_LOCAL_ENABLE
+  JSContextHandles::CaptureScope::CaptureScope() HAL_NOEXCEPT {
+    active_scope_ptr = this;
+  }
+#else
+  JSContextHandles::CaptureScope::CaptureScope() HAL_NOEXCEPT
+  : lock__(capture_mutex)
+  , thread_id__(std::this_thread::get_id()) {
+    active_thread_id = thread_id__;
+    active_scope_ptr = this;
+  }
+#endif
+
+  JSContextHandles::CaptureScope::~CaptureScope() HAL_NOEXCEPT {
+    active_scope_ptr = nullptr;
+  }
+
+  void JSContextHandles::CaptureScope::Count(JSContextHandleBlock* block_ptr, std::ptrdiff_t delta) {
+    const auto position = std::find_if(counts__.begin(), counts__.end(), [block_ptr](const std::pair<JSContextHandleBlock*, std::ptrdiff_t>& count) {
+      return count.first == block_ptr;
+    });
+    if (position != counts__.end()) {
+      position -> second += delta;
+    } else {
+      counts__.emplace_back(block_ptr, delta);
+    }
+  }
+
+  void JSContextHandles::CaptureScope::Adopt(JSContextRef context_ref, Owner* owner_ptr) {
+    const auto js_global_context_ref = JSContextGetGlobalContext(context_ref);
+
+    // Only a block with live handles can be dereferenced, since the
+    // others may already have been deleted.
+    for (const auto& count : counts__) {
+      if (count.second > 0 && count.first -> js_global_context_ref == js_global_context_ref) {
+        std::lock_guard<std::mutex> lock(handles_mutex);
+        const auto block_ptr = count.first;
+        block_ptr -> owners.insert(owner_ptr);
+        block_ptr -> captured_count += static_cast<std::size_t>(count.second);
+        owner_ptr -> block_ptr__     = block_ptr;
+        owner_ptr -> capture_count__ = static_cast<std::size_t>(count.second);
+        owner_ptr -> Retain();
+        return;
+      }
+    }
+  }
+
+  void JSContextHandles::Abandon(Owner* owner_ptr) HAL_NOEXCEPT {
+    bool abandoned { false };
+    {
+      std::lock_guard<std::mutex> lock(handles_mutex);
+      const auto block_ptr = owner_ptr -> block_ptr__;
+      if (block_ptr && block_ptr -> owners.erase(owner_ptr) > 0) {
+        block_ptr -> captured_count -= owner_ptr -> capture_count__;
+        owner_ptr -> block_ptr__     = nullptr;
+        owner_ptr -> capture_count__ = 0;
+        abandoned = true;
+      }
+    }
+
+    // Releasing may destroy the owner and with it its handles, so it
+    // must not happen under the lock.
+    if (abandoned) {
+      owner_ptr -> Release();
+    }
+  }
+
+  JSContextHandleBlock* JSContextHandles::Acquire(JSGlobalContextRef js_global_context_ref) HAL_NOEXCEPT {
+    JSContextHandleBlock* block_ptr { nullptr };
+    {
+      std::lock_guard<std::mutex> lock(handles_mutex);
+      auto& entry = handle_blocks[js_global_context_ref];
+      if (entry == nullptr) {
+        entry = new JSContextHandleBlock(js_global_context_ref);
+      }
+      block_ptr = entry;
+      ++block_ptr -> handle_count;
+    }
+
+    const auto scope_ptr = GetActiveScope();
+    if (scope_ptr) {
+      scope_ptr -> Count(block_ptr, 1);
+    }
+    return block_ptr;
+  }
+
+  void JSContextHandles::Retain(JSContextHandleBlock* block_ptr) HAL_NOEXCEPT {
+    ++block_ptr -> handle_count;
+
+    const auto scope_ptr = GetActiveScope();
+    if (scope_ptr) {
+      scope_ptr -> Count(block_ptr, 1);
+    }
+  }
+
+  void JSContextHandles::Release(JSContextHandleBlock* block_ptr) HAL_NOEXCEPT {
+    const auto scope_ptr = GetActiveScope();
+    if (scope_ptr) {
+      scope_ptr -> Count(block_ptr, -1);
+    }
+
+    // The common case: other uncaptured handles remain afterwards.
+    auto handle_count = block_ptr -> handle_count.load();
+    while (handle_count > block_ptr -> captured_count.load() + 1) {
+      if (block_ptr -> handle_count.compare_exchange_weak(handle_count, handle_count - 1)) {
+        return;
+      }
+    }
+
+    std::vector<Owner*> owners;
+    {
+      std::lock_guard<std::mutex> lock(handles_mutex);
+      handle_count = --block_ptr -> handle_count;
+      if (handle_count == 0) {
+        handle_blocks.erase(block_ptr -> js_global_context_ref);
+        delete block_ptr;
+        return;
+      }
+
+      if (handle_count != block_ptr -> captured_count) {
+        return;
+      }
+
+      // Only captured handles are left. The owners' references move
+      // to this thread.
+      owners.assign(block_ptr -> owners.begin(), block_ptr -> owners.end());
+      block_ptr -> owners.clear();
+      block_ptr -> captured_count = 0;
+      for (const auto owner_ptr : owners) {
+        owner_ptr -> block_ptr__     = nullptr;
+        owner_ptr -> capture_count__ = 0;
+      }
+    }
+
+    // Dropping releases the captured handles, which may delete the
+    // block.
+    for (const auto owner_ptr : owners) {
+      owner_ptr -> DropCaptures();
+      owner_ptr -> Release();
+    }
+  }
+
+}} // namespace HAL { namespace detail {
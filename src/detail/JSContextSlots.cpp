@@ -0,0 +1,276 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/detail/JSContextSlots.hpp"
+#include "HAL/JSString.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace HAL { namespace detail {
+
+  namespace {
+
+    typedef std::vector<std::shared_ptr<void>> NativeSlots;
+
+    struct GroupTable {
+      std::mutex  mutex;
+      NativeSlots native_slots;
+    };
+
+    std::atomic<std::size_t> next_value_index  { 0 };
+    std::atomic<std::size_t> next_native_index { 0 };
+    std::atomic<std::size_t> next_group_index  { 0 };
+    std::atomic<std::size_t> context_table_count { 0 };
+
+    // Only consulted when a context creates its table, so that the
+    // contexts of a group share one GroupTable.
+    std::mutex                                                       group_tables_mutex;
+    std::unordered_map<JSContextGroupRef, std::weak_ptr<GroupTable>> group_tables;
+
+    // The private data of a holder object.
+    struct ContextTable {
+      ContextTable(JSGlobalContextRef global_context_ref, JSContextGroupRef group_ref, std::shared_ptr<GroupTable> group_table) HAL_NOEXCEPT
+      : global_context_ref(global_context_ref)
+      , group_ref(group_ref)
+      , group_table(std::move(group_table)) {
+        ++context_table_count;
+      }
+
+      ~ContextTable() HAL_NOEXCEPT {
+        --context_table_count;
+      }
+
+      JSGlobalContextRef          global_context_ref;
+      JSContextGroupRef           group_ref;
+      JSObjectRef                 holder_ref    { nullptr };
+      bool                        native_access { false };
+      std::shared_ptr<GroupTable> group_table;
+      std::mutex                  mutex;
+      NativeSlots                 native_slots;
+    };
+
+    // Lets HAL through the holder's property callbacks, which turn
+    // away everyone else.
+    class NativeAccess final {
+    public:
+      explicit NativeAccess(ContextTable& table) HAL_NOEXCEPT
+      : table__(table) {
+        table__.native_access = true;
+      }
+
+      ~NativeAccess() HAL_NOEXCEPT {
+        table__.native_access = false;
+      }
+
+    private:
+      NativeAccess(const NativeAccess&)            = delete;
+      NativeAccess& operator=(const NativeAccess&) = delete;
+
+      ContextTable& table__;
+    };
+
+    std::shared_ptr<GroupTable> GetGroupTable(JSContextGroupRef group_ref) {
+      std::lock_guard<std::mutex> lock(group_tables_mutex);
+      auto& weak_group_table = group_tables[group_ref];
+      auto  group_table      = weak_group_table.lock();
+      if (!group_table) {
+        group_table      = std::make_shared<GroupTable>();
+        weak_group_table = group_table;
+      }
+      return group_table;
+    }
+
+    bool IsNativeAccess(JSObjectRef object_ref) HAL_NOEXCEPT {
+      const auto table_ptr = static_cast<ContextTable*>(JSObjectGetPrivate(object_ref));
+      return table_ptr && table_ptr -> native_access;
+    }
+
+    JSValueRef MakeAccessError(JSContextRef context_ref) HAL_NOEXCEPT {
+      static const JSString message("HAL context slots are not accessible from JavaScript");
+      const JSValueRef arguments[] = { JSValueMakeString(context_ref, static_cast<JSStringRef>(message)) };
+      return JSObjectMakeError(context_ref, 1, arguments, nullptr);
+    }
+
+    JSValueRef GetProperty(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef, JSValueRef* exception) {
+      if (!IsNativeAccess(object_ref)) {
+        *exception = MakeAccessError(context_ref);
+      }
+      return nullptr;
+    }
+
+    bool SetProperty(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef, JSValueRef, JSValueRef* exception) {
+      if (IsNativeAccess(object_ref)) {
+        return false;
+      }
+      *exception = MakeAccessError(context_ref);
+      return true;
+    }
+
+    bool DeleteProperty(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef, JSValueRef* exception) {
+      if (IsNativeAccess(object_ref)) {
+        return false;
+      }
+      *exception = MakeAccessError(context_ref);
+      return true;
+    }
+
+    void Finalize(JSObjectRef object_ref) {
+      std::unique_ptr<ContextTable> table_ptr(static_cast<ContextTable*>(JSObjectGetPrivate(object_ref)));
+      if (!table_ptr) {
+        return;
+      }
+
+      // The slot values are destroyed here, the group's along with
+      // its last context.
+      const auto group_ref = table_ptr -> group_ref;
+      table_ptr.reset();
+
+      std::lock_guard<std::mutex> lock(group_tables_mutex);
+      const auto position = group_tables.find(group_ref);
+      if (position != group_tables.end() && position -> second.expired()) {
+        group_tables.erase(position);
+      }
+    }
+
+    JSClassRef GetHolderClass() {
+      static const JSClassRef js_class_ref = []() {
+        auto js_class_definition = kJSClassDefinitionEmpty;
+        js_class_definition.className      = "ContextSlots";
+        js_class_definition.attributes     = kJSClassAttributeNoAutomaticPrototype;
+        js_class_definition.getProperty    = GetProperty;
+        js_class_definition.setProperty    = SetProperty;
+        js_class_definition.deleteProperty = DeleteProperty;
+        js_class_definition.finalize       = Finalize;
+        return JSClassCreate(&js_class_definition);
+      }();
+      return js_class_ref;
+    }
+
+    const JSString& GetHolderName() {
+      static const JSString holder_name("__HALContextSlots");
+      return holder_name;
+    }
+
+    // Return the table of the global context of context_ref, or
+    // nullptr if it doesn't have one.
+    ContextTable* FindTable(JSContextRef context_ref) HAL_NOEXCEPT {
+      const auto global_object_ref = JSContextGetGlobalObject(context_ref);
+      const auto holder_ref        = JSObjectGetProperty(context_ref, global_object_ref, static_cast<JSStringRef>(GetHolderName()), nullptr);
+      if (holder_ref == nullptr || !JSValueIsObjectOfClass(context_ref, holder_ref, GetHolderClass())) {
+        return nullptr;
+      }
+
+      // Holders can be passed between the contexts of a group, so
+      // make sure this one belongs to context_ref.
+      const auto table_ptr = static_cast<ContextTable*>(JSObjectGetPrivate(JSValueToObject(context_ref, holder_ref, nullptr)));
+      return (table_ptr && table_ptr -> global_context_ref == JSContextGetGlobalContext(context_ref)) ? table_ptr : nullptr;
+    }
+
+    // Return the table of the global context of context_ref, creating
+    // it first if necessary. This returns nullptr only if a script
+    // has already taken the holder's name.
+    ContextTable* GetTable(JSContextRef context_ref) HAL_NOEXCEPT {
+      auto table_ptr = FindTable(context_ref);
+      if (table_ptr) {
+        return table_ptr;
+      }
+
+      const auto group_ref = JSContextGetGroup(context_ref);
+      table_ptr = new ContextTable(JSContextGetGlobalContext(context_ref), group_ref, GetGroupTable(group_ref));
+
+      // From here on the holder's finalizer owns the table.
+      table_ptr -> holder_ref = JSObjectMake(context_ref, GetHolderClass(), table_ptr);
+      JSObjectSetProperty(context_ref, JSContextGetGlobalObject(context_ref), static_cast<JSStringRef>(GetHolderName()), table_ptr -> holder_ref, kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontEnum | kJSPropertyAttributeDontDelete, nullptr);
+      return FindTable(context_ref);
+    }
+
+    void* GetNativeSlot(std::mutex& mutex, const NativeSlots& native_slots, std::size_t index) HAL_NOEXCEPT {
+      std::lock_guard<std::mutex> lock(mutex);
+      return index < native_slots.size() ? native_slots[index].get() : nullptr;
+    }
+
+    void SetNativeSlot(std::mutex& mutex, NativeSlots& native_slots, std::size_t index, std::shared_ptr<void>& value) HAL_NOEXCEPT {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (index >= native_slots.size()) {
+        native_slots.resize(index + 1);
+      }
+      native_slots[index].swap(value);
+    }
+
+  } // namespace {
+
+  std::size_t JSContextSlots::AllocateIndex() HAL_NOEXCEPT {
+    return next_value_index++;
+  }
+
+  JSValueRef JSContextSlots::GetValue(JSContextRef context_ref, std::size_t index) HAL_NOEXCEPT {
+    const auto table_ptr = FindTable(context_ref);
+    if (table_ptr == nullptr) {
+      return nullptr;
+    }
+
+    NativeAccess native_access(*table_ptr);
+    const auto value_ref = JSObjectGetPropertyAtIndex(context_ref, table_ptr -> holder_ref, static_cast<unsigned>(index), nullptr);
+    return (value_ref && !JSValueIsUndefined(context_ref, value_ref)) ? value_ref : nullptr;
+  }
+
+  void JSContextSlots::SetValue(JSContextRef context_ref, std::size_t index, JSValueRef value) HAL_NOEXCEPT {
+    const auto table_ptr = GetTable(context_ref);
+    if (table_ptr == nullptr) {
+      return;
+    }
+
+    NativeAccess native_access(*table_ptr);
+    JSObjectSetPropertyAtIndex(context_ref, table_ptr -> holder_ref, static_cast<unsigned>(index), value ? value : JSValueMakeUndefined(context_ref), nullptr);
+  }
+
+  std::size_t JSContextSlots::AllocateNativeIndex() HAL_NOEXCEPT {
+    return next_native_index++;
+  }
+
+  void* JSContextSlots::GetNative(JSContextRef context_ref, std::size_t index) HAL_NOEXCEPT {
+    const auto table_ptr = FindTable(context_ref);
+    return table_ptr ? GetNativeSlot(table_ptr -> mutex, table_ptr -> native_slots, index) : nullptr;
+  }
+
+  void JSContextSlots::SetNative(JSContextRef context_ref, std::size_t index, std::shared_ptr<void> value) HAL_NOEXCEPT {
+    const auto table_ptr = GetTable(context_ref);
+    if (table_ptr) {
+      SetNativeSlot(table_ptr -> mutex, table_ptr -> native_slots, index, value);
+    }
+
+    // value now holds the previous value, which is destroyed here,
+    // outside the lock.
+  }
+
+  std::size_t JSContextSlots::AllocateGroupIndex() HAL_NOEXCEPT {
+    return next_group_index++;
+  }
+
+  void* JSContextSlots::GetGroupNative(JSContextRef context_ref, std::size_t index) HAL_NOEXCEPT {
+    const auto table_ptr = FindTable(context_ref);
+    return table_ptr ? GetNativeSlot(table_ptr -> group_table -> mutex, table_ptr -> group_table -> native_slots, index) : nullptr;
+  }
+
+  void JSContextSlots::SetGroupNative(JSContextRef context_ref, std::size_t index, std::shared_ptr<void> value) HAL_NOEXCEPT {
+    // The group table lives as long as any context of the group that
+    // has a table, so make sure this one does.
+    const auto table_ptr = GetTable(context_ref);
+    if (table_ptr) {
+      SetNativeSlot(table_ptr -> group_table -> mutex, table_ptr -> group_table -> native_slots, index, value);
+    }
+  }
+
+  std::size_t JSContextSlots::GetCount() HAL_NOEXCEPT {
+    return context_table_count;
+  }
+
+}} // namespace HAL { namespace detail {
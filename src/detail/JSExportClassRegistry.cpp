@@ -0,0 +1,116 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/detail/JSExportClassRegistry.hpp"
+#include "HAL/JSExport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace HAL { namespace detail {
+
+  namespace {
+
+    struct Registration {
+      std::string                           name;
+      JSExportClassRegistry::WarmUpCallback warm_up_callback;
+    };
+
+    // Classes register themselves during static initialization, so
+    // the registry must be constructed on first use.
+    std::mutex& GetRegistryMutex() {
+      static std::mutex registry_mutex;
+      return registry_mutex;
+    }
+
+    std::vector<Registration>& GetRegistry() {
+      static std::vector<Registration> registry;
+      return registry;
+    }
+
+  } // namespace {
+
+  bool JSExportClassRegistry::Register(const std::string& name, WarmUpCallback warm_up_callback) {
+    std::lock_guard<std::mutex> lock(GetRegistryMutex());
+    GetRegistry().push_back({name, warm_up_callback});
+    return true;
+  }
+
+  std::size_t JSExportClassRegistry::GetCount() HAL_NOEXCEPT {
+    std::lock_guard<std::mutex> lock(GetRegistryMutex());
+    return GetRegistry().size();
+  }
+
+  std::vector<JSExportClassWarmUp> JSExportClassRegistry::WarmUp(std::size_t thread_count) {
+    std::vector<Registration> registry;
+    {
+      std::lock_guard<std::mutex> lock(GetRegistryMutex());
+      registry = GetRegistry();
+    }
+
+    if (thread_count == 0) {
+      thread_count = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    thread_count = std::min(thread_count, registry.size());
+
+    std::vector<JSExportClassWarmUp> warm_ups(registry.size());
+    std::atomic<std::size_t>         next_index { 0 };
+    std::mutex                       exception_mutex;
+    std::exception_ptr               exception_ptr;
+
+    const auto worker = [&]() {
+      for (std::size_t index = next_index++; index < registry.size(); index = next_index++) {
+        const auto start = std::chrono::steady_clock::now();
+        try {
+          registry[index].warm_up_callback();
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(exception_mutex);
+          if (!exception_ptr) {
+            exception_ptr = std::current_exception();
+          }
+        }
+        warm_ups[index].name     = registry[index].name;
+        warm_ups[index].duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < thread_count; ++i) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    if (exception_ptr) {
+      std::rethrow_exception(exception_ptr);
+    }
+
+#ifdef HAL_LOGGING_ENABLE_INFO
+    for (const auto& warm_up : warm_ups) {
+      HAL_LOG_INFO("JSExportClassRegistry::WarmUp: ", warm_up.name, " took ", warm_up.duration.count(), "us");
+    }
+#endif
+
+    return warm_ups;
+  }
+
+}} // namespace HAL { namespace detail {
+
+namespace HAL {
+
+  std::vector<detail::JSExportClassWarmUp> WarmUpClasses(std::size_t thread_count) {
+    return detail::JSExportClassRegistry::WarmUp(thread_count);
+  }
+
+} // namespace HAL {
@@ -0,0 +1,179 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/detail/JSExportError.hpp"
+#include "HAL/detail/JSBuiltins.hpp"
+#include "HAL/JSError.hpp"
+#include "HAL/JSString.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+
+namespace HAL { namespace detail {
+
+  namespace {
+
+    std::atomic<std::size_t> error_count { 0 };
+
+    // The private data of an Error. A field whose bit is set in
+    // assigned has been replaced by an ordinary property.
+    struct ErrorFields {
+      ErrorFields() HAL_NOEXCEPT {
+        ++error_count;
+      }
+
+      ~ErrorFields() HAL_NOEXCEPT {
+        --error_count;
+      }
+
+      std::string   message;
+      std::string   name;
+      std::string   file_name;
+      std::uint32_t line_number { 0 };
+      std::string   stack;
+      std::string   native_stack;
+      unsigned      assigned    { 0 };
+
+      // The frames behind native_stack for an Error created for a C++
+      // exception, formatted only when JavaScript reads them.
+      std::deque<std::string> native_stack_frames;
+    };
+
+    enum Field : unsigned {
+      MessageField     = 1 << 0,
+      NameField        = 1 << 1,
+      FileNameField    = 1 << 2,
+      LineNumberField  = 1 << 3,
+      StackField       = 1 << 4,
+      NativeStackField = 1 << 5
+    };
+
+    // Return the fields of object_ref unless field has been assigned.
+    ErrorFields* GetFields(JSObjectRef object_ref, Field field) HAL_NOEXCEPT {
+      const auto fields_ptr = static_cast<ErrorFields*>(JSObjectGetPrivate(object_ref));
+      return (fields_ptr && !(fields_ptr -> assigned & field)) ? fields_ptr : nullptr;
+    }
+
+    JSValueRef MakeString(JSContextRef context_ref, const std::string& value) {
+      return JSValueMakeString(context_ref, static_cast<JSStringRef>(JSString(value)));
+    }
+
+    template<Field field, std::string ErrorFields::* member>
+    JSValueRef GetStringField(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef, JSValueRef*) {
+      const auto fields_ptr = GetFields(object_ref, field);
+      return fields_ptr ? MakeString(context_ref, fields_ptr ->* member) : nullptr;
+    }
+
+    JSValueRef GetNativeStackFrames(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef, JSValueRef*) {
+      const auto fields_ptr = GetFields(object_ref, NativeStackField);
+      return fields_ptr ? MakeString(context_ref, JSError::GetNativeStack(fields_ptr -> native_stack_frames)) : nullptr;
+    }
+
+    JSValueRef GetLineNumber(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef, JSValueRef*) {
+      const auto fields_ptr = GetFields(object_ref, LineNumberField);
+      return fields_ptr ? JSValueMakeNumber(context_ref, fields_ptr -> line_number) : nullptr;
+    }
+
+    // Returning false lets JavaScriptCore store value as an ordinary
+    // property, which the getter then stops hiding.
+    template<Field field>
+    bool SetField(JSContextRef, JSObjectRef object_ref, JSStringRef, JSValueRef, JSValueRef*) {
+      const auto fields_ptr = static_cast<ErrorFields*>(JSObjectGetPrivate(object_ref));
+      if (fields_ptr) {
+        fields_ptr -> assigned |= field;
+      }
+      return false;
+    }
+
+    void Finalize(JSObjectRef object_ref) {
+      delete static_cast<ErrorFields*>(JSObjectGetPrivate(object_ref));
+    }
+
+    JSClassRef CreateErrorClass(const JSStaticValue* static_values) {
+      auto js_class_definition = kJSClassDefinitionEmpty;
+      js_class_definition.className    = "Error";
+      js_class_definition.attributes   = kJSClassAttributeNoAutomaticPrototype;
+      js_class_definition.staticValues = static_values;
+      js_class_definition.finalize     = Finalize;
+      return JSClassCreate(&js_class_definition);
+    }
+
+    // An Error created for a C++ exception.
+    JSClassRef GetNativeErrorClass() {
+      static const JSStaticValue static_values[] = {
+        { "message"    , GetStringField<MessageField    , &ErrorFields::message     >, SetField<MessageField    >, kJSPropertyAttributeDontEnum },
+        { "name"       , GetStringField<NameField       , &ErrorFields::name        >, SetField<NameField       >, kJSPropertyAttributeNone     },
+        { "nativeStack", GetNativeStackFrames                                         , SetField<NativeStackField>, kJSPropertyAttributeNone     },
+        { nullptr      , nullptr                                                      , nullptr                   , kJSPropertyAttributeNone     }
+      };
+      static const JSClassRef js_class_ref = CreateErrorClass(static_values);
+      return js_class_ref;
+    }
+
+    // An Error restored from a js_runtime_error.
+    JSClassRef GetRuntimeErrorClass() {
+      static const JSStaticValue static_values[] = {
+        { "message"    , GetStringField<MessageField    , &ErrorFields::message     >, SetField<MessageField    >, kJSPropertyAttributeDontEnum },
+        { "name"       , GetStringField<NameField       , &ErrorFields::name        >, SetField<NameField       >, kJSPropertyAttributeNone     },
+        { "fileName"   , GetStringField<FileNameField   , &ErrorFields::file_name   >, SetField<FileNameField   >, kJSPropertyAttributeNone     },
+        { "lineNumber" , GetLineNumber                                                , SetField<LineNumberField >, kJSPropertyAttributeNone     },
+        { "stack"      , GetStringField<StackField      , &ErrorFields::stack       >, SetField<StackField      >, kJSPropertyAttributeNone     },
+        { "nativeStack", GetStringField<NativeStackField, &ErrorFields::native_stack>, SetField<NativeStackField>, kJSPropertyAttributeNone     },
+        { nullptr      , nullptr                                                      , nullptr                   , kJSPropertyAttributeNone     }
+      };
+      static const JSClassRef js_class_ref = CreateErrorClass(static_values);
+      return js_class_ref;
+    }
+
+    // Create an object of js_class_ref serving error_fields whose
+    // prototype is prototype_ref.
+    JSObjectRef MakeError(JSContextRef context_ref, JSClassRef js_class_ref, ErrorFields* error_fields, JSObjectRef prototype_ref) {
+      const auto error_ref = JSObjectMake(context_ref, js_class_ref, error_fields);
+      if (prototype_ref) {
+        JSObjectSetPrototype(context_ref, error_ref, prototype_ref);
+      }
+      return error_ref;
+    }
+
+  } // namespace {
+
+  JSValueRef JSExportError::Create(JSContextRef context_ref, const std::string& name, const std::string& message) {
+    // Only JavaScriptCore can capture the JavaScript stack, which it
+    // does when it constructs an Error. Inheriting from that Error
+    // serves its 'stack', which JavaScriptCore only formats when it
+    // is read, without copying it.
+    JSValueRef exception { nullptr };
+    auto prototype_ref = JSObjectMakeError(context_ref, 0, nullptr, &exception);
+    if (prototype_ref == nullptr) {
+      prototype_ref = JSBuiltins::GetErrorPrototype(context_ref);
+    }
+
+    const auto error_fields = new ErrorFields();
+    error_fields -> message             = message;
+    error_fields -> name                = name;
+    error_fields -> native_stack_frames = JSError::NativeStack__;
+    return MakeError(context_ref, GetNativeErrorClass(), error_fields, prototype_ref);
+  }
+
+  JSValueRef JSExportError::Create(JSContextRef context_ref, const js_runtime_error& e) {
+    const auto error_fields = new ErrorFields();
+    error_fields -> message      = e.js_message();
+    error_fields -> name         = e.js_name();
+    error_fields -> file_name    = e.js_filename();
+    error_fields -> line_number  = e.js_linenumber();
+    error_fields -> stack        = e.js_stack();
+    error_fields -> native_stack = e.js_nativeStack();
+    return MakeError(context_ref, GetRuntimeErrorClass(), error_fields, JSBuiltins::GetErrorPrototype(context_ref));
+  }
+
+  std::size_t JSExportError::GetCount() HAL_NOEXCEPT {
+    return error_count;
+  }
+
+}} // namespace HAL { namespace detail {
@@ -0,0 +1,143 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/detail/JSExportFinalizerQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace HAL { namespace detail {
+  
+  namespace {
+    
+    typedef JSExportFinalizerQueue::Node FinalizerNode;
+    
+    // Both queues are intrusive lock-free stacks of the nodes embedded
+    // in the native objects, so enqueueing never allocates. Producers
+    // push with a compare-and-swap, and the consumer takes the whole
+    // stack at once with an exchange, so there is no ABA problem.
+    std::atomic<FinalizerNode*> deferred_queue { nullptr };
+    std::atomic<FinalizerNode*> background_queue { nullptr };
+    std::atomic<std::size_t>    deferred_count { 0 };
+    std::atomic<bool>           background_stopped { false };
+    
+    void Push(std::atomic<FinalizerNode*>& queue, FinalizerNode* node_ptr) HAL_NOEXCEPT {
+      node_ptr -> next = queue.load(std::memory_order_relaxed);
+      while (!queue.compare_exchange_weak(node_ptr -> next, node_ptr, std::memory_order_release, std::memory_order_relaxed)) {
+      }
+    }
+    
+    // Run the finalizers of a stack taken from one of the queues in
+    // the order they were pushed. A finalizer destroys the node along
+    // with its native object, so read next first.
+    std::size_t Run(FinalizerNode* node_ptr) {
+      FinalizerNode* reversed_ptr = nullptr;
+      while (node_ptr) {
+        FinalizerNode* next_ptr = node_ptr -> next;
+        node_ptr -> next = reversed_ptr;
+        reversed_ptr     = node_ptr;
+        node_ptr         = next_ptr;
+      }
+      
+      std::size_t count = 0;
+      while (reversed_ptr) {
+        FinalizerNode* next_ptr = reversed_ptr -> next;
+        try {
+          reversed_ptr -> finalizer(reversed_ptr -> native_object_ptr);
+        } catch (const std::exception& e) {
+          HAL_LOG_ERROR("JSExportFinalizerQueue: finalizer threw ", e.what());
+        } catch (...) {
+          HAL_LOG_ERROR("JSExportFinalizerQueue: finalizer threw unknown exception");
+        }
+        reversed_ptr = next_ptr;
+        ++count;
+      }
+      return count;
+    }
+    
+    class BackgroundFinalizer final {
+      
+    public:
+      
+      BackgroundFinalizer()
+      : thread__(&BackgroundFinalizer::Main, this) {
+      }
+      
+      // Finish the queued work and stop when the process exits.
+      ~BackgroundFinalizer() {
+        {
+          std::lock_guard<std::mutex> lock(mutex__);
+          stopped__ = true;
+        }
+        background_stopped = true;
+        condition__.notify_one();
+        thread__.join();
+      }
+      
+      void Notify() {
+        condition__.notify_one();
+      }
+      
+    private:
+      
+      void Main() {
+        std::unique_lock<std::mutex> lock(mutex__);
+        while (true) {
+          // Producers notify without taking the mutex, so poll as well
+          // in case a notification is missed.
+          condition__.wait_for(lock, std::chrono::milliseconds(50), [this] {
+            return stopped__ || background_queue.load() != nullptr;
+          });
+          const bool stopped = stopped__;
+          lock.unlock();
+          Run(background_queue.exchange(nullptr, std::memory_order_acquire));
+          lock.lock();
+          if (stopped) {
+            break;
+          }
+        }
+      }
+      
+      std::mutex              mutex__;
+      std::condition_variable condition__;
+      bool                    stopped__ { false };
+      std::thread             thread__;
+    };
+    
+  } // namespace {
+  
+  void JSExportFinalizerQueue::Enqueue(Node* node_ptr) HAL_NOEXCEPT {
+    Push(deferred_queue, node_ptr);
+    ++deferred_count;
+  }
+  
+  void JSExportFinalizerQueue::EnqueueBackground(Node* node_ptr) {
+    if (background_stopped) {
+      node_ptr -> finalizer(node_ptr -> native_object_ptr);
+      return;
+    }
+    
+    static BackgroundFinalizer background_finalizer;
+    Push(background_queue, node_ptr);
+    background_finalizer.Notify();
+  }
+  
+  std::size_t JSExportFinalizerQueue::Drain() {
+    const auto count = Run(deferred_queue.exchange(nullptr, std::memory_order_acquire));
+    deferred_count -= count;
+    return count;
+  }
+  
+  std::size_t JSExportFinalizerQueue::GetPendingCount() HAL_NOEXCEPT {
+    return deferred_count;
+  }
+  
+}} // namespace HAL { namespace detail {
@@ -0,0 +1,31 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/detail/JSExportIdentityMap.hpp"
+#include "HAL/JSExportObject.hpp"
+
+namespace HAL { namespace detail {
+
+  // Native objects only ever belong to the global context they were
+  // created in, which is the one that registers them.
+  void JSExportIdentityMap::Register(JSContextRef, JSExportObject* native_object_ptr, JSObjectRef object_ref) HAL_NOEXCEPT {
+    native_object_ptr -> identity_map_entry__.object_ref__ = object_ref;
+  }
+
+  void JSExportIdentityMap::UnRegister(JSContextRef, JSExportObject* native_object_ptr) HAL_NOEXCEPT {
+    native_object_ptr -> identity_map_entry__.object_ref__ = nullptr;
+  }
+
+  JSObjectRef JSExportIdentityMap::Find(JSContextRef context_ref, const JSExportObject* native_object_ptr) HAL_NOEXCEPT {
+    if (JSContextGetGlobalContext(context_ref) != static_cast<JSContextRef>(native_object_ptr -> js_context__)) {
+      return nullptr;
+    }
+    return native_object_ptr -> identity_map_entry__.object_ref__;
+  }
+
+}} // namespace HAL { namespace detail {
@@ -0,0 +1,53 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/detail/JSExportTypeTag.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace HAL { namespace detail {
+  
+  namespace {
+    std::mutex                                           registry_mutex;
+    std::unordered_map<JSClassRef, const JSExportTypeTag*> registry;
+  } // namespace {
+  
+  const JSExportTypeTag* JSExportTypeTag::Register(JSClassRef js_class_ref, JSClassRef parent_js_class_ref) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    
+    const auto position = registry.find(js_class_ref);
+    if (position != registry.end()) {
+      return position -> second;
+    }
+    
+    const auto parent_position = registry.find(parent_js_class_ref);
+    const auto parent_ptr      = parent_position != registry.end() ? parent_position -> second : nullptr;
+    
+    const auto type_id = static_cast<std::uint32_t>(registry.size());
+    const auto tag_ptr = new JSExportTypeTag(type_id, parent_ptr);
+    registry.emplace(js_class_ref, tag_ptr);
+    
+    HAL_LOG_DEBUG("JSExportTypeTag: registered type id ", type_id, " for JSClassRef ", js_class_ref, " with parent ", parent_js_class_ref);
+    return tag_ptr;
+  }
+  
+  JSExportTypeTag::JSExportTypeTag(std::uint32_t type_id, const JSExportTypeTag* parent_ptr)
+  : type_id__(type_id) {
+    if (parent_ptr) {
+      ancestors__ = parent_ptr -> ancestors__;
+    }
+    
+    const std::size_t word = type_id / 64;
+    if (ancestors__.size() <= word) {
+      ancestors__.resize(word + 1, 0);
+    }
+    ancestors__[word] |= std::uint64_t(1) << (type_id % 64);
+  }
+  
+}} // namespace HAL { namespace detail {
@@ -0,0 +1,222 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/detail/JSFunctionCache.hpp"
+#include "HAL/detail/JSContextSlots.hpp"
+#include "HAL/JSString.hpp"
+
+#include <list>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace HAL { namespace detail {
+
+  namespace {
+
+    struct FunctionCacheEntry {
+      // The index of the function in the holder object.
+      unsigned                               index;
+      std::list<const std::string*>::iterator lru_position;
+    };
+
+    // The native half of a context's cache. The functions themselves
+    // are the indexed properties of the holder object, so destroying
+    // this never calls JavaScriptCore.
+    struct FunctionCache {
+      std::mutex                                          mutex;
+      std::size_t                                         capacity { 0 };
+      std::unordered_map<std::string, FunctionCacheEntry> entries;
+      // The most recently used key is at the front.
+      std::list<const std::string*>                       lru;
+      std::vector<unsigned>                               free_indices;
+      unsigned                                            next_index { 0 };
+      JSFunctionCacheStatistics                           statistics;
+    };
+
+    std::size_t GetCacheIndex() HAL_NOEXCEPT {
+      static const std::size_t index = JSContextSlots::AllocateNativeIndex();
+      return index;
+    }
+
+    std::size_t GetHolderIndex() HAL_NOEXCEPT {
+      static const std::size_t index = JSContextSlots::AllocateIndex();
+      return index;
+    }
+
+    FunctionCache* FindCache(JSContextRef context_ref) HAL_NOEXCEPT {
+      return static_cast<FunctionCache*>(JSContextSlots::GetNative(context_ref, GetCacheIndex()));
+    }
+
+    JSObjectRef GetHolder(JSContextRef context_ref) HAL_NOEXCEPT {
+      const auto holder_ref = JSContextSlots::GetValue(context_ref, GetHolderIndex());
+      if (holder_ref) {
+        return JSValueToObject(context_ref, holder_ref, nullptr);
+      }
+
+      const auto new_holder_ref = JSObjectMake(context_ref, nullptr, nullptr);
+      JSContextSlots::SetValue(context_ref, GetHolderIndex(), new_holder_ref);
+      return new_holder_ref;
+    }
+
+  } // namespace {
+
+  bool JSFunctionCache::IsEnabled(JSContextRef context_ref) HAL_NOEXCEPT {
+    const auto cache_ptr = FindCache(context_ref);
+    if (cache_ptr == nullptr) {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(cache_ptr -> mutex);
+    return cache_ptr -> capacity > 0;
+  }
+
+  std::string JSFunctionCache::MakeKey(const JSString& body, const std::vector<JSString>& parameter_names, const JSString& function_name, const JSString& source_url, int starting_line_number) {
+    // NUL can't appear in an identifier, so it separates the parts
+    // unambiguously. The body goes last since it may contain NUL.
+    std::string key = std::to_string(starting_line_number);
+    key += '\0';
+    key += static_cast<std::string>(function_name);
+    key += '\0';
+    key += static_cast<std::string>(source_url);
+    key += '\0';
+    for (const auto& parameter_name : parameter_names) {
+      key += static_cast<std::string>(parameter_name);
+      key += '\0';
+    }
+    key += '\0';
+    key += static_cast<std::string>(body);
+    return key;
+  }
+
+  JSObjectRef JSFunctionCache::Find(JSContextRef context_ref, const std::string& key) HAL_NOEXCEPT {
+    const auto cache_ptr = FindCache(context_ref);
+    if (cache_ptr == nullptr) {
+      return nullptr;
+    }
+
+    unsigned index = 0;
+    {
+      std::lock_guard<std::mutex> lock(cache_ptr -> mutex);
+      const auto position = cache_ptr -> entries.find(key);
+      if (position == cache_ptr -> entries.end()) {
+        ++cache_ptr -> statistics.miss_count;
+        return nullptr;
+      }
+      ++cache_ptr -> statistics.hit_count;
+      cache_ptr -> lru.splice(cache_ptr -> lru.begin(), cache_ptr -> lru, position -> second.lru_position);
+      index = position -> second.index;
+    }
+
+    const auto function_ref = JSObjectGetPropertyAtIndex(context_ref, GetHolder(context_ref), index, nullptr);
+    return (function_ref && JSValueIsObject(context_ref, function_ref)) ? JSValueToObject(context_ref, function_ref, nullptr) : nullptr;
+  }
+
+  void JSFunctionCache::Insert(JSContextRef context_ref, const std::string& key, JSObjectRef function_ref) HAL_NOEXCEPT {
+    const auto cache_ptr = FindCache(context_ref);
+    if (cache_ptr == nullptr) {
+      return;
+    }
+
+    bool     evicted       = false;
+    unsigned evicted_index = 0;
+    unsigned index         = 0;
+    {
+      std::lock_guard<std::mutex> lock(cache_ptr -> mutex);
+      if (cache_ptr -> capacity == 0 || cache_ptr -> entries.count(key) > 0) {
+        return;
+      }
+
+      if (cache_ptr -> entries.size() >= cache_ptr -> capacity) {
+        const auto evicted_position = cache_ptr -> entries.find(*cache_ptr -> lru.back());
+        evicted       = true;
+        evicted_index = evicted_position -> second.index;
+        cache_ptr -> lru.pop_back();
+        cache_ptr -> entries.erase(evicted_position);
+        cache_ptr -> free_indices.push_back(evicted_index);
+        ++cache_ptr -> statistics.eviction_count;
+      }
+
+      if (cache_ptr -> free_indices.empty()) {
+        index = cache_ptr -> next_index++;
+      } else {
+        index = cache_ptr -> free_indices.back();
+        cache_ptr -> free_indices.pop_back();
+      }
+
+      const auto position = cache_ptr -> entries.emplace(key, FunctionCacheEntry { index, cache_ptr -> lru.end() }).first;
+      cache_ptr -> lru.push_front(&position -> first);
+      position -> second.lru_position = cache_ptr -> lru.begin();
+    }
+
+    const auto holder_ref = GetHolder(context_ref);
+    if (evicted && evicted_index != index) {
+      JSObjectSetPropertyAtIndex(context_ref, holder_ref, evicted_index, JSValueMakeUndefined(context_ref), nullptr);
+    }
+    JSObjectSetPropertyAtIndex(context_ref, holder_ref, index, function_ref, nullptr);
+  }
+
+  void JSFunctionCache::SetCapacity(JSContextRef context_ref, std::size_t capacity) HAL_NOEXCEPT {
+    auto cache_ptr = FindCache(context_ref);
+    if (cache_ptr == nullptr) {
+      if (capacity == 0) {
+        return;
+      }
+      const auto new_cache_ptr = std::make_shared<FunctionCache>();
+      cache_ptr = new_cache_ptr.get();
+      JSContextSlots::SetNative(context_ref, GetCacheIndex(), new_cache_ptr);
+    }
+
+    bool shrunk = false;
+    {
+      std::lock_guard<std::mutex> lock(cache_ptr -> mutex);
+      cache_ptr -> capacity = capacity;
+      shrunk = cache_ptr -> entries.size() > capacity;
+    }
+
+    // Shrinking is rare enough to simply start over.
+    if (shrunk) {
+      Invalidate(context_ref);
+    }
+  }
+
+  JSFunctionCacheStatistics JSFunctionCache::GetStatistics(JSContextRef context_ref) HAL_NOEXCEPT {
+    const auto cache_ptr = FindCache(context_ref);
+    if (cache_ptr == nullptr) {
+      return JSFunctionCacheStatistics();
+    }
+
+    std::lock_guard<std::mutex> lock(cache_ptr -> mutex);
+    auto statistics = cache_ptr -> statistics;
+    statistics.size     = cache_ptr -> entries.size();
+    statistics.capacity = cache_ptr -> capacity;
+    return statistics;
+  }
+
+  void JSFunctionCache::Invalidate(JSContextRef context_ref) HAL_NOEXCEPT {
+    const auto cache_ptr = FindCache(context_ref);
+    if (cache_ptr == nullptr) {
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(cache_ptr -> mutex);
+      cache_ptr -> entries.clear();
+      cache_ptr -> lru.clear();
+      cache_ptr -> free_indices.clear();
+      cache_ptr -> next_index = 0;
+    }
+
+    // Replacing the holder lets the garbage collector have all of the
+    // cached functions at once.
+    JSContextSlots::SetValue(context_ref, GetHolderIndex(), JSObjectMake(context_ref, nullptr, nullptr));
+  }
+
+}} // namespace HAL { namespace detail {
@@ -0,0 +1,213 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/detail/JSFunctionClass.hpp"
+#include "HAL/detail/JSBuiltins.hpp"
+#include "HAL/detail/JSContextHandles.hpp"
+#include "HAL/detail/JSExportError.hpp"
+#include "HAL/JSError.hpp"
+#include "HAL/JSObject.hpp"
+#include "HAL/JSString.hpp"
+#include "HAL/JSValue.hpp"
+
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+namespace HAL { namespace detail {
+
+  namespace {
+
+    // The private data of a function object. At most one of the
+    // callbacks is set. A record that captured handles to its own
+    // context is shared with JSContextHandles, which empties it once
+    // those are the only handles left.
+    struct JSFunctionRecord final : public JSContextHandles::Owner {
+
+      explicit JSFunctionRecord(JSStringRef function_name_ref) HAL_NOEXCEPT
+      : name_ref(function_name_ref ? JSStringRetain(function_name_ref) : nullptr) {
+        ++record_count;
+      }
+
+      virtual ~JSFunctionRecord() HAL_NOEXCEPT {
+        if (name_ref) {
+          JSStringRelease(name_ref);
+        }
+        --record_count;
+      }
+
+      virtual void DropCaptures() HAL_NOEXCEPT override {
+        JSFunctionCallback       dropped_callback;
+        JSNativeFunctionCallback dropped_native_callback;
+        dropped_callback.swap(callback);
+        dropped_native_callback.swap(native_callback);
+      }
+
+      JSStringRef              name_ref;
+      JSFunctionCallback       callback;
+      JSNativeFunctionCallback native_callback;
+
+      static std::atomic<std::size_t> record_count;
+    };
+
+    std::atomic<std::size_t> JSFunctionRecord::record_count { 0 };
+
+    std::atomic<std::size_t> function_count { 0 };
+
+    // Return the JavaScript exception for a C++ exception thrown by a
+    // callback: the original fields of a JavaScript exception that
+    // passed through native code, a TypeError for an invalid argument
+    // and an Error otherwise.
+    JSValueRef MakeException(JSContextRef context_ref, const std::exception& e) {
+      const auto js_runtime_error_ptr = dynamic_cast<const js_runtime_error*>(&e);
+      if (js_runtime_error_ptr) {
+        return JSExportError::Create(context_ref, *js_runtime_error_ptr);
+      }
+
+      const JSString   message(e.what());
+      const JSValueRef message_ref = JSValueMakeString(context_ref, static_cast<JSStringRef>(message));
+      JSValueRef       exception { nullptr };
+      JSObjectRef      error_ref { nullptr };
+      const auto type_error_constructor_ref = dynamic_cast<const std::invalid_argument*>(&e) ? JSBuiltins::GetTypeErrorConstructor(context_ref) : nullptr;
+      if (type_error_constructor_ref) {
+        error_ref = JSObjectCallAsConstructor(context_ref, type_error_constructor_ref, 1, &message_ref, &exception);
+      } else {
+        error_ref = JSObjectMakeError(context_ref, 1, &message_ref, &exception);
+      }
+      return error_ref ? error_ref : exception;
+    }
+
+    JSValueRef CallAsFunction(JSContextRef context_ref, JSObjectRef function_ref, JSObjectRef this_object_ref, size_t argument_count, const JSValueRef arguments_array[], JSValueRef* exception) {
+      // JavaScriptCore only calls this for objects of our class, so
+      // the private data is always a record.
+      const auto record_ptr = static_cast<JSFunctionRecord*>(JSObjectGetPrivate(function_ref));
+
+      // C++ exceptions must not unwind through JavaScriptCore, so
+      // report them as JavaScript exceptions.
+      try {
+        if (record_ptr -> native_callback) {
+          return record_ptr -> native_callback(context_ref, argument_count, arguments_array);
+        }
+
+        // The handle keeps the callback from being dropped while it
+        // runs.
+        const auto js_context = JSContext(context_ref);
+        if (!record_ptr -> callback) {
+          return JSValueMakeUndefined(context_ref);
+        }
+
+        std::vector<JSValue> arguments;
+        arguments.reserve(argument_count);
+        for (size_t i = 0; i < argument_count; ++i) {
+          arguments.push_back(JSValue(js_context, arguments_array[i]));
+        }
+        auto this_object = JSObject(js_context, this_object_ref);
+        return static_cast<JSValueRef>(record_ptr -> callback(arguments, this_object));
+      } catch (const std::exception& e) {
+        *exception = MakeException(context_ref, e);
+        return nullptr;
+      } catch (...) {
+        *exception = MakeException(context_ref, std::runtime_error("unknown exception"));
+        return nullptr;
+      }
+    }
+
+    JSValueRef GetName(JSContextRef context_ref, JSObjectRef object_ref, JSStringRef, JSValueRef*) {
+      const auto record_ptr = static_cast<JSFunctionRecord*>(JSObjectGetPrivate(object_ref));
+      return (record_ptr && record_ptr -> name_ref) ? JSValueMakeString(context_ref, record_ptr -> name_ref) : nullptr;
+    }
+
+    void Finalize(JSObjectRef object_ref) {
+      const auto record_ptr = static_cast<JSFunctionRecord*>(JSObjectGetPrivate(object_ref));
+      JSContextHandles::Abandon(record_ptr);
+      record_ptr -> Release();
+      --function_count;
+    }
+
+    JSClassRef GetFunctionClass() {
+      static const JSStaticValue static_values[] = {
+        { "name" , GetName, nullptr, kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontEnum | kJSPropertyAttributeDontDelete },
+        { nullptr, nullptr, nullptr, kJSPropertyAttributeNone }
+      };
+      static const JSClassRef js_class_ref = []() {
+        auto js_class_definition = kJSClassDefinitionEmpty;
+        // Keeps Object.prototype.toString reporting "[object Function]".
+        js_class_definition.className      = "Function";
+        js_class_definition.staticValues   = static_values;
+        js_class_definition.callAsFunction = CallAsFunction;
+        js_class_definition.finalize       = Finalize;
+        return JSClassCreate(&js_class_definition);
+      }();
+      return js_class_ref;
+    }
+
+    JSObjectRef GetPrototype(JSContextRef context_ref, JSObjectRef object_ref) HAL_NOEXCEPT {
+      const auto prototype_ref = JSObjectGetPrototype(context_ref, object_ref);
+      return JSValueIsObject(context_ref, prototype_ref) ? JSValueToObject(context_ref, prototype_ref, nullptr) : nullptr;
+    }
+
+    // The new function object adopts record_ptr.
+    JSObjectRef MakeFunctionWithRecord(JSContextRef context_ref, JSFunctionRecord* record_ptr) {
+      const auto function_ref = JSObjectMake(context_ref, GetFunctionClass(), record_ptr);
+      ++function_count;
+
+      // JavaScriptCore gives the class one prototype per context,
+      // which starts out inheriting from Object.prototype. The first
+      // function of each context links it to Function.prototype, the
+      // only callable prototype it can have.
+      const auto class_prototype_ref = GetPrototype(context_ref, function_ref);
+      if (class_prototype_ref == nullptr) {
+        return function_ref;
+      }
+
+      const auto parent_prototype_ref = GetPrototype(context_ref, class_prototype_ref);
+      if (parent_prototype_ref == nullptr || !JSObjectIsFunction(context_ref, parent_prototype_ref)) {
+        const auto function_prototype_ref = JSBuiltins::GetFunctionPrototype(context_ref);
+        if (function_prototype_ref) {
+          JSObjectSetPrototype(context_ref, class_prototype_ref, function_prototype_ref);
+        }
+      }
+      return function_ref;
+    }
+
+  } // namespace {
+
+  JSObjectRef JSFunctionClass::MakeFunction(JSContextRef context_ref, JSStringRef function_name_ref, const JSFunctionCallback& callback) {
+    auto record_ptr = new JSFunctionRecord(function_name_ref);
+    {
+      JSContextHandles::CaptureScope capture_scope;
+      record_ptr -> callback = callback;
+      capture_scope.Adopt(context_ref, record_ptr);
+    }
+    return MakeFunctionWithRecord(context_ref, record_ptr);
+  }
+
+  JSObjectRef JSFunctionClass::MakeFunction(JSContextRef context_ref, JSStringRef function_name_ref, const JSNativeFunctionCallback& callback) {
+    auto record_ptr = new JSFunctionRecord(function_name_ref);
+    {
+      JSContextHandles::CaptureScope capture_scope;
+      record_ptr -> native_callback = callback;
+      capture_scope.Adopt(context_ref, record_ptr);
+    }
+    return MakeFunctionWithRecord(context_ref, record_ptr);
+  }
+
+  JSObjectRef JSFunctionClass::MakeFunction(JSContextRef context_ref, JSStringRef function_name_ref) {
+    return MakeFunctionWithRecord(context_ref, new JSFunctionRecord(function_name_ref));
+  }
+
+  std::size_t JSFunctionClass::GetCount() HAL_NOEXCEPT {
+    return function_count;
+  }
+
+  std::size_t JSFunctionClass::GetRecordCount() HAL_NOEXCEPT {
+    return JSFunctionRecord::record_count;
+  }
+
+}} // namespace HAL { namespace detail {
@@ -0,0 +1,243 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/detail/JSScriptCache.hpp"
+#include "HAL/JSString.hpp"
+
+#ifdef HAL_HAVE_JSSCRIPTREF
+#include <JavaScriptCore/JSScriptRefPrivate.h>
+#endif
+
+#include <list>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace HAL { namespace detail {
+
+  namespace {
+
+#ifndef HAL_HAVE_JSSCRIPTREF
+    // Only stored, never dereferenced, without the JSScriptRef API.
+    typedef struct OpaqueJSScript* JSScriptRef;
+#endif
+
+    struct ScriptCacheEntry {
+      JSScriptRef                             script_ref;
+      std::list<const std::string*>::iterator lru_position;
+    };
+
+    // The cache of one context group. Its scripts are released outside
+    // of the mutex, and never from a garbage collector callback.
+    struct ScriptCache {
+      std::size_t                                       capacity { 0 };
+      std::unordered_map<std::string, ScriptCacheEntry> entries;
+      // The most recently used key is at the front.
+      std::list<const std::string*>                     lru;
+      std::size_t                                       memory_used { 0 };
+      JSScriptCacheStatistics                           statistics;
+    };
+
+    std::mutex script_cache_mutex;
+    std::unordered_map<JSContextGroupRef, ScriptCache> script_caches;
+
+    // Remove every script from script_cache, returning them for the
+    // caller to release once it has unlocked script_cache_mutex.
+    std::vector<JSScriptRef> RemoveAll(ScriptCache& script_cache) {
+      std::vector<JSScriptRef> script_refs;
+      script_refs.reserve(script_cache.entries.size());
+      for (const auto& entry : script_cache.entries) {
+        script_refs.push_back(entry.second.script_ref);
+      }
+      script_cache.entries.clear();
+      script_cache.lru.clear();
+      script_cache.memory_used = 0;
+      return script_refs;
+    }
+
+    void ReleaseAll(const std::vector<JSScriptRef>& script_refs) HAL_NOEXCEPT {
+#ifdef HAL_HAVE_JSSCRIPTREF
+      for (const auto script_ref : script_refs) {
+        JSScriptRelease(script_ref);
+      }
+#else
+      (void)script_refs;
+#endif
+    }
+
+  } // namespace {
+
+  bool JSScriptCache::IsSupported() HAL_NOEXCEPT {
+#ifdef HAL_HAVE_JSSCRIPTREF
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  bool JSScriptCache::Evaluate(JSContextRef context_ref, const JSString& script, JSObjectRef this_object_ref, const JSString& source_url, int starting_line_number, JSValueRef* result_ref, JSValueRef* exception) HAL_NOEXCEPT {
+#ifdef HAL_HAVE_JSSCRIPTREF
+    const auto context_group_ref = JSContextGetGroup(context_ref);
+
+    // A quick check so that a disabled cache costs no key.
+    {
+      std::lock_guard<std::mutex> lock(script_cache_mutex);
+      const auto position = script_caches.find(context_group_ref);
+      if (position == script_caches.end() || position -> second.capacity == 0) {
+        return false;
+      }
+    }
+
+    // NUL can't appear in a line number or a URL, so it separates the
+    // parts unambiguously. The source goes last since it may contain
+    // NUL.
+    std::string key = std::to_string(starting_line_number);
+    key += '\0';
+    key += static_cast<std::string>(source_url);
+    key += '\0';
+    key += static_cast<std::string>(script);
+
+    JSScriptRef script_ref { nullptr };
+    {
+      std::lock_guard<std::mutex> lock(script_cache_mutex);
+      const auto cache_position = script_caches.find(context_group_ref);
+      if (cache_position == script_caches.end()) {
+        return false;
+      }
+      auto& script_cache = cache_position -> second;
+      const auto position = script_cache.entries.find(key);
+      if (position != script_cache.entries.end()) {
+        ++script_cache.statistics.hit_count;
+        script_cache.lru.splice(script_cache.lru.begin(), script_cache.lru, position -> second.lru_position);
+        script_ref = position -> second.script_ref;
+        // Keep it alive while it runs, even if it is evicted meanwhile.
+        JSScriptRetain(script_ref);
+      } else {
+        ++script_cache.statistics.miss_count;
+      }
+    }
+
+    if (script_ref == nullptr) {
+      const JSStringRef source_url_ref = (source_url.length() > 0) ? static_cast<JSStringRef>(source_url) : nullptr;
+      JSStringRef error_message_ref { nullptr };
+      int error_line { 0 };
+      script_ref = JSScriptCreateFromString(context_group_ref, source_url_ref, starting_line_number, static_cast<JSStringRef>(script), &error_message_ref, &error_line);
+      if (error_message_ref) {
+        JSStringRelease(error_message_ref);
+      }
+
+      // Let JSEvaluateScript report the syntax error.
+      if (script_ref == nullptr) {
+        return false;
+      }
+
+      std::vector<JSScriptRef> evicted_script_refs;
+      {
+        std::lock_guard<std::mutex> lock(script_cache_mutex);
+        // Another thread may have compiled the same script, or disabled
+        // the cache, while this one was compiling.
+        const auto cache_position = script_caches.find(context_group_ref);
+        if (cache_position != script_caches.end() && cache_position -> second.entries.count(key) == 0) {
+          auto& script_cache = cache_position -> second;
+          while (script_cache.entries.size() >= script_cache.capacity) {
+            const auto evicted_position = script_cache.entries.find(*script_cache.lru.back());
+            evicted_script_refs.push_back(evicted_position -> second.script_ref);
+            script_cache.memory_used -= evicted_position -> first.size();
+            script_cache.lru.pop_back();
+            script_cache.entries.erase(evicted_position);
+            ++script_cache.statistics.eviction_count;
+          }
+
+          JSScriptRetain(script_ref);
+          const auto position = script_cache.entries.emplace(std::move(key), ScriptCacheEntry { script_ref, script_cache.lru.end() }).first;
+          script_cache.lru.push_front(&position -> first);
+          position -> second.lru_position = script_cache.lru.begin();
+          script_cache.memory_used += position -> first.size();
+        }
+      }
+      ReleaseAll(evicted_script_refs);
+    }
+
+    *result_ref = JSScriptEvaluate(context_ref, script_ref, this_object_ref, exception);
+    JSScriptRelease(script_ref);
+    return true;
+#else
+    (void)context_ref;
+    (void)script;
+    (void)this_object_ref;
+    (void)source_url;
+    (void)starting_line_number;
+    (void)result_ref;
+    (void)exception;
+    return false;
+#endif
+  }
+
+  void JSScriptCache::SetCapacity(JSContextGroupRef context_group_ref, std::size_t capacity) HAL_NOEXCEPT {
+    std::vector<JSScriptRef> script_refs;
+    {
+      std::lock_guard<std::mutex> lock(script_cache_mutex);
+      const auto position = script_caches.find(context_group_ref);
+      if (position == script_caches.end()) {
+        if (capacity == 0) {
+          return;
+        }
+        // The key must not be reused by another context group while
+        // the cache is enabled.
+        JSContextGroupRetain(context_group_ref);
+        script_caches[context_group_ref].capacity = capacity;
+        return;
+      }
+
+      auto& script_cache = position -> second;
+      script_cache.capacity = capacity;
+
+      // Shrinking is rare enough to simply start over.
+      if (script_cache.entries.size() > capacity) {
+        script_refs = RemoveAll(script_cache);
+      }
+
+      if (capacity == 0) {
+        script_caches.erase(position);
+        JSContextGroupRelease(context_group_ref);
+      }
+    }
+    ReleaseAll(script_refs);
+  }
+
+  JSScriptCacheStatistics JSScriptCache::GetStatistics(JSContextGroupRef context_group_ref) HAL_NOEXCEPT {
+    std::lock_guard<std::mutex> lock(script_cache_mutex);
+    const auto position = script_caches.find(context_group_ref);
+    if (position == script_caches.end()) {
+      return JSScriptCacheStatistics();
+    }
+
+    const auto& script_cache = position -> second;
+    auto statistics = script_cache.statistics;
+    statistics.size        = script_cache.entries.size();
+    statistics.capacity    = script_cache.capacity;
+    statistics.memory_used = script_cache.memory_used;
+    return statistics;
+  }
+
+  void JSScriptCache::Clear(JSContextGroupRef context_group_ref) HAL_NOEXCEPT {
+    std::vector<JSScriptRef> script_refs;
+    {
+      std::lock_guard<std::mutex> lock(script_cache_mutex);
+      const auto position = script_caches.find(context_group_ref);
+      if (position == script_caches.end()) {
+        return;
+      }
+      script_refs = RemoveAll(position -> second);
+    }
+    ReleaseAll(script_refs);
+  }
+
+}} // namespace HAL { namespace detail {
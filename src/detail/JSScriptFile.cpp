@@ -0,0 +1,182 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/detail/JSScriptFile.hpp"
+#include "HAL/detail/JSUtil.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace HAL { namespace detail {
+
+  namespace {
+
+    // A read only mapping of a whole file, unmapped when destroyed.
+    class MappedFile final {
+
+    public:
+
+      explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        const HANDLE file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_handle == INVALID_HANDLE_VALUE) {
+          ThrowRuntimeError("JSScriptFile", "Unable to open " + path + ".");
+        }
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file_handle, &file_size)) {
+          CloseHandle(file_handle);
+          ThrowRuntimeError("JSScriptFile", "Unable to get the size of " + path + ".");
+        }
+        size__ = static_cast<std::size_t>(file_size.QuadPart);
+        if (size__ > 0) {
+          const HANDLE mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+          if (mapping_handle) {
+            data__ = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping_handle);
+          }
+        }
+        CloseHandle(file_handle);
+#else
+        const int file_descriptor = open(path.c_str(), O_RDONLY);
+        if (file_descriptor < 0) {
+          ThrowRuntimeError("JSScriptFile", "Unable to open " + path + ".");
+        }
+        struct stat file_status;
+        if (fstat(file_descriptor, &file_status) != 0) {
+          close(file_descriptor);
+          ThrowRuntimeError("JSScriptFile", "Unable to get the size of " + path + ".");
+        }
+        size__ = static_cast<std::size_t>(file_status.st_size);
+        if (size__ > 0) {
+          void* data = mmap(nullptr, size__, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+          if (data != MAP_FAILED) {
+            // The file is transcoded front to back exactly once.
+            madvise(data, size__, MADV_SEQUENTIAL);
+            data__ = static_cast<const char*>(data);
+          }
+        }
+        close(file_descriptor);
+#endif
+        if (size__ > 0 && data__ == nullptr) {
+          ThrowRuntimeError("JSScriptFile", "Unable to map " + path + ".");
+        }
+      }
+
+      ~MappedFile() {
+        if (data__) {
+#ifdef _WIN32
+          UnmapViewOfFile(data__);
+#else
+          munmap(const_cast<char*>(data__), size__);
+#endif
+        }
+      }
+
+      const char* data() const HAL_NOEXCEPT {
+        return data__;
+      }
+
+      std::size_t size() const HAL_NOEXCEPT {
+        return size__;
+      }
+
+    private:
+
+      MappedFile(const MappedFile&)            = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+      const char* data__ { nullptr };
+      std::size_t size__ { 0 };
+    };
+
+    const JSChar replacement_character = 0xFFFD;
+
+  } // namespace {
+
+  JSStringRef JSScriptFile::CreateString(const std::string& path) {
+    const MappedFile mapped_file(path);
+    return CreateString(mapped_file.data(), mapped_file.size());
+  }
+
+  JSStringRef JSScriptFile::CreateString(const char* utf8, std::size_t length) {
+    const auto bytes = reinterpret_cast<const unsigned char*>(utf8);
+    std::size_t i = 0;
+    if (length >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) {
+      i = 3;
+    }
+
+    // Transcode straight from the mapping into the only copy of the
+    // text. UTF-16 never needs more code units than UTF-8 needs bytes.
+    std::vector<JSChar> characters(length - i);
+    JSChar* output = characters.empty() ? nullptr : &characters[0];
+
+    while (i < length) {
+      // Runs of ASCII only need widening.
+      while (i < length && bytes[i] < 0x80) {
+        *output++ = bytes[i++];
+      }
+      if (i == length) {
+        break;
+      }
+
+      const unsigned char lead = bytes[i];
+      std::size_t   continuation_count = 0;
+      std::uint32_t code_point         = 0;
+      std::uint32_t minimum            = 0;
+      if ((lead & 0xE0) == 0xC0) {
+        continuation_count = 1;
+        code_point         = lead & 0x1F;
+        minimum            = 0x80;
+      } else if ((lead & 0xF0) == 0xE0) {
+        continuation_count = 2;
+        code_point         = lead & 0x0F;
+        minimum            = 0x800;
+      } else if ((lead & 0xF8) == 0xF0) {
+        continuation_count = 3;
+        code_point         = lead & 0x07;
+        minimum            = 0x10000;
+      } else {
+        *output++ = replacement_character;
+        ++i;
+        continue;
+      }
+
+      std::size_t sequence_length = 1;
+      while (sequence_length <= continuation_count && i + sequence_length < length && (bytes[i + sequence_length] & 0xC0) == 0x80) {
+        code_point = (code_point << 6) | (bytes[i + sequence_length] & 0x3F);
+        ++sequence_length;
+      }
+      i += sequence_length;
+
+      // Truncated, overlong, surrogate and out of range sequences.
+      if (sequence_length <= continuation_count || code_point < minimum || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+        *output++ = replacement_character;
+      } else if (code_point >= 0x10000) {
+        code_point -= 0x10000;
+        *output++ = static_cast<JSChar>(0xD800 + (code_point >> 10));
+        *output++ = static_cast<JSChar>(0xDC00 + (code_point & 0x3FF));
+      } else {
+        *output++ = static_cast<JSChar>(code_point);
+      }
+    }
+
+    const std::size_t character_count = characters.empty() ? 0 : static_cast<std::size_t>(output - &characters[0]);
+    return JSStringCreateWithCharacters(characters.empty() ? nullptr : &characters[0], character_count);
+  }
+
+}} // namespace HAL { namespace detail {
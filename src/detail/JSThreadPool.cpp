@@ -0,0 +1,67 @@
+/**
+ * HAL
+ *
+ * Copyright (c) 2014 by Appcelerator, Inc. All Rights Reserved.
+ * Licensed under the terms of the Apache Public License.
+ * Please see the LICENSE included with this distribution for details.
+ */
+
+#include "HAL/detail/JSThreadPool.hpp"
+
+#include <exception>
+#include <utility>
+
+namespace HAL { namespace detail {
+
+  JSThreadPool::JSThreadPool(std::size_t thread_count) HAL_NOEXCEPT
+  : thread_count__(thread_count > 0 ? thread_count : 1) {
+  }
+
+  JSThreadPool::~JSThreadPool() HAL_NOEXCEPT {
+    std::deque<std::function<void()>> dropped_work;
+    {
+      std::lock_guard<std::mutex> lock(mutex__);
+      stopping__ = true;
+      dropped_work.swap(work__);
+    }
+    work_condition__.notify_all();
+    for (auto& thread : threads__) {
+      thread.join();
+    }
+  }
+
+  void JSThreadPool::Post(std::function<void()> work) {
+    {
+      std::lock_guard<std::mutex> lock(mutex__);
+      work__.push_back(std::move(work));
+      if (threads__.size() < thread_count__) {
+        threads__.emplace_back(&JSThreadPool::Run, this);
+      }
+    }
+    work_condition__.notify_one();
+  }
+
+  void JSThreadPool::Run() HAL_NOEXCEPT {
+    while (true) {
+      std::function<void()> work;
+      {
+        std::unique_lock<std::mutex> lock(mutex__);
+        work_condition__.wait(lock, [this] { return stopping__ || !work__.empty(); });
+        if (work__.empty()) {
+          return;
+        }
+        work = std::move(work__.front());
+        work__.pop_front();
+      }
+
+      try {
+        work();
+      } catch (const std::exception& e) {
+        HAL_LOG_ERROR("JSThreadPool: work threw ", e.what());
+      } catch (...) {
+        HAL_LOG_ERROR("JSThreadPool: work threw unknown exception");
+      }
+    }
+  }
+
+}} // namespace HAL { namespace detail {
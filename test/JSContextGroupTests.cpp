@@ -7,11 +7,18 @@
  */
 
 #include "HAL/HAL.hpp"
+#include "HAL/detail/JSExportFinalizerQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #include "gtest/gtest.h"
 
 #define XCTAssertEqual    ASSERT_EQ
 #define XCTAssertNotEqual ASSERT_NE
+#define XCTAssertTrue     ASSERT_TRUE
+#define XCTAssertFalse    ASSERT_FALSE
 
 using namespace HAL;
 
@@ -40,3 +47,145 @@ TEST(JSContextGroupTests, BasicObjectCapabilities) {
   JSContextGroup js_context_group_6 = js_context_group_1;
   XCTAssertEqual(js_context_group_1, js_context_group_6);
 }
+
+namespace {
+  std::atomic<int> finalized_count { 0 };
+
+  void CountFinalizer(void*) {
+    ++finalized_count;
+  }
+}
+
+TEST(JSContextGroupTests, DrainFinalizers) {
+  JSContextGroup::DrainFinalizers();
+  finalized_count = 0;
+
+  detail::JSExportFinalizerQueue::Node nodes[3];
+  for (auto& node : nodes) {
+    node.finalizer = &CountFinalizer;
+  }
+  detail::JSExportFinalizerQueue::Enqueue(&nodes[0]);
+  detail::JSExportFinalizerQueue::Enqueue(&nodes[1]);
+  XCTAssertEqual(2, detail::JSExportFinalizerQueue::GetPendingCount());
+  XCTAssertEqual(0, finalized_count);
+
+  XCTAssertEqual(2, JSContextGroup::DrainFinalizers());
+  XCTAssertEqual(2, finalized_count);
+  XCTAssertEqual(0, detail::JSExportFinalizerQueue::GetPendingCount());
+
+  // The background queue drains itself.
+  detail::JSExportFinalizerQueue::EnqueueBackground(&nodes[2]);
+  for (int i = 0; i < 100 && finalized_count < 3; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  XCTAssertEqual(3, finalized_count);
+}
+
+namespace {
+  std::atomic<int> deferred_destroyed_count { 0 };
+
+  class DeferredObject : public JSExportObject, public JSExport<DeferredObject> {
+  public:
+    DeferredObject(const JSContext& js_context) HAL_NOEXCEPT
+    : JSExportObject(js_context) {
+    }
+
+    virtual ~DeferredObject() HAL_NOEXCEPT {
+      ++deferred_destroyed_count;
+    }
+
+    static void JSExportInitialize() {
+      JSExport<DeferredObject>::SetClassVersion(1);
+      JSExport<DeferredObject>::SetParent(JSExport<JSExportObject>::Class());
+    }
+  };
+}
+
+namespace HAL {
+  template<>
+  struct JSExportTraits<DeferredObject> : JSExportDefaultTraits {
+    static const bool defer_finalization = true;
+  };
+}
+
+TEST(JSContextGroupTests, DeferredFinalization) {
+  JSContextGroup::DrainFinalizers();
+  deferred_destroyed_count = 0;
+
+  JSContextGroup js_context_group;
+  JSContext js_context = js_context_group.CreateContext();
+  js_context.get_global_object().SetProperty("DeferredObject", js_context.CreateObject(JSExport<DeferredObject>::Class()));
+
+  // The collector queues the native objects of collected
+  // DeferredObjects instead of destroying them.
+  for (int i = 0; i < 100 && detail::JSExportFinalizerQueue::GetPendingCount() == 0; ++i) {
+    js_context.JSEvaluateScript("(function() { for (var i = 0; i < 1000; i++) { new DeferredObject(); } })();");
+    js_context.GarbageCollect();
+  }
+  XCTAssertTrue(detail::JSExportFinalizerQueue::GetPendingCount() > 0);
+  XCTAssertEqual(0, deferred_destroyed_count);
+
+  // Draining runs their destructors.
+  const auto drained_count = JSContextGroup::DrainFinalizers();
+  XCTAssertTrue(drained_count > 0);
+  XCTAssertEqual(static_cast<int>(drained_count), deferred_destroyed_count);
+  XCTAssertEqual(0, detail::JSExportFinalizerQueue::GetPendingCount());
+}
+
+TEST(JSContextGroupTests, ScriptCache) {
+  JSContextGroup js_context_group;
+  const auto js_context_1 = js_context_group.CreateContext();
+  const auto js_context_2 = js_context_group.CreateContext();
+
+  // The cache is disabled by default.
+  auto statistics = js_context_group.GetScriptCacheStatistics();
+  XCTAssertEqual(0, statistics.capacity);
+  XCTAssertEqual(0, statistics.size);
+
+  js_context_group.SetScriptCacheCapacity(2);
+  XCTAssertEqual(2, js_context_group.GetScriptCacheStatistics().capacity);
+
+  // Every context of the group evaluates the same script with its own
+  // global object.
+  const JSString script = "var counter = (typeof counter === 'number') ? counter + 1 : 1; counter * 10";
+  XCTAssertEqual(10, static_cast<int32_t>(js_context_1.JSEvaluateScript(script)));
+  XCTAssertEqual(20, static_cast<int32_t>(js_context_1.JSEvaluateScript(script)));
+  XCTAssertEqual(10, static_cast<int32_t>(js_context_2.JSEvaluateScript(script)));
+  XCTAssertFalse(js_context_2.TryEvaluate(script).HasException());
+  XCTAssertEqual(2, static_cast<int32_t>(js_context_2.get_global_object().GetProperty("counter")));
+
+  // Exceptions and syntax errors are reported as without the cache.
+  const JSString throwing_script = "throw new Error('expected');";
+  ASSERT_THROW(js_context_1.JSEvaluateScript(throwing_script), std::runtime_error);
+  ASSERT_THROW(js_context_1.JSEvaluateScript(throwing_script), std::runtime_error);
+  ASSERT_THROW(js_context_1.JSEvaluateScript("var = ;"), std::runtime_error);
+
+  statistics = js_context_group.GetScriptCacheStatistics();
+  if (JSContextGroup::IsScriptCacheSupported()) {
+    XCTAssertEqual(4, statistics.hit_count);
+    XCTAssertEqual(3, statistics.miss_count);
+    XCTAssertEqual(2, statistics.size);
+    XCTAssertTrue(statistics.memory_used >= static_cast<std::string>(script).size());
+
+    // A third script evicts the least recently used one.
+    XCTAssertEqual(3, static_cast<int32_t>(js_context_1.JSEvaluateScript("1 + 2")));
+    statistics = js_context_group.GetScriptCacheStatistics();
+    XCTAssertEqual(1, statistics.eviction_count);
+    XCTAssertEqual(2, statistics.size);
+  } else {
+    XCTAssertEqual(0, statistics.hit_count);
+    XCTAssertEqual(0, statistics.size);
+  }
+
+  js_context_group.ClearScriptCache();
+  statistics = js_context_group.GetScriptCacheStatistics();
+  XCTAssertEqual(0, statistics.size);
+  XCTAssertEqual(0, statistics.memory_used);
+  XCTAssertEqual(2, statistics.capacity);
+
+  js_context_group.SetScriptCacheCapacity(0);
+  statistics = js_context_group.GetScriptCacheStatistics();
+  XCTAssertEqual(0, statistics.capacity);
+  XCTAssertEqual(0, statistics.hit_count);
+  XCTAssertEqual(30, static_cast<int32_t>(js_context_1.JSEvaluateScript(script)));
+}
@@ -9,8 +9,14 @@
 #include "HAL/HAL.hpp"
 
 #include "gtest/gtest.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
 #include <thread>
+#include <unordered_map>
 
 #define XCTAssertEqual    ASSERT_EQ
 #define XCTAssertNotEqual ASSERT_NE
@@ -117,3 +123,370 @@ TEST_F(JSContextTests, JSContext) {
   JSContext js_context_12 = js_context_7;
   XCTAssertEqual(js_context_7, js_context_12);
 }
+
+TEST_F(JSContextTests, JSContextSlot) {
+  static JSContextSlot<std::string>      name_slot;
+  static JSContextSlot<JSValue>          value_slot;
+  static JSContextGroupSlot<std::string> group_slot;
+
+  JSContext js_context_1 = js_context_group.CreateContext();
+  JSContext js_context_2 = js_context_group.CreateContext();
+
+  // Each context has its own slot.
+  XCTAssertTrue(name_slot.Get(js_context_1) == nullptr);
+  name_slot.Set(js_context_1, "one");
+  name_slot.Set(js_context_2, "two");
+  XCTAssertEqual("one", *name_slot.Get(js_context_1));
+  XCTAssertEqual("two", *name_slot.Get(js_context_2));
+
+  name_slot.Reset(js_context_1);
+  XCTAssertTrue(name_slot.Get(js_context_1) == nullptr);
+  XCTAssertEqual("two", *name_slot.Get(js_context_2));
+
+  // JavaScript values are per context too.
+  XCTAssertFalse(value_slot.Has(js_context_1));
+  XCTAssertTrue(value_slot.Get(js_context_1).IsUndefined());
+  value_slot.Set(js_context_1, js_context_1.JSEvaluateScript("({ answer: 42 })"));
+  XCTAssertTrue(value_slot.Has(js_context_1));
+  XCTAssertFalse(value_slot.Has(js_context_2));
+  JSObject js_object = static_cast<JSObject>(value_slot.Get(js_context_1));
+  XCTAssertEqual(42, static_cast<int32_t>(js_object.GetProperty("answer")));
+
+  // The slot holder isn't enumerable, and scripts can neither read
+  // nor replace the values it holds.
+  XCTAssertEqual(0, static_cast<int32_t>(js_context_1.JSEvaluateScript("Object.keys(this).length")));
+  XCTAssertEqual(0, static_cast<int32_t>(js_context_1.JSEvaluateScript(
+    "var reached = 0;"
+    "for (var i = 0; i < 32; ++i) {"
+    "  try { __HALContextSlots[i]; ++reached; } catch (e) {}"
+    "  try { __HALContextSlots[i] = null; ++reached; } catch (e) {}"
+    "  try { delete __HALContextSlots[i]; ++reached; } catch (e) {}"
+    "}"
+    "reached;")));
+  XCTAssertTrue(value_slot.Has(js_context_1));
+  XCTAssertEqual(42, static_cast<int32_t>(static_cast<JSObject>(value_slot.Get(js_context_1)).GetProperty("answer")));
+
+  // Contexts of one group share group slots.
+  group_slot.Set(js_context_1, "shared");
+  XCTAssertEqual("shared", *group_slot.Get(js_context_2));
+
+  JSContextGroup js_context_group_2;
+  JSContext js_context_3 = js_context_group_2.CreateContext();
+  XCTAssertTrue(group_slot.Get(js_context_3) == nullptr);
+}
+
+TEST_F(JSContextTests, FunctionCache) {
+  JSContext js_context = js_context_group.CreateContext();
+  const std::vector<JSString> parameter_names = { "a", "b" };
+  
+  // The cache is disabled by default.
+  auto add_1 = js_context.CreateFunction("return a + b;", parameter_names);
+  auto add_2 = js_context.CreateFunction("return a + b;", parameter_names);
+  XCTAssertNotEqual(add_1, add_2);
+  XCTAssertEqual(0, js_context.GetFunctionCacheStatistics().capacity);
+  
+  js_context.SetFunctionCacheCapacity(2);
+  auto add_3 = js_context.CreateFunction("return a + b;", parameter_names);
+  auto add_4 = js_context.CreateFunction("return a + b;", parameter_names);
+  XCTAssertEqual(add_3, add_4);
+  XCTAssertEqual(3, static_cast<int32_t>(add_4(std::vector<JSValue> { js_context.CreateNumber(1), js_context.CreateNumber(2) }, js_context.get_global_object())));
+  
+  // Any difference in the parameter names, name or source URL is a
+  // different function.
+  auto sub_1 = js_context.CreateFunction("return a + b;", { "b", "a" });
+  auto sub_2 = js_context.CreateFunction("return a + b;", parameter_names, "add", "add.js");
+  XCTAssertNotEqual(add_3, sub_1);
+  XCTAssertNotEqual(add_3, sub_2);
+  
+  // The capacity is 2, so add_3 has been evicted.
+  auto statistics = js_context.GetFunctionCacheStatistics();
+  XCTAssertEqual(1, statistics.hit_count);
+  XCTAssertEqual(3, statistics.miss_count);
+  XCTAssertEqual(1, statistics.eviction_count);
+  XCTAssertEqual(2, statistics.size);
+  XCTAssertNotEqual(add_3, js_context.CreateFunction("return a + b;", parameter_names));
+  
+  // The cache is per global context.
+  JSContext other_js_context = js_context_group.CreateContext();
+  XCTAssertEqual(0, other_js_context.GetFunctionCacheStatistics().capacity);
+  
+  js_context.InvalidateFunctionCache();
+  statistics = js_context.GetFunctionCacheStatistics();
+  XCTAssertEqual(0, statistics.size);
+  XCTAssertEqual(2, statistics.capacity);
+  XCTAssertNotEqual(sub_2, js_context.CreateFunction("return a + b;", parameter_names, "add", "add.js"));
+}
+
+namespace {
+  void WriteFile(const std::string& path, const std::string& contents) {
+    std::ofstream file(path, std::ios_base::binary | std::ios_base::out);
+    file << contents;
+  }
+}
+
+TEST_F(JSContextTests, EvaluateScriptFile) {
+  JSContext js_context = js_context_group.CreateContext();
+  const std::string path = "EvaluateScriptFile.js";
+  
+  // A byte order mark, ASCII, two, three and four byte sequences.
+  WriteFile(path, "\xEF\xBB\xBF'h\xC3\xA9llo \xE2\x82\xAC \xF0\x9F\x98\x80'");
+  auto js_value = js_context.EvaluateScriptFile(path);
+  XCTAssertEqual("h\xC3\xA9llo \xE2\x82\xAC \xF0\x9F\x98\x80", static_cast<std::string>(js_value));
+  WriteFile(path, "'h\xC3\xA9llo \xE2\x82\xAC \xF0\x9F\x98\x80'.length");
+  XCTAssertEqual(10, static_cast<int32_t>(js_context.EvaluateScriptFile(path)));
+  
+  // Malformed UTF-8 becomes U+FFFD.
+  WriteFile(path, "'a\xC3" "b\xFF'.charCodeAt(1) + ',' + '\xC3\xA9'.length");
+  XCTAssertEqual("65533,1", static_cast<std::string>(js_context.EvaluateScriptFile(path)));
+  
+  WriteFile(path, "");
+  XCTAssertTrue(js_context.EvaluateScriptFile(path).IsUndefined());
+  
+  WriteFile(path, "throw new Error('expected');");
+  ASSERT_THROW(js_context.EvaluateScriptFile(path), std::runtime_error);
+  
+  std::remove(path.c_str());
+  ASSERT_THROW(js_context.EvaluateScriptFile(path), std::runtime_error);
+}
+
+TEST_F(JSContextTests, JSContextPool) {
+  std::atomic<int> initialized_count { 0 };
+  const auto initializer = [&initialized_count](JSContext& js_context) {
+    ++initialized_count;
+    js_context.get_global_object().SetProperty("initialized", js_context.CreateBoolean(true));
+  };
+  const auto reset = [](JSContext& js_context) {
+    js_context.get_global_object().DeleteProperty("request");
+  };
+  JSContextPool js_context_pool(js_context_group, 2, initializer, reset, 3);
+  XCTAssertEqual(2, initialized_count);
+  
+  {
+    auto lease = js_context_pool.Acquire();
+    XCTAssertTrue(static_cast<bool>(lease));
+    auto& js_context = lease.get_context();
+    XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("initialized")));
+    js_context.JSEvaluateScript("var request = 1;");
+    XCTAssertEqual(1, js_context_pool.GetStatistics().in_use);
+  }
+  
+  // The reset callback removed the request's global, and the
+  // initializer didn't run again.
+  {
+    auto lease = js_context_pool.Acquire();
+    XCTAssertEqual("undefined", static_cast<std::string>(lease.get_context().JSEvaluateScript("typeof request")));
+    XCTAssertEqual(2, initialized_count);
+    
+    // The third use of the context recycles it.
+    lease.Release();
+    XCTAssertFalse(static_cast<bool>(lease));
+    js_context_pool.Acquire();
+    XCTAssertEqual(3, initialized_count);
+  }
+  
+  // A retired lease is recycled, too.
+  {
+    auto lease = js_context_pool.Acquire();
+    lease.get_context().JSEvaluateScript("var initialized = false;");
+    lease.Retire();
+  }
+  XCTAssertEqual(4, initialized_count);
+  
+  // With every context leased, TryAcquire times out.
+  auto lease_1 = js_context_pool.Acquire();
+  auto lease_2 = js_context_pool.Acquire();
+  XCTAssertNotEqual(lease_1.get_context(), lease_2.get_context());
+  XCTAssertFalse(static_cast<bool>(js_context_pool.TryAcquire(std::chrono::milliseconds(10))));
+  
+  // Acquire waits for a lease to be returned.
+  std::thread returner([&lease_1] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    lease_1.Release();
+  });
+  auto lease_3 = js_context_pool.Acquire();
+  returner.join();
+  XCTAssertTrue(static_cast<bool>(lease_3.get_context().JSEvaluateScript("initialized")));
+  
+  const auto statistics = js_context_pool.GetStatistics();
+  XCTAssertEqual(2, statistics.size);
+  XCTAssertEqual(2, statistics.in_use);
+  XCTAssertEqual(2, statistics.peak_in_use);
+  XCTAssertEqual(7, statistics.acquire_count);
+  XCTAssertEqual(2, statistics.wait_count);
+  XCTAssertEqual(1, statistics.timeout_count);
+  XCTAssertEqual(2, statistics.retire_count);
+  XCTAssertTrue(statistics.max_wait_time >= std::chrono::milliseconds(10));
+  XCTAssertTrue(statistics.utilization > 0 && statistics.utilization <= 1);
+}
+
+TEST_F(JSContextTests, JSExecutor) {
+  JSExecutor js_executor(4, [](JSContext& js_context) {
+    js_context.JSEvaluateScript("var probeCount = 0; function square(x) { return x * x; }");
+  });
+  XCTAssertEqual(4, js_executor.get_worker_count());
+  
+  std::vector<std::future<double>> squares;
+  for (int i = 0; i < 100; ++i) {
+    squares.push_back(js_executor.Submit([i](JSContext& js_context) {
+      return static_cast<double>(js_context.JSEvaluateScript("square(" + std::to_string(i) + ")"));
+    }));
+  }
+  for (int i = 0; i < 100; ++i) {
+    XCTAssertEqual(i * i, squares[i].get());
+  }
+  
+  XCTAssertEqual("6", js_executor.Evaluate("[1, 2, 3].reduce(function(a, b) { return a + b; })").get());
+  
+  // Exceptions come back through the future.
+  auto failure = js_executor.Evaluate("throw new Error('expected');");
+  ASSERT_THROW(failure.get(), std::runtime_error);
+  
+  // Each worker has its own context on its own thread. Whichever
+  // worker runs a job, the counter in its context has counted exactly
+  // the jobs that worker ran.
+  std::vector<std::future<std::pair<std::thread::id, int32_t>>> job_counts;
+  for (int i = 0; i < 100; ++i) {
+    job_counts.push_back(js_executor.Submit([](JSContext& js_context) {
+      return std::make_pair(std::this_thread::get_id(), static_cast<int32_t>(js_context.JSEvaluateScript("++probeCount")));
+    }));
+  }
+  std::unordered_map<std::thread::id, int32_t> max_count_by_thread;
+  std::unordered_map<std::thread::id, int32_t> job_count_by_thread;
+  for (auto& job_count : job_counts) {
+    const auto result = job_count.get();
+    XCTAssertNotEqual(std::this_thread::get_id(), result.first);
+    max_count_by_thread[result.first] = std::max(max_count_by_thread[result.first], result.second);
+    ++job_count_by_thread[result.first];
+  }
+  XCTAssertTrue(job_count_by_thread.size() <= js_executor.get_worker_count());
+  for (const auto& entry : job_count_by_thread) {
+    XCTAssertEqual(entry.second, max_count_by_thread[entry.first]);
+  }
+  
+  // A job may submit more jobs, which the destructor waits for.
+  std::atomic<int> nested_count { 0 };
+  {
+    JSExecutor nested_js_executor(2);
+    for (int i = 0; i < 10; ++i) {
+      nested_js_executor.Post([&nested_js_executor, &nested_count](JSContext&) {
+        nested_js_executor.Post([&nested_count](JSContext&) {
+          ++nested_count;
+        });
+      });
+    }
+  }
+  XCTAssertEqual(10, nested_count);
+}
+
+TEST_F(JSContextTests, JSEventLoop) {
+  JSContext js_context = js_context_group.CreateContext();
+  JSEventLoop js_event_loop(js_context);
+  
+  js_context.JSEvaluateScript(
+    "var log = [];"
+    "setTimeout(function(a, b) { log.push('timeout ' + a + b); }, 20, 'x', 'y');"
+    "var cleared = setTimeout(function() { log.push('cleared'); }, 10);"
+    "clearTimeout(cleared);"
+    "var ticks = 0;"
+    "var interval = setInterval(function() { if (++ticks === 3) { clearInterval(interval); } }, 1);"
+    "setTimeout(function() { Promise.resolve().then(function() { log.push('microtask'); }); log.push('first'); }, 0);");
+  js_event_loop.Post([](JSContext& js_context) {
+    js_context.JSEvaluateScript("log.push('task');");
+  });
+  
+  js_event_loop.RunUntilIdle();
+  
+  // Tasks run before timers in a batch, and promise jobs run as the
+  // callback that queued them returns.
+  XCTAssertEqual("task,first,microtask,timeout xy", static_cast<std::string>(js_context.JSEvaluateScript("log.join()")));
+  XCTAssertEqual(3, static_cast<int32_t>(js_context.JSEvaluateScript("ticks")));
+  
+  // A callback that isn't a function is a TypeError that JavaScript
+  // can catch.
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("try { setTimeout('not a function', 0); false; } catch (e) { e instanceof TypeError; }")));
+  XCTAssertEqual("setTimeout: callback is not a function", static_cast<std::string>(js_context.JSEvaluateScript("try { setTimeout('not a function', 0); } catch (e) { e.message; }")));
+  ASSERT_THROW(js_context.JSEvaluateScript("setTimeout('not a function', 0)"), std::runtime_error);
+  
+  auto statistics = js_event_loop.GetStatistics();
+  XCTAssertEqual(1, statistics.task_count);
+  XCTAssertEqual(5, statistics.timer_count);
+  XCTAssertEqual(0, statistics.pending_task_count);
+  XCTAssertEqual(0, statistics.pending_timer_count);
+  XCTAssertTrue(statistics.batch_count > 0);
+  XCTAssertTrue(statistics.max_lag >= std::chrono::microseconds(0));
+  
+  // On its own thread, the loop runs posted tasks until stopped.
+  std::promise<int32_t> result;
+  js_event_loop.Start();
+  js_event_loop.Post([](JSContext& js_context) {
+    js_context.JSEvaluateScript("setTimeout(function() { ticks = 10; }, 5);");
+  });
+  js_event_loop.Post([&result](JSContext& js_context) {
+    result.set_value(static_cast<int32_t>(js_context.JSEvaluateScript("ticks")));
+  });
+  XCTAssertEqual(3, result.get_future().get());
+  for (int i = 0; i < 100 && js_event_loop.GetStatistics().timer_count < 6; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  js_event_loop.Stop();
+  XCTAssertEqual(10, static_cast<int32_t>(js_context.JSEvaluateScript("ticks")));
+}
+
+TEST_F(JSContextTests, JSEventLoopAsyncFunction) {
+  JSContext js_context = js_context_group.CreateContext();
+  JSEventLoop js_event_loop(js_context, 2);
+  auto global_object = js_context.get_global_object();
+  
+  std::atomic<int> work_count { 0 };
+  const auto main_thread_id = std::this_thread::get_id();
+  auto square = js_event_loop.CreateAsyncFunction("square", [&work_count, main_thread_id](const std::vector<JSValue>& arguments, JSObject&) -> JSAsyncWork {
+    const auto x = static_cast<double>(arguments.at(0));
+    return [&work_count, main_thread_id, x]() -> JSAsyncResult {
+      if (std::this_thread::get_id() == main_thread_id) {
+        throw std::runtime_error("ran on the loop's thread");
+      }
+      if (x < 0) {
+        throw std::runtime_error("negative");
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      ++work_count;
+      return [x](JSContext& js_context) -> JSValue {
+        return js_context.CreateNumber(x * x);
+      };
+    };
+  });
+  global_object.SetProperty("square", square);
+  
+  js_context.JSEvaluateScript(
+    "var results = [];"
+    "var promises = [1, 2, 3].map(function(x) { return square(x); });"
+    "Promise.all(promises).then(function(squares) { results.push(squares.join('+')); });"
+    "square(-1).catch(function(error) { results.push(error.message); });");
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("promises[0] instanceof Promise")));
+  XCTAssertEqual(4, js_event_loop.GetStatistics().pending_async_count);
+  
+  // RunUntilIdle waits for the Promises to settle.
+  js_event_loop.RunUntilIdle();
+  XCTAssertEqual(3, work_count);
+  XCTAssertEqual(0, js_event_loop.GetStatistics().pending_async_count);
+  XCTAssertEqual("1+4+9,negative", static_cast<std::string>(js_context.JSEvaluateScript("results.sort().join()")));
+  
+  // Destroying a loop rejects the Promises it hasn't settled, and the
+  // functions it installed then throw JavaScript exceptions.
+  {
+    JSEventLoop short_event_loop(js_context, 1);
+    auto wait = short_event_loop.CreateAsyncFunction("wait", [](const std::vector<JSValue>&, JSObject&) -> JSAsyncWork {
+      return []() -> JSAsyncResult {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return [](JSContext& js_context) -> JSValue {
+          return js_context.CreateUndefined();
+        };
+      };
+    });
+    global_object.SetProperty("wait", wait);
+    js_context.JSEvaluateScript("var cancelled = ''; wait().catch(function(error) { cancelled = error.message; });");
+  }
+  XCTAssertEqual("JSEventLoop: the event loop was destroyed", static_cast<std::string>(js_context.JSEvaluateScript("cancelled")));
+  XCTAssertEqual("JSEventLoop: the event loop has been destroyed", static_cast<std::string>(js_context.JSEvaluateScript("try { setTimeout(function() {}, 0); } catch (e) { e.message; }")));
+  XCTAssertEqual("JSEventLoop: the event loop has been destroyed", static_cast<std::string>(js_context.JSEvaluateScript("try { wait(); } catch (e) { e.message; }")));
+}
@@ -1425,3 +1425,270 @@ TEST_F(JSExportTests, LRUCache) {
   XCTAssertTrue(keys.empty());
 }
 
+
+TEST_F(JSExportTests, TypedFunctionProperty) {
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject global_object = js_context.get_global_object();
+
+  JSObject widget = js_context.CreateObject(JSExport<Widget>::Class());
+  global_object.SetProperty("Widget", widget);
+
+  auto result = js_context.JSEvaluateScript("new Widget('foo', 42).scaleNumber(2, 'percent');");
+  XCTAssertTrue(result.IsNumber());
+  XCTAssertEqual(0.84, static_cast<double>(result));
+
+  // Arguments are converted like JavaScript does, extra ones are ignored.
+  result = js_context.JSEvaluateScript("new Widget('foo', 42).scaleNumber('3', '', 'ignored');");
+  XCTAssertEqual(126, static_cast<std::int32_t>(result));
+
+  // Too few arguments is a JavaScript exception.
+  ASSERT_THROW(js_context.JSEvaluateScript("new Widget('foo', 42).scaleNumber(2);"), std::runtime_error);
+}
+
+TEST_F(JSExportTests, TypedValueProperty) {
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject global_object = js_context.get_global_object();
+
+  JSObject widget = js_context.CreateObject(JSExport<Widget>::Class());
+  global_object.SetProperty("widget", widget);
+
+  auto result = js_context.JSEvaluateScript("widget.typedNumber;");
+  XCTAssertTrue(result.IsNumber());
+  XCTAssertEqual(42, static_cast<std::int32_t>(result));
+
+  // The typed and JSValue based properties share the same native state.
+  result = js_context.JSEvaluateScript("widget.typedNumber = '7'; widget.number;");
+  XCTAssertEqual(7, static_cast<std::int32_t>(result));
+
+  result = js_context.JSEvaluateScript("widget.number = 9; widget.typedNumber;");
+  XCTAssertEqual(9, static_cast<std::int32_t>(result));
+
+  result = js_context.JSEvaluateScript("delete widget.typedNumber;");
+  XCTAssertFalse(static_cast<bool>(result));
+}
+
+namespace {
+  class PooledObject : public JSExportObject, public JSExport<PooledObject> {
+  public:
+    PooledObject(const JSContext& js_context) HAL_NOEXCEPT
+    : JSExportObject(js_context) {
+    }
+
+    static void JSExportInitialize() {
+      JSExport<PooledObject>::SetClassVersion(1);
+      JSExport<PooledObject>::SetParent(JSExport<JSExportObject>::Class());
+    }
+  };
+}
+
+namespace HAL {
+  template<>
+  struct JSExportTraits<PooledObject> : JSExportDefaultTraits {
+    static const bool use_object_pool = true;
+  };
+}
+
+TEST_F(JSExportTests, ObjectPool) {
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject global_object = js_context.get_global_object();
+
+  JSObject pooled_object = js_context.CreateObject(JSExport<PooledObject>::Class());
+  global_object.SetProperty("PooledObject", pooled_object);
+
+  const auto before = JSExport<PooledObject>::GetObjectPoolStatistics();
+  XCTAssertTrue(before.in_use > 0);
+
+  auto result = js_context.JSEvaluateScript("var pooled = []; for (var i = 0; i < 200; i++) { pooled.push(new PooledObject()); } pooled[199] instanceof PooledObject;");
+  XCTAssertTrue(static_cast<bool>(result));
+
+  const auto after = JSExport<PooledObject>::GetObjectPoolStatistics();
+  XCTAssertTrue(after.allocation_count >= before.allocation_count + 200);
+  XCTAssertTrue(after.in_use >= before.in_use + 200);
+  XCTAssertTrue(after.peak_in_use >= after.in_use);
+  XCTAssertTrue(after.capacity >= after.in_use + after.thread_cached);
+  XCTAssertTrue(after.slab_count > 0);
+  XCTAssertTrue(after.occupancy() > 0 && after.occupancy() <= 1);
+
+  // Widget does not opt in, so its pool stays empty.
+  JSObject widget = js_context.CreateObject(JSExport<Widget>::Class());
+  XCTAssertEqual(0, JSExport<Widget>::GetObjectPoolStatistics().allocation_count);
+
+  js_context.JSEvaluateScript("pooled = null;");
+  js_context.GarbageCollect();
+}
+
+TEST_F(JSExportTests, InstanceOf) {
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject global_object = js_context.get_global_object();
+
+  JSObject widget       = js_context.CreateObject(JSExport<Widget>::Class());
+  JSObject child_widget = js_context.CreateObject(JSExport<ChildWidget>::Class());
+  JSObject other_widget = js_context.CreateObject(JSExport<OtherWidget>::Class());
+  global_object.SetProperty("Widget", widget);
+  global_object.SetProperty("ChildWidget", child_widget);
+  global_object.SetProperty("OtherWidget", other_widget);
+
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("new Widget() instanceof Widget;")));
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("new ChildWidget() instanceof ChildWidget;")));
+
+  // ChildWidget's SetParent chain leads to Widget, but not the other
+  // way around.
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("new ChildWidget() instanceof Widget;")));
+  XCTAssertFalse(static_cast<bool>(js_context.JSEvaluateScript("new Widget() instanceof ChildWidget;")));
+
+  XCTAssertFalse(static_cast<bool>(js_context.JSEvaluateScript("new OtherWidget() instanceof Widget;")));
+  XCTAssertFalse(static_cast<bool>(js_context.JSEvaluateScript("({}) instanceof Widget;")));
+  XCTAssertFalse(static_cast<bool>(js_context.JSEvaluateScript("42 instanceof Widget;")));
+
+  // Native functions keep their callback in their private data, which
+  // must not be mistaken for a Widget.
+  JSFunction js_function = js_context.CreateFunction();
+  global_object.SetProperty("nativeFunction", js_function);
+  XCTAssertFalse(static_cast<bool>(js_context.JSEvaluateScript("nativeFunction instanceof Widget;")));
+  XCTAssertEqual(nullptr, JSExport<Widget>::Downcast(js_function));
+
+  XCTAssertEqual(widget.GetPrivate<Widget>().get(), JSExport<Widget>::Downcast(widget));
+  XCTAssertEqual(child_widget.GetPrivate<Widget>().get(), JSExport<Widget>::Downcast(child_widget));
+  XCTAssertEqual(nullptr, JSExport<ChildWidget>::Downcast(widget));
+  XCTAssertEqual(nullptr, JSExport<Widget>::Downcast(other_widget));
+  XCTAssertEqual(nullptr, JSExport<Widget>::Downcast(js_context.CreateObject()));
+}
+
+TEST_F(JSExportTests, CallAsConstructorSharedPrototype) {
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject global_object = js_context.get_global_object();
+
+  JSObject widget = js_context.CreateObject(JSExport<Widget>::Class());
+  global_object.SetProperty("Widget", widget);
+
+  // The constructor lives on the shared prototype, not on each
+  // instance.
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("var a = new Widget(), b = new Widget(); a.constructor === Widget && b.constructor === Widget;")));
+  XCTAssertFalse(static_cast<bool>(js_context.JSEvaluateScript("a.hasOwnProperty('constructor');")));
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("Object.getPrototypeOf(a) === Object.getPrototypeOf(b);")));
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("Object.keys(a).indexOf('constructor') === -1;")));
+
+  // A second constructor object of the same class still gets the
+  // right constructor.
+  JSObject other_widget = js_context.CreateObject(JSExport<Widget>::Class());
+  global_object.SetProperty("OtherWidgetConstructor", other_widget);
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("new OtherWidgetConstructor().constructor === OtherWidgetConstructor;")));
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("new Widget().constructor === Widget;")));
+}
+
+TEST_F(JSExportTests, Wrap) {
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject global_object = js_context.get_global_object();
+
+  JSObject widget = js_context.CreateObject(JSExport<Widget>::Class());
+  global_object.SetProperty("Widget", widget);
+
+  const auto widget_ptr = JSExport<Widget>::Downcast(widget);
+  XCTAssertNotEqual(nullptr, widget_ptr);
+
+  // Wrapping the same native object always returns the same
+  // JavaScript object.
+  JSObject wrapped = JSExport<Widget>::Wrap(*widget_ptr);
+  XCTAssertEqual(static_cast<JSObjectRef>(widget), static_cast<JSObjectRef>(wrapped));
+  global_object.SetProperty("wrapped", wrapped);
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("Widget === wrapped;")));
+
+  JSObject js_widget = static_cast<JSObject>(js_context.JSEvaluateScript("new Widget('foo', 123);"));
+  const auto js_widget_ptr = JSExport<Widget>::Downcast(js_widget);
+  XCTAssertNotEqual(nullptr, js_widget_ptr);
+  XCTAssertEqual(static_cast<JSObjectRef>(js_widget), static_cast<JSObjectRef>(JSExport<Widget>::Wrap(*js_widget_ptr)));
+  XCTAssertEqual(static_cast<JSObjectRef>(js_widget), static_cast<JSObjectRef>(js_widget_ptr -> get_object()));
+
+  // A native object that JavaScriptCore didn't create has no
+  // JavaScript object.
+  Widget native_widget(js_context);
+  ASSERT_THROW(JSExport<Widget>::Wrap(native_widget), std::runtime_error);
+}
+
+TEST_F(JSExportTests, MemoizedProperty) {
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject global_object = js_context.get_global_object();
+
+  JSObject widget = js_context.CreateObject(JSExport<Widget>::Class());
+  global_object.SetProperty("Widget", widget);
+  const auto widget_ptr = JSExport<Widget>::Downcast(widget);
+  XCTAssertNotEqual(nullptr, widget_ptr);
+
+  const auto statistics_before = JSExport<Widget>::GetPropertyStatistics().at("greeting");
+
+  XCTAssertEqual(0, widget_ptr->get_count_for_greeting());
+  auto result = js_context.JSEvaluateScript("Widget.greeting;");
+  XCTAssertEqual("Hello, world. Your number is 42.", static_cast<std::string>(result));
+  XCTAssertEqual(1, widget_ptr->get_count_for_greeting());
+
+  // Later reads are served from the cache.
+  result = js_context.JSEvaluateScript("Widget.greeting + Widget.greeting;");
+  XCTAssertEqual("Hello, world. Your number is 42.Hello, world. Your number is 42.", static_cast<std::string>(result));
+  XCTAssertEqual(1, widget_ptr->get_count_for_greeting());
+
+  // Setting state the getter depends on invalidates the cache.
+  result = js_context.JSEvaluateScript("Widget.name = 'foo'; Widget.number = 7; Widget.greeting;");
+  XCTAssertEqual("Hello, foo. Your number is 7.", static_cast<std::string>(result));
+  XCTAssertEqual(2, widget_ptr->get_count_for_greeting());
+
+  widget_ptr->InvalidateProperty("greeting");
+  result = js_context.JSEvaluateScript("Widget.greeting;");
+  XCTAssertEqual(3, widget_ptr->get_count_for_greeting());
+
+  // Each object has its own cache.
+  result = js_context.JSEvaluateScript("new Widget().greeting;");
+  XCTAssertEqual("Hello, world. Your number is 42.", static_cast<std::string>(result));
+  XCTAssertEqual(3, widget_ptr->get_count_for_greeting());
+
+  const auto statistics_after = JSExport<Widget>::GetPropertyStatistics().at("greeting");
+  XCTAssertEqual(2, statistics_after.hit_count  - statistics_before.hit_count);
+  XCTAssertEqual(4, statistics_after.miss_count - statistics_before.miss_count);
+}
+
+TEST_F(JSExportTests, WarmUpClasses) {
+  const auto warm_ups = WarmUpClasses();
+  XCTAssertEqual(detail::JSExportClassRegistry::GetCount(), warm_ups.size());
+
+  const auto has_class = [&warm_ups](const std::string& name) {
+    for (const auto& warm_up : warm_ups) {
+      if (warm_up.name == name) {
+        return true;
+      }
+    }
+    return false;
+  };
+  XCTAssertTrue(has_class(typeid(Widget).name()));
+  XCTAssertTrue(has_class(typeid(ChildWidget).name()));
+  XCTAssertTrue(has_class(typeid(OtherWidget).name()));
+
+  // Classes are usable as usual after they have been warmed up, and
+  // warming up again is harmless.
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject widget = js_context.CreateObject(JSExport<Widget>::Class());
+  XCTAssertNotEqual(nullptr, JSExport<Widget>::Downcast(widget));
+  XCTAssertEqual(warm_ups.size(), WarmUpClasses(1).size());
+}
+
+TEST_F(JSExportTests, NativeExceptionError) {
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject global_object = js_context.get_global_object();
+
+  JSObject widget = js_context.CreateObject(JSExport<Widget>::Class());
+  global_object.SetProperty("widget", widget);
+
+  const auto error_count = detail::JSExportError::GetCount();
+  JSValue result = js_context.JSEvaluateScript("var error; try { widget.testNativeException(); } catch (e) { error = e; } error;");
+  XCTAssertTrue(result.IsObject());
+  XCTAssertEqual(error_count + 1, detail::JSExportError::GetCount());
+
+  // The lazy fields read the same as ordinary Error properties.
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("error instanceof Error;")));
+  XCTAssertEqual("Native error", static_cast<std::string>(js_context.JSEvaluateScript("error.message;")));
+  XCTAssertNotEqual("", static_cast<std::string>(js_context.JSEvaluateScript("error.name;")));
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("error.nativeStack.indexOf('testNativeException') >= 0;")));
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("typeof error.stack === 'string';")));
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("String(error) === error.name + ': Native error';")));
+
+  JSError js_error = static_cast<JSError>(static_cast<JSObject>(result));
+  XCTAssertEqual("Native error", js_error.message());
+}
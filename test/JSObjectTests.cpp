@@ -7,6 +7,8 @@
  */
 
 #include "HAL/HAL.hpp"
+#include "HAL/detail/JSContextSlots.hpp"
+#include "HAL/detail/JSFunctionClass.hpp"
 
 #include "gtest/gtest.h"
 
@@ -565,6 +567,110 @@ TEST_F(JSObjectTests, JSFunctionCallback) {
   XCTAssertTrue(noop_function(noop_function).IsUndefined());
 }
 
+TEST_F(JSObjectTests, JSFunctionPrivateData) {
+  JSContext js_context = js_context_group.CreateContext();
+  JSFunctionCallback callback = [js_context](const std::vector<JSValue> arguments, JSObject& this_object) {
+    return js_context.CreateString("Hello, "+static_cast<std::string>(arguments.at(0)));
+  };
+
+  auto global_object = js_context.get_global_object();
+  const auto function_count = detail::JSFunctionClass::GetCount();
+  {
+    JSFunction js_function = js_context.CreateFunction("greet", callback);
+    XCTAssertEqual(function_count + 1, detail::JSFunctionClass::GetCount());
+    global_object.SetProperty("greet", js_function);
+  }
+
+  // The callback lives as long as the JavaScript function, not the
+  // JSFunction that created it.
+  XCTAssertEqual("Hello, JavaScript", static_cast<std::string>(js_context.JSEvaluateScript("greet('JavaScript');")));
+
+  // It still behaves like any other function.
+  XCTAssertEqual("function", static_cast<std::string>(js_context.JSEvaluateScript("typeof greet;")));
+  XCTAssertEqual("greet", static_cast<std::string>(js_context.JSEvaluateScript("greet.name;")));
+  XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("greet instanceof Function;")));
+  XCTAssertEqual("[object Function]", static_cast<std::string>(js_context.JSEvaluateScript("Object.prototype.toString.call(greet);")));
+  XCTAssertEqual("Hello, call", static_cast<std::string>(js_context.JSEvaluateScript("greet.call(null, 'call');")));
+  XCTAssertEqual("Hello, apply", static_cast<std::string>(js_context.JSEvaluateScript("greet.apply(null, ['apply']);")));
+}
+
+TEST_F(JSObjectTests, JSFunctionCopy) {
+  const auto function_count = detail::JSFunctionClass::GetCount();
+  const auto record_count   = detail::JSFunctionClass::GetRecordCount();
+
+  {
+    // A context group of its own, so that releasing it finalizes
+    // every function object created below.
+    JSContextGroup local_context_group;
+    JSContext js_context = local_context_group.CreateContext();
+    JSFunctionCallback callback = [js_context](const std::vector<JSValue> arguments, JSObject& this_object) {
+      return js_context.CreateString("Hello, "+static_cast<std::string>(arguments.at(0)));
+    };
+
+    auto global_object = js_context.get_global_object();
+
+    // Copying or moving a JSFunction neither creates a function object
+    // nor a callback record, and keeps its identity.
+    JSFunction js_function = js_context.CreateFunction(callback);
+    JSFunction js_function_copy(js_function);
+    JSFunction js_function_move(std::move(js_function_copy));
+    JSFunction js_function_assigned = js_context.CreateFunction(callback);
+    js_function_assigned = js_function;
+    XCTAssertEqual(js_function, js_function_move);
+    XCTAssertEqual(js_function, js_function_assigned);
+    XCTAssertEqual(function_count + 2, detail::JSFunctionClass::GetCount());
+
+    global_object.SetProperty("original", js_function);
+    global_object.SetProperty("copy", js_function_assigned);
+    XCTAssertTrue(static_cast<bool>(js_context.JSEvaluateScript("original === copy;")));
+    XCTAssertEqual("Hello, copy", static_cast<std::string>(js_context.JSEvaluateScript("copy('copy');")));
+
+    // Each function object has its own record, even without a
+    // callback, since the record holds the function's name.
+    JSFunction noop_function_1 = js_context.CreateFunction();
+    JSFunction noop_function_2 = js_context.CreateFunction();
+    XCTAssertNotEqual(noop_function_1, noop_function_2);
+    XCTAssertTrue(noop_function_1(noop_function_1).IsUndefined());
+    XCTAssertTrue(noop_function_2(noop_function_2).IsUndefined());
+    XCTAssertEqual(record_count + 4, detail::JSFunctionClass::GetRecordCount());
+  }
+
+  // The callbacks captured js_context, which didn't keep it alive:
+  // every function object was finalized with the context group, and
+  // took its record with it.
+  XCTAssertEqual(function_count, detail::JSFunctionClass::GetCount());
+  XCTAssertEqual(record_count, detail::JSFunctionClass::GetRecordCount());
+}
+
+TEST_F(JSObjectTests, TypedJSFunction) {
+  JSContext js_context = js_context_group.CreateContext();
+  auto global_object = js_context.get_global_object();
+
+  std::function<double(std::int32_t, const std::string&)> callback = [](std::int32_t number, const std::string& unit) {
+    return unit == "half" ? number / 2.0 : number;
+  };
+
+  JSFunction js_function = js_context.CreateFunction("scale", callback);
+  XCTAssertTrue(js_function.IsFunction());
+
+  global_object.SetProperty("scale", js_function);
+  XCTAssertEqual(1.5, static_cast<double>(js_context.JSEvaluateScript("scale(3, 'half');")));
+  XCTAssertEqual(3  , static_cast<double>(js_context.JSEvaluateScript("scale(3.9, 'whole');")));
+
+  // copy construction
+  {
+    JSFunction js_function_copy(js_function);
+    global_object.SetProperty("scaleCopy", js_function_copy);
+    XCTAssertEqual(2, static_cast<double>(js_context.JSEvaluateScript("scaleCopy(4, 'half');")));
+    global_object.DeleteProperty("scaleCopy");
+  }
+
+  std::function<void(bool)> noop = [](bool) {};
+  global_object.SetProperty("noop", js_context.CreateFunction(noop));
+  XCTAssertTrue(js_context.JSEvaluateScript("noop(true);").IsUndefined());
+  ASSERT_THROW(js_context.JSEvaluateScript("noop();"), std::runtime_error);
+}
+
 TEST_F(JSObjectTests, JSON_stringify) {
   auto js_context = js_context_group.CreateContext();
   auto global_object = js_context.get_global_object();
@@ -594,3 +700,200 @@ TEST_F(JSObjectTests, JSON_stringify) {
   XCTAssertEqual("[\"Hello\",123,3.141592653589793,true,{}]", static_cast<std::string>(js_result));
 }
 
+
+namespace {
+  JSValueRef GetAnswerCallback(JSContextRef context_ref, JSObjectRef, JSStringRef, JSValueRef*) {
+    return JSValueMakeNumber(context_ref, 42);
+  }
+}
+
+TEST_F(JSObjectTests, JSClassDefinitionSharedState) {
+  HAL::JSClassDefinition js_class_definition;
+  {
+    // The JSClassDefinition must not point into these strings once
+    // it has been created.
+    std::string class_name("Answer");
+    std::string property_name("answer");
+    
+    const ::JSStaticValue static_values[] = {
+      { property_name.c_str(), GetAnswerCallback, nullptr, kJSPropertyAttributeReadOnly },
+      { nullptr, nullptr, nullptr, kJSPropertyAttributeNone }
+    };
+    
+    ::JSClassDefinition definition = kJSClassDefinitionEmpty;
+    definition.className    = class_name.c_str();
+    definition.staticValues = static_values;
+    
+    // Copies share the same state.
+    HAL::JSClassDefinition original(definition);
+    js_class_definition = original;
+    
+    class_name.assign("xxxxxx");
+    property_name.assign("xxxxxx");
+  }
+  
+  XCTAssertEqual("Answer", js_class_definition.get_name());
+  
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject js_object   = js_context.CreateObject(JSClass(js_class_definition));
+  js_context.get_global_object().SetProperty("answer", js_object);
+  
+  auto result = js_context.JSEvaluateScript("answer.answer;");
+  XCTAssertEqual(42, static_cast<std::int32_t>(result));
+}
+
+TEST_F(JSObjectTests, TryAPI) {
+  JSContext js_context = js_context_group.CreateContext();
+  JSObject global_object = js_context.get_global_object();
+  
+  js_context.JSEvaluateScript("var probe = { value: 42, get broken() { throw new TypeError('broken getter'); } };");
+  JSObject probe = static_cast<JSObject>(global_object.GetProperty("probe"));
+  
+  auto result = probe.TryGetProperty("value");
+  XCTAssertTrue(static_cast<bool>(result));
+  XCTAssertFalse(result.HasException());
+  XCTAssertEqual(nullptr, result.get_exception_ref());
+  XCTAssertTrue(result.get_exception().IsUndefined());
+  XCTAssertEqual(42, static_cast<std::int32_t>(result.get_value()));
+  
+  result = probe.TryGetProperty("broken");
+  XCTAssertFalse(static_cast<bool>(result));
+  XCTAssertTrue(result.HasException());
+  XCTAssertNotEqual(nullptr, result.get_exception_ref());
+  XCTAssertEqual("TypeError: broken getter", result.get_exception_message());
+  ASSERT_THROW(result.get_value(), std::runtime_error);
+  ASSERT_THROW(result.ThrowIfException(), std::runtime_error);
+  
+  // Calling something that isn't a function is a TypeError, not a C++
+  // exception.
+  result = probe.TryCall({}, global_object);
+  XCTAssertFalse(static_cast<bool>(result));
+  XCTAssertTrue(result.HasException());
+  XCTAssertEqual("TypeError: This JavaScript object is not a function.", result.get_exception_message());
+  
+  JSObject add = static_cast<JSObject>(js_context.JSEvaluateScript("(function(a, b) { return a + b; })"));
+  result = add.TryCall({js_context.CreateNumber(1), js_context.CreateNumber(2)}, global_object);
+  XCTAssertTrue(static_cast<bool>(result));
+  XCTAssertEqual(3, static_cast<std::int32_t>(result.get_value()));
+  
+  result = js_context.TryEvaluate("1 + 1;");
+  XCTAssertTrue(static_cast<bool>(result));
+  XCTAssertEqual(2, static_cast<std::int32_t>(result.get_value()));
+  
+  result = js_context.TryEvaluate("}@!]}", "app.js", 123);
+  XCTAssertTrue(result.HasException());
+  try {
+    result.ThrowIfException();
+    XCTAssertTrue(false);
+  } catch (const HAL::detail::js_runtime_error& e) {
+    XCTAssertEqual("SyntaxError", e.js_name());
+    XCTAssertEqual("app.js", e.js_filename());
+  }
+  
+  XCTAssertTrue(static_cast<bool>(global_object.GetProperty("probe").TryToObject()));
+  XCTAssertTrue(js_context.CreateUndefined().TryToObject().HasException());
+}
+
+TEST_F(JSObjectTests, CachedBuiltins) {
+  JSContext js_context = js_context_group.CreateContext();
+  
+  auto array = static_cast<JSObject>(js_context.JSEvaluateScript("[1, 2, 3];"));
+  auto error = static_cast<JSObject>(js_context.JSEvaluateScript("new TypeError('type error');"));
+  auto plain = js_context.CreateObject();
+  
+  XCTAssertTrue(array.IsArray());
+  XCTAssertFalse(array.IsError());
+  XCTAssertTrue(error.IsError());
+  XCTAssertFalse(error.IsArray());
+  XCTAssertFalse(plain.IsArray());
+  XCTAssertFalse(plain.IsError());
+  XCTAssertTrue(detail::JSContextSlots::GetCount() > 0);
+  
+  // The builtins are cached on first use, so replacing them afterwards
+  // doesn't change the answers.
+  js_context.JSEvaluateScript("Array = undefined; Error = undefined;");
+  XCTAssertTrue(array.IsArray());
+  XCTAssertTrue(error.IsError());
+  XCTAssertFalse(plain.IsError());
+}
+
+TEST_F(JSObjectTests, CallWithArgumentBuffer) {
+  JSContext js_context = js_context_group.CreateContext();
+  auto global_object = js_context.get_global_object();
+  auto count = static_cast<JSObject>(js_context.JSEvaluateScript("(function() { return arguments.length + ':' + Array.prototype.join.call(arguments, ','); })"));
+  auto point = static_cast<JSObject>(js_context.JSEvaluateScript("(function Point(x, y) { this.x = x; this.y = y; })"));
+  
+  XCTAssertEqual("0:", static_cast<std::string>(count.Call(global_object)));
+  XCTAssertEqual("2:1,a", static_cast<std::string>(count.Call(global_object, js_context.CreateNumber(1), js_context.CreateString("a"))));
+  
+  // JSObjects are passed as themselves.
+  XCTAssertEqual("1:[object Object]", static_cast<std::string>(count.Call(global_object, js_context.CreateObject())));
+  
+  // Both within and beyond the inline capacity of the buffer.
+  std::vector<JSValue> arguments;
+  std::string joined;
+  for (std::int32_t i = 0; i < 10; ++i) {
+    arguments.push_back(js_context.CreateNumber(i));
+    joined += (i > 0 ? "," : "") + std::to_string(i);
+    const auto expected = std::to_string(arguments.size()) + ":" + joined;
+    XCTAssertEqual(expected, static_cast<std::string>(count.Call(&arguments[0], arguments.size(), global_object)));
+    XCTAssertEqual(expected, static_cast<std::string>(count(arguments, global_object)));
+  }
+  
+  auto js_point = point.Construct(js_context.CreateNumber(1), js_context.CreateNumber(2));
+  XCTAssertEqual(1, static_cast<std::int32_t>(js_point.GetProperty("x")));
+  XCTAssertEqual(2, static_cast<std::int32_t>(js_point.GetProperty("y")));
+  
+  js_point = point.Construct(&arguments[0], 2);
+  XCTAssertEqual(0, static_cast<std::int32_t>(js_point.GetProperty("x")));
+  XCTAssertEqual(1, static_cast<std::int32_t>(js_point.GetProperty("y")));
+  
+  ASSERT_THROW(global_object.Call(global_object), std::runtime_error);
+  ASSERT_THROW(global_object.Construct(), std::runtime_error);
+}
+
+TEST_F(JSObjectTests, JSInvoker) {
+  JSContext js_context = js_context_group.CreateContext();
+  auto global_object = js_context.get_global_object();
+  auto is_above = static_cast<JSObject>(js_context.JSEvaluateScript("(function(value, limit) { return value > limit; })"));
+  auto square   = static_cast<JSObject>(js_context.JSEvaluateScript("(function(value) { if (value < 0) { throw new Error('negative'); } return value * value; })"));
+  
+  JSInvoker is_above_invoker(is_above, global_object, 2);
+  XCTAssertEqual(2, is_above_invoker.get_arity());
+  const auto limit = js_context.CreateNumber(5);
+  is_above_invoker.SetArgument(1, limit);
+  std::int32_t above_count = 0;
+  for (std::int32_t i = 0; i < 10; ++i) {
+    const auto value = js_context.CreateNumber(i);
+    is_above_invoker.SetArgument(0, value);
+    if (is_above_invoker.InvokeAsBoolean()) {
+      ++above_count;
+    }
+  }
+  XCTAssertEqual(4, above_count);
+  
+  JSInvoker square_invoker(square, global_object);
+  XCTAssertEqual(9, static_cast<std::int32_t>(square_invoker(js_context.CreateNumber(3))));
+  
+  std::vector<JSValue> values;
+  for (std::int32_t i = 0; i < 4; ++i) {
+    values.push_back(js_context.CreateNumber(i));
+  }
+  std::vector<JSValue> results;
+  square_invoker.Map(values, results);
+  XCTAssertEqual(4, results.size());
+  XCTAssertEqual(9, static_cast<std::int32_t>(results.at(3)));
+  
+  // A call that throws throws, and leaves the results of the calls
+  // before it.
+  values.push_back(js_context.CreateNumber(-1));
+  values.push_back(js_context.CreateNumber(5));
+  ASSERT_THROW(square_invoker.Map(values, results), std::runtime_error);
+  XCTAssertEqual(4, results.size());
+  
+  // Arguments that aren't set are undefined.
+  JSInvoker count_invoker(static_cast<JSObject>(js_context.JSEvaluateScript("(function(a, b) { return (a === undefined) + (b === undefined); })")), global_object, 2);
+  XCTAssertEqual(2, count_invoker.InvokeAsNumber());
+  
+  ASSERT_THROW(JSInvoker(global_object, global_object), std::runtime_error);
+}